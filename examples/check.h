@@ -0,0 +1,60 @@
+#ifndef EXAMPLES_CHECK_H
+#define EXAMPLES_CHECK_H
+
+#include <stdio.h>
+#include <stdint.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+/**
+ * @file check.h
+ * @brief Assertions shared by the self-checking examples
+ *
+ * A failed CHECK() is reported and counted, and the example carries on.
+ * main() returns check_result(), so "make check" stops at the first
+ * example with a failure.
+ */
+
+static int check_failures = 0;
+
+/* Report and count a failed condition */
+#define CHECK(cond, what) \
+    do { \
+        if (!(cond)) { \
+            fprintf(stderr, "FAIL: %s\n", (what)); \
+            check_failures++; \
+        } \
+    } while (0)
+
+/**
+ * @brief Print the verdict
+ * @return Exit status for main(): 0 if every check passed, 1 otherwise
+ */
+static inline int check_result(void) {
+    printf("%s\n", check_failures == 0 ? "PASS" : "FAIL");
+    return check_failures == 0 ? 0 : 1;
+}
+
+/**
+ * @brief Sleep in real time, whichever timebase is active
+ * @param ms Milliseconds
+ *
+ * Polling loops use this rather than timebase_sleep_us(): the virtual
+ * clock returns at once, but the timer wheel and async requests run on
+ * the monotonic clock.
+ */
+static inline void check_sleep_ms(uint32_t ms) {
+#ifdef _WIN32
+    Sleep(ms);
+#else
+    struct timespec ts;
+    ts.tv_sec = ms / 1000;
+    ts.tv_nsec = (long)(ms % 1000) * 1000000L;
+    nanosleep(&ts, NULL);
+#endif
+}
+
+#endif /* EXAMPLES_CHECK_H */
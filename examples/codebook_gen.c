@@ -0,0 +1,140 @@
+/**
+ * @file codebook_gen.c
+ * @brief Compile a CSV code list into a universal TV codebook file
+ *
+ * Reads rows of `button,brand,protocol,bits,code,description` (see
+ * data/universal_codes.csv) and writes the binary codebook that
+ * universal_db_init() maps at startup. Blank lines and lines starting
+ * with '#' are ignored; rows are parsed by universal_db_parse_row(), the
+ * same parser as the built-in list, and the description may contain
+ * commas.
+ *
+ * Compile with:
+ *   make codebook-gen
+ *
+ * Run with:
+ *   ./bin/codebook_gen data/universal_codes.csv bin/universal_codes.bin
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "../include/universal_db.h"
+
+#define LINE_MAX_LEN 1024
+
+/**
+ * @brief Strip leading and trailing whitespace in place
+ */
+static char* trim(char* text) {
+    char* end;
+
+    while (isspace((unsigned char)*text)) {
+        text++;
+    }
+    end = text + strlen(text);
+    while (end > text && isspace((unsigned char)end[-1])) {
+        *--end = '\0';
+    }
+    return text;
+}
+
+/**
+ * @brief Copy a string to the heap
+ */
+static char* copy_string(const char* text) {
+    size_t length = strlen(text) + 1;
+    char* copy = (char*)malloc(length);
+
+    if (copy) {
+        memcpy(copy, text, length);
+    }
+    return copy;
+}
+
+/**
+ * @brief Parse one CSV row, copying its description to the heap
+ * @return NULL on success, or an error message
+ */
+static const char* parse_row(char* line, universal_db_source_t* row) {
+    const char* error = universal_db_parse_row(line, row);
+
+    if (error) {
+        return error;
+    }
+    row->code.description = copy_string(row->code.description);
+    if (!row->code.description) {
+        return "out of memory";
+    }
+    return NULL;
+}
+
+int main(int argc, char* argv[]) {
+    universal_db_source_t* rows = NULL;
+    size_t count = 0;
+    size_t capacity = 0;
+    char line[LINE_MAX_LEN];
+    unsigned line_number = 0;
+    FILE* input;
+    int result = 0;
+    size_t i;
+
+    if (argc != 3) {
+        fprintf(stderr, "Usage: %s CODES.csv CODEBOOK.bin\n", argv[0]);
+        return 1;
+    }
+
+    input = fopen(argv[1], "r");
+    if (!input) {
+        fprintf(stderr, "Failed to open code list: %s\n", argv[1]);
+        return 1;
+    }
+
+    while (fgets(line, sizeof(line), input)) {
+        char* text;
+        const char* error;
+
+        line_number++;
+        if (!strchr(line, '\n') && !feof(input)) {
+            fprintf(stderr, "%s:%u: line too long\n", argv[1], line_number);
+            result = 1;
+            break;
+        }
+        text = trim(line);
+        if (*text == '\0' || *text == '#') {
+            continue;
+        }
+
+        if (count == capacity) {
+            size_t grown = capacity ? capacity * 2 : 256;
+            universal_db_source_t* resized = (universal_db_source_t*)realloc(rows, grown * sizeof(*rows));
+            if (!resized) {
+                fprintf(stderr, "Out of memory\n");
+                result = 1;
+                break;
+            }
+            rows = resized;
+            capacity = grown;
+        }
+
+        error = parse_row(text, &rows[count]);
+        if (error) {
+            fprintf(stderr, "%s:%u: %s\n", argv[1], line_number, error);
+            result = 1;
+            break;
+        }
+        count++;
+    }
+    fclose(input);
+
+    if (result == 0 && universal_db_save(argv[2], rows, count) != 0) {
+        result = 1;
+    }
+
+    for (i = 0; i < count; i++) {
+        free((char*)rows[i].code.description);
+    }
+    free(rows);
+    return result;
+}
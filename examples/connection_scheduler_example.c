@@ -0,0 +1,127 @@
+/**
+ * @file connection_scheduler_example.c
+ * @brief Async connection requests on the timer wheel
+ *
+ * Establishes a connection through a custom link probe that fails a few
+ * times first, so the request has to retry with backoff. Then it runs a
+ * burst of concurrent async sends, cancels one of them, and mixes in
+ * blocking sends from the main thread. Every request that was not
+ * cancelled must complete exactly once, and the cancelled one must not
+ * complete at all. Exits non-zero on failure.
+ *
+ * Build and run:
+ *   make examples && ./bin/connection_scheduler_example
+ */
+
+#include <stdio.h>
+#include <stdatomic.h>
+#include "../include/connection.h"
+#include "../include/remote_control.h"
+#include "../include/ir_codes.h"
+#include "../include/handlers.h"
+#include "check.h"
+
+#define PROBE_FAILURES  2           /* Probe attempts that report the link down */
+#define ASYNC_SENDS     16
+#define BLOCKING_SENDS  4
+#define WAIT_LIMIT_MS   5000
+
+static atomic_int probe_calls = 0;
+static atomic_int established = 0;      /* 1 = success, -1 = failed */
+static atomic_int completions[ASYNC_SENDS];
+static atomic_int send_failures = 0;
+
+static int flaky_probe(void* context) {
+    (void)context;
+    return atomic_fetch_add(&probe_calls, 1) < PROBE_FAILURES ? -1 : 0;
+}
+
+static void on_established(connection_request_t request, int result, void* context) {
+    (void)request;
+    (void)context;
+    atomic_store(&established, result == 0 ? 1 : -1);
+}
+
+static void on_sent(connection_request_t request, int result, void* context) {
+    int index = (int)(intptr_t)context;
+    (void)request;
+
+    if (result != 0) {
+        atomic_fetch_add(&send_failures, 1);
+    }
+    atomic_fetch_add(&completions[index], 1);
+}
+
+/* Wait in real time until no request is in flight (or the limit passes) */
+static void wait_for(const connection_request_t* requests, int count) {
+    uint32_t waited = 0;
+    int i, pending;
+
+    do {
+        pending = 0;
+        for (i = 0; i < count; i++) {
+            pending += connection_request_pending(requests[i]);
+        }
+        if (pending) {
+            check_sleep_ms(5);
+            waited += 5;
+        }
+    } while (pending && waited < WAIT_LIMIT_MS);
+}
+
+int main(void) {
+    connection_request_t establish;
+    connection_request_t sends[ASYNC_SENDS];
+    connection_config_t config;
+    ir_code_t code = {.code = 0x20DF10EF, .protocol = IR_PROTOCOL_NEC, .frequency = 38000, .repeat_count = 1};
+    int cancelled = ASYNC_SENDS / 2;
+    int i;
+
+    printf("=== Connection Scheduler Example ===\n");
+    if (ir_init() != 0 || connection_init() != 0) {
+        fprintf(stderr, "FAIL: initialization\n");
+        return 1;
+    }
+
+    config = *connection_get_config();
+    config.max_retries = PROBE_FAILURES + 1;
+    config.retry_delay_ms = 5;
+    config.retry_max_delay_ms = 20;
+    connection_set_config(&config);
+    connection_set_custom_probe(flaky_probe, NULL);
+
+    /* Establish: the first PROBE_FAILURES attempts fail, then it retries */
+    establish = connection_establish_async(DEVICE_TV, on_established, NULL);
+    CHECK(establish != CONNECTION_REQUEST_INVALID, "schedule establish");
+    wait_for(&establish, 1);
+    CHECK(atomic_load(&established) == 1, "establish succeeds after retries");
+    CHECK(atomic_load(&probe_calls) == PROBE_FAILURES + 1, "establish retried until the probe passed");
+
+    /* Burst of async sends, one cancelled, with blocking sends in between */
+    for (i = 0; i < ASYNC_SENDS; i++) {
+        sends[i] = connection_send_async(code, 0, on_sent, (void*)(intptr_t)i);
+        CHECK(sends[i] != CONNECTION_REQUEST_INVALID, "schedule async send");
+    }
+    connection_request_cancel(sends[cancelled]);
+    for (i = 0; i < BLOCKING_SENDS; i++) {
+        CHECK(connection_send_with_retry(code) == 0, "blocking send alongside async requests");
+    }
+    wait_for(sends, ASYNC_SENDS);
+
+    for (i = 0; i < ASYNC_SENDS; i++) {
+        if (i == cancelled) {
+            CHECK(atomic_load(&completions[i]) == 0, "cancelled request does not complete");
+        } else {
+            CHECK(atomic_load(&completions[i]) == 1, "async send completes exactly once");
+        }
+    }
+    CHECK(atomic_load(&send_failures) == 0, "async sends succeed");
+    printf("Probe calls: %d, async sends completed: %d of %d (1 cancelled)\n",
+           atomic_load(&probe_calls), ASYNC_SENDS - 1, ASYNC_SENDS);
+
+    connection_cleanup();
+    ir_cleanup();
+    handler_cleanup();
+
+    return check_result();
+}
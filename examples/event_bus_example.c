@@ -0,0 +1,180 @@
+/**
+ * @file event_bus_example.c
+ * @brief Event bus: priorities, self-unsubscribe and concurrent writers
+ *
+ * Checks that subscribers run in priority order, that a subscriber can
+ * unsubscribe itself while being dispatched, and that subscribing and
+ * unsubscribing from several threads while another thread publishes
+ * never loses a subscriber or hands out the same token twice. Exits
+ * non-zero on failure.
+ *
+ * Build and run:
+ *   make examples && ./bin/event_bus_example
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "../include/handlers.h"
+#include "check.h"
+
+#define WRITER_THREADS     4
+#define WRITER_ITERATIONS  20000
+
+/* ==== Priority order ==== */
+
+static char order[8];
+static int order_len = 0;
+
+static int record_order(const event_t* event, void* context) {
+    (void)event;
+    if (order_len < (int)sizeof(order) - 1) {
+        order[order_len++] = *(const char*)context;
+    }
+    return HANDLER_SUCCESS;
+}
+
+static void check_priorities(void) {
+    event_t event;
+    event_token_t tokens[3];
+
+    order_len = 0;
+    memset(order, 0, sizeof(order));
+    tokens[0] = event_subscribe(EVENT_DEVICE_CHANGED, record_order, "L", EVENT_PRIORITY_LOW);
+    tokens[1] = event_subscribe(EVENT_DEVICE_CHANGED, record_order, "H", EVENT_PRIORITY_HIGH);
+    tokens[2] = event_subscribe(EVENT_DEVICE_CHANGED, record_order, "D", EVENT_PRIORITY_DEFAULT);
+
+    memset(&event, 0, sizeof(event));
+    event.type = EVENT_DEVICE_CHANGED;
+    event_publish(&event);
+    CHECK(strcmp(order, "HDL") == 0, "subscribers run in priority order");
+
+    event_unsubscribe(tokens[0]);
+    event_unsubscribe(tokens[1]);
+    event_unsubscribe(tokens[2]);
+    CHECK(event_subscriber_count(EVENT_DEVICE_CHANGED) == 0, "all priority subscribers removed");
+}
+
+/* ==== Self-unsubscribe ==== */
+
+static event_token_t once_token = EVENT_TOKEN_INVALID;
+static int once_calls = 0;
+
+static int run_once(const event_t* event, void* context) {
+    (void)event;
+    (void)context;
+    once_calls++;
+    event_unsubscribe(once_token);
+    return HANDLER_SUCCESS;
+}
+
+static void check_self_unsubscribe(void) {
+    event_t event;
+
+    once_token = event_subscribe(EVENT_STATE_CHANGED, run_once, NULL, EVENT_PRIORITY_DEFAULT);
+    memset(&event, 0, sizeof(event));
+    event.type = EVENT_STATE_CHANGED;
+    event_publish(&event);
+    event_publish(&event);
+    CHECK(once_calls == 1, "self-unsubscribing subscriber runs once");
+    CHECK(event_subscriber_count(EVENT_STATE_CHANGED) == 0, "self-unsubscribe removed the subscription");
+}
+
+/* ==== Concurrent writers ==== */
+
+static atomic_int publishing = 1;
+static _Atomic uint64_t published = 0;
+static _Atomic uint64_t delivered = 0;
+static _Atomic uint64_t steady_delivered = 0;
+static _Atomic uint64_t duplicate_tokens = 0;
+
+static int count_delivery(const event_t* event, void* context) {
+    (void)event;
+    (void)context;
+    atomic_fetch_add(&delivered, 1);
+    return HANDLER_SUCCESS;
+}
+
+/* Subscribed for the whole run: must see every publish */
+static int count_steady(const event_t* event, void* context) {
+    (void)event;
+    (void)context;
+    atomic_fetch_add(&steady_delivered, 1);
+    return HANDLER_SUCCESS;
+}
+
+static void* writer_thread(void* arg) {
+    event_type_t type = (event_type_t)(intptr_t)arg;
+    int i;
+
+    for (i = 0; i < WRITER_ITERATIONS; i++) {
+        event_token_t a = event_subscribe(type, count_delivery, NULL, i % 3 - 1);
+        event_token_t b = event_subscribe(type, count_delivery, NULL, EVENT_PRIORITY_DEFAULT);
+
+        if (a == b || a == EVENT_TOKEN_INVALID || b == EVENT_TOKEN_INVALID) {
+            atomic_fetch_add(&duplicate_tokens, 1);
+        }
+        /* Unsubscribing fails if another thread was handed the same token */
+        if (event_unsubscribe(b) != 0 || event_unsubscribe(a) != 0) {
+            atomic_fetch_add(&duplicate_tokens, 1);
+        }
+    }
+    return NULL;
+}
+
+static void* publisher_thread(void* arg) {
+    event_t event;
+    (void)arg;
+
+    memset(&event, 0, sizeof(event));
+    event.type = EVENT_TIMER_EXPIRED;
+    while (atomic_load(&publishing)) {
+        event_publish(&event);
+        atomic_fetch_add(&published, 1);
+    }
+    return NULL;
+}
+
+static void check_concurrent_writers(void) {
+    pthread_t writers[WRITER_THREADS];
+    pthread_t publisher;
+    event_token_t steady;
+    int i;
+
+    steady = event_subscribe(EVENT_TIMER_EXPIRED, count_steady, NULL, EVENT_PRIORITY_DEFAULT);
+    CHECK(steady != EVENT_TOKEN_INVALID, "subscribe steady subscriber");
+    pthread_create(&publisher, NULL, publisher_thread, NULL);
+    for (i = 0; i < WRITER_THREADS; i++) {
+        /* Two writers per event type: they contend for the same list */
+        event_type_t type = (i % 2) ? EVENT_TIMER_EXPIRED : EVENT_HARDWARE_INTERRUPT;
+        pthread_create(&writers[i], NULL, writer_thread, (void*)(intptr_t)type);
+    }
+    for (i = 0; i < WRITER_THREADS; i++) {
+        pthread_join(writers[i], NULL);
+    }
+    atomic_store(&publishing, 0);
+    pthread_join(publisher, NULL);
+
+    printf("Concurrent writers: %d threads x %d subscribe/unsubscribe pairs, %llu publishes, %llu transient deliveries\n",
+           WRITER_THREADS, WRITER_ITERATIONS * 2, (unsigned long long)atomic_load(&published),
+           (unsigned long long)atomic_load(&delivered));
+    CHECK(atomic_load(&duplicate_tokens) == 0, "concurrent writers get distinct tokens");
+    CHECK(atomic_load(&steady_delivered) == atomic_load(&published), "steady subscriber sees every publish");
+    CHECK(event_unsubscribe(steady) == 0, "unsubscribe steady subscriber");
+    CHECK(event_subscriber_count(EVENT_TIMER_EXPIRED) == 0, "timer subscriber list empty after writers");
+    CHECK(event_subscriber_count(EVENT_HARDWARE_INTERRUPT) == 0, "interrupt subscriber list empty after writers");
+}
+
+int main(void) {
+    printf("=== Event Bus Example ===\n");
+    handler_init();
+
+    check_priorities();
+    check_self_unsubscribe();
+    check_concurrent_writers();
+
+    handler_cleanup();
+
+    return check_result();
+}
@@ -10,19 +10,30 @@
  * - Overall system latency
  * 
  * Compile with:
- *   gcc -I../include latency_probe.c ../src/latency.c ../src/handlers.c \
- *       ../src/ir_codes.c ../src/ir_protocol.c ../src/universal_tv.c \
- *       ../src/remote_control.c -o latency_probe
+ *   make latency-probe
+ * 
+ * Run with --virtual to use the virtual clock: every IR delay advances
+ * simulated time instantly while latencies stay exact.
+ * 
+ * Run with --trace FILE to write every press as nested spans to a Chrome
+ * Trace Event file (open in chrome://tracing or ui.perfetto.dev).
+ * 
+ * Run with --log FILE to also append every sample to a binary latency log
+ * (see latency_log.h); analyze it with bin/latency_report.
  */
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include "../include/latency.h"
+#include "../include/latency_log.h"
 #include "../include/remote_control.h"
 #include "../include/remote_buttons.h"
 #include "../include/universal_tv.h"
 #include "../include/handlers.h"
+#include "../include/ir_pulse.h"
+#include "../include/timebase.h"
+#include "../include/trace.h"
 
 /* Test configuration */
 #define PROBE_ITERATIONS 100
@@ -92,9 +103,9 @@ void probe_ir_protocol_latency(void) {
     
     latency_probe_t probe;
     ir_code_t codes[] = {
-        {0x20DF10EF, IR_PROTOCOL_NEC, 38000, 1},
-        {0x0C, IR_PROTOCOL_RC5, 38000, 1},
-        {0x800F040C, IR_PROTOCOL_RC6, 38000, 1}
+        {.code = 0x20DF10EF, .protocol = IR_PROTOCOL_NEC, .frequency = 38000, .repeat_count = 1},
+        {.code = 0x0C, .protocol = IR_PROTOCOL_RC5, .frequency = 38000, .repeat_count = 1},
+        {.code = 0x800F040C, .protocol = IR_PROTOCOL_RC6, .frequency = 38000, .repeat_count = 1}
     };
     
     const char* protocol_names[] = {"NEC", "RC5", "RC6"};
@@ -106,6 +117,17 @@ void probe_ir_protocol_latency(void) {
         
         printf("Protocol: %s\n", protocol_names[p]);
         
+        /* Encoding alone (no transmission) */
+        ir_pulse_train_t train;
+        uint32_t encode_sum = 0;
+        for (int i = 0; i < PROBE_ITERATIONS; i++) {
+            LATENCY_PROBE_START(probe, "ir_encode");
+            ir_pulse_encode(codes[p], &train);
+            encode_sum += LATENCY_PROBE_STOP(probe, "ir_encode", codes[p].protocol);
+        }
+        printf("  Encode avg: %u us (%u entries, %u us on air)\n",
+               encode_sum / PROBE_ITERATIONS, train.count, train.duration_us);
+        
         for (int i = 0; i < PROBE_ITERATIONS; i++) {
             LATENCY_PROBE_START(probe, "ir_protocol");
             ir_send(codes[p]);
@@ -290,15 +312,43 @@ void probe_end_to_end_latency(void) {
     remote_cleanup();
 }
 
-int main(void) {
+int main(int argc, char* argv[]) {
     printf("=== Synthetic Latency Probe ===\n\n");
     
+    const char* trace_path = NULL;
+    const char* log_path = NULL;
+    
+    /* --virtual: run on the virtual clock so IR delays cost no wall time */
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--virtual") == 0) {
+            timebase_use_virtual(0);
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            trace_path = argv[++i];
+        } else if (strcmp(argv[i], "--log") == 0 && i + 1 < argc) {
+            log_path = argv[++i];
+        }
+    }
+    
+    if (trace_path) {
+        if (trace_init(TRACE_DEFAULT_EVENTS) != 0) {
+            return 1;
+        }
+        trace_enable(1);
+    }
+    printf("Timebase: %s\n", timebase_get_backend()->name);
+    uint64_t wall_start = timebase_is_virtual() ? 0 : timebase_now_ns();
+    
     /* Initialize latency measurement */
     if (latency_init(1000) != 0) {
         fprintf(stderr, "Failed to initialize latency measurement\n");
         return 1;
     }
     
+    if (log_path && latency_log_open(log_path, 0) != 0) {
+        fprintf(stderr, "Failed to open latency log: %s\n", log_path);
+        return 1;
+    }
+    
     printf("Running synthetic latency probes...\n");
     printf("Iterations per probe: %d (warmup: %d)\n\n", PROBE_ITERATIONS, PROBE_WARMUP);
     
@@ -322,13 +372,14 @@ int main(void) {
     
     const char* operations[] = {
         "button_press",
+        "ir_encode",
         "ir_protocol",
         "universal_tv",
         "event_handler",
         "end_to_end"
     };
     
-    for (int i = 0; i < 5; i++) {
+    for (int i = 0; i < 6; i++) {
         latency_stats_t stats;
         if (latency_get_stats_for_operation(operations[i], &stats) == 0 && stats.count > 0) {
             printf("\nOperation: %s\n", operations[i]);
@@ -337,8 +388,19 @@ int main(void) {
     }
     
     /* Cleanup */
+    if (trace_path) {
+        trace_enable(0);
+        trace_write_json(trace_path);
+        trace_cleanup();
+    }
     latency_cleanup();
     
+    if (timebase_is_virtual()) {
+        printf("Simulated time: %.3f s\n", timebase_now_ns() / 1e9);
+    } else {
+        printf("Wall time: %.3f s\n", (timebase_now_ns() - wall_start) / 1e9);
+    }
+    
     printf("=== Probe Complete ===\n");
     printf("Use these measurements to identify and optimize latency bottlenecks.\n");
     
@@ -0,0 +1,324 @@
+/**
+ * @file latency_report.c
+ * @brief Offline analyzer for binary latency logs
+ *
+ * Reads a log written through latency_log_open() (for example by
+ * `latency_probe --log FILE` or a soak run) and prints:
+ * - Overall and per-operation percentiles
+ * - Per-button / per-code breakdowns
+ * - A latency histogram (--histogram)
+ *
+ * The log can be analyzed while it is still being written, or after the
+ * writing process crashed; incomplete records are skipped.
+ *
+ * Compile with:
+ *   make latency-report
+ *
+ * Run with:
+ *   ./bin/latency_report latency.log [--op NAME] [--histogram]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/latency.h"
+#include "../include/latency_log.h"
+#include "../include/button_table.h"
+
+/* Per (operation, code) breakdown limit */
+#define REPORT_MAX_GROUPS 1024
+
+/* Operations whose code is a button code (see remote_buttons.h) */
+static const char* button_ops[] = { "button_press", "universal_tv" };
+
+/* Aggregated latencies for one operation or (operation, code) pair */
+typedef struct {
+    uint16_t op;
+    uint32_t code;
+    uint64_t sum_ns;
+    latency_histogram_t* hist;
+} report_group_t;
+
+static report_group_t op_groups[LATENCY_MAX_OPS];
+static report_group_t code_groups[REPORT_MAX_GROUPS];
+static size_t code_group_count = 0;
+static uint64_t code_groups_dropped = 0;
+
+/**
+ * @brief Add a sample to a group, allocating its histogram on first use
+ */
+static int group_add(report_group_t* group, const latency_sample_t* sample) {
+    if (!group->hist) {
+        group->hist = (latency_histogram_t*)malloc(sizeof(latency_histogram_t));
+        if (!group->hist) {
+            return -1;
+        }
+        latency_histogram_reset(group->hist);
+        group->op = sample->op;
+        group->code = sample->code;
+    }
+
+    latency_histogram_record(group->hist, sample->latency_ns);
+    group->sum_ns += sample->latency_ns;
+    return 0;
+}
+
+/**
+ * @brief Find or create the group for an (operation, code) pair
+ */
+static report_group_t* code_group_get(uint16_t op, uint32_t code) {
+    report_group_t* group;
+    size_t i;
+
+    for (i = 0; i < code_group_count; i++) {
+        if (code_groups[i].op == op && code_groups[i].code == code) {
+            return &code_groups[i];
+        }
+    }
+    if (code_group_count == REPORT_MAX_GROUPS) {
+        return NULL;
+    }
+
+    /* Count the group only once its histogram exists, so the report never
+     * prints a group without one */
+    group = &code_groups[code_group_count];
+    group->hist = (latency_histogram_t*)malloc(sizeof(latency_histogram_t));
+    if (!group->hist) {
+        return NULL;
+    }
+    latency_histogram_reset(group->hist);
+    group->op = op;
+    group->code = code;
+    code_group_count++;
+    return group;
+}
+
+/**
+ * @brief Check if an operation records button codes
+ */
+static int is_button_op(const char* name) {
+    size_t i;
+
+    for (i = 0; i < sizeof(button_ops) / sizeof(button_ops[0]); i++) {
+        if (strcmp(name, button_ops[i]) == 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Print one statistics row (latencies in microseconds)
+ */
+static void print_row(const char* label, const latency_histogram_t* hist, uint64_t sum_ns) {
+    printf("%-28s %9llu %10.3f %10.3f %10.3f %10.3f %10.3f %10.3f %10.3f\n",
+           label,
+           (unsigned long long)hist->total,
+           hist->min_ns / 1000.0,
+           hist->total ? (double)sum_ns / hist->total / 1000.0 : 0.0,
+           latency_histogram_percentile(hist, 50.0) / 1000.0,
+           latency_histogram_percentile(hist, 95.0) / 1000.0,
+           latency_histogram_percentile(hist, 99.0) / 1000.0,
+           latency_histogram_percentile(hist, 99.9) / 1000.0,
+           hist->max_ns / 1000.0);
+}
+
+/**
+ * @brief Print the column header for print_row
+ */
+static void print_header(const char* title) {
+    printf("\n%s (us)\n", title);
+    printf("%-28s %9s %10s %10s %10s %10s %10s %10s %10s\n",
+           "", "count", "min", "avg", "p50", "p95", "p99", "p99.9", "max");
+}
+
+/**
+ * @brief Print a histogram with one row per power-of-two latency range
+ */
+static void print_histogram(const char* title, const latency_histogram_t* hist) {
+    uint64_t rows[64] = { 0 };
+    uint64_t peak = 0;
+    uint32_t b;
+    int first = -1;
+    int last = -1;
+    int i;
+
+    /* Fold the log-linear buckets into one row per power of two, using the
+     * bucket layout documented in latency.h: index = e * SUB_COUNT + (v >> e) */
+    for (b = 0; b < LATENCY_HIST_BUCKETS; b++) {
+        uint32_t e = 0;
+        uint64_t low = b;
+        int row = 0;
+
+        if (!hist->counts[b]) {
+            continue;
+        }
+        if (b >= 2u * LATENCY_HIST_SUB_COUNT) {
+            e = b / LATENCY_HIST_SUB_COUNT - 1;
+            low = (uint64_t)(b - e * LATENCY_HIST_SUB_COUNT) << e;
+        }
+        while (low >> (row + 1)) {
+            row++;
+        }
+        rows[row] += hist->counts[b];
+    }
+
+    for (i = 0; i < 64; i++) {
+        if (rows[i]) {
+            if (first < 0) {
+                first = i;
+            }
+            last = i;
+            if (rows[i] > peak) {
+                peak = rows[i];
+            }
+        }
+    }
+
+    printf("\nHistogram: %s\n", title);
+    if (first < 0) {
+        printf("  (no samples)\n");
+        return;
+    }
+
+    for (i = first; i <= last; i++) {
+        int bar = (int)(rows[i] * 50 / peak);
+        printf("  %12.3f - %12.3f us %9llu |", i ? (double)(1ULL << i) / 1000.0 : 0.0,
+               (double)(1ULL << (i + 1)) / 1000.0, (unsigned long long)rows[i]);
+        while (bar-- > 0) {
+            putchar('#');
+        }
+        putchar('\n');
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const char* path = NULL;
+    const char* only_op = NULL;
+    int show_histogram = 0;
+    latency_log_view_t view;
+    latency_histogram_t overall;
+    uint64_t overall_sum = 0;
+    uint64_t first, end, index;
+    uint64_t skipped = 0;
+    uint64_t first_ts = UINT64_MAX, last_ts = 0;
+    size_t i;
+    int op;
+
+    for (int a = 1; a < argc; a++) {
+        if (strcmp(argv[a], "--op") == 0 && a + 1 < argc) {
+            only_op = argv[++a];
+        } else if (strcmp(argv[a], "--histogram") == 0) {
+            show_histogram = 1;
+        } else if (!path) {
+            path = argv[a];
+        } else {
+            path = NULL;
+            break;
+        }
+    }
+
+    if (!path) {
+        fprintf(stderr, "Usage: %s LOGFILE [--op NAME] [--histogram]\n", argv[0]);
+        return 1;
+    }
+
+    if (latency_log_view_open(path, &view) != 0) {
+        fprintf(stderr, "Failed to open latency log: %s\n", path);
+        return 1;
+    }
+
+    latency_histogram_reset(&overall);
+    end = latency_log_view_range(&view, &first);
+
+    for (index = first; index < end; index++) {
+        latency_sample_t sample;
+        report_group_t* group;
+
+        if (latency_log_view_get(&view, index, &sample) != 0) {
+            skipped++;
+            continue;
+        }
+        if (only_op && strcmp(sample.operation, only_op) != 0) {
+            continue;
+        }
+
+        latency_histogram_record(&overall, sample.latency_ns);
+        overall_sum += sample.latency_ns;
+        if (sample.timestamp_ns < first_ts) {
+            first_ts = sample.timestamp_ns;
+        }
+        if (sample.timestamp_ns > last_ts) {
+            last_ts = sample.timestamp_ns;
+        }
+
+        if (sample.op < LATENCY_MAX_OPS && group_add(&op_groups[sample.op], &sample) != 0) {
+            fprintf(stderr, "Out of memory\n");
+            return 1;
+        }
+
+        group = code_group_get(sample.op, sample.code);
+        if (!group || group_add(group, &sample) != 0) {
+            code_groups_dropped++;
+        }
+    }
+
+    printf("=== Latency Log Report ===\n");
+    printf("File:      %s\n", path);
+    printf("Records:   %llu written, %llu kept (capacity %llu), %llu incomplete\n",
+           (unsigned long long)end, (unsigned long long)(end - first),
+           (unsigned long long)view.header->capacity, (unsigned long long)skipped);
+    if (overall.total > 0) {
+        printf("Time span: %.3f s\n", (last_ts - first_ts) / 1e9);
+    }
+
+    print_header("Overall");
+    print_row(only_op ? only_op : "all", &overall, overall_sum);
+
+    print_header("Per operation");
+    for (op = 0; op < LATENCY_MAX_OPS; op++) {
+        if (op_groups[op].hist) {
+            const char* name = view.header->op_names[op][0] ? view.header->op_names[op] : "unknown";
+            print_row(name, op_groups[op].hist, op_groups[op].sum_ns);
+        }
+    }
+
+    print_header("Per button / code");
+    for (op = 0; op < LATENCY_MAX_OPS; op++) {
+        const char* op_name = view.header->op_names[op][0] ? view.header->op_names[op] : "unknown";
+
+        for (i = 0; i < code_group_count; i++) {
+            char label[64];
+            const report_group_t* group = &code_groups[i];
+
+            if (group->op != op) {
+                continue;
+            }
+            if (is_button_op(op_name) && group->code <= 0xFF &&
+                button_is_valid((unsigned char)group->code)) {
+                snprintf(label, sizeof(label), "%.14s %s", op_name,
+                         button_table_lookup((unsigned char)group->code)->name);
+            } else {
+                snprintf(label, sizeof(label), "%.14s 0x%08X", op_name, (unsigned int)group->code);
+            }
+            print_row(label, group->hist, group->sum_ns);
+        }
+    }
+    if (code_groups_dropped > 0) {
+        printf("(%llu samples beyond %d codes not broken down)\n",
+               (unsigned long long)code_groups_dropped, REPORT_MAX_GROUPS);
+    }
+
+    if (show_histogram) {
+        print_histogram(only_op ? only_op : "all operations", &overall);
+    }
+
+    for (op = 0; op < LATENCY_MAX_OPS; op++) {
+        free(op_groups[op].hist);
+    }
+    for (i = 0; i < code_group_count; i++) {
+        free(code_groups[i].hist);
+    }
+    latency_log_view_close(&view);
+    return 0;
+}
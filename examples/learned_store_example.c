@@ -0,0 +1,158 @@
+/**
+ * @file learned_store_example.c
+ * @brief Learned code store: round trip, compaction and crash recovery
+ *
+ * Uses a scratch file under /tmp. Checks that puts, overwrites and erases
+ * survive a reopen, that superseded records are compacted away, and that
+ * replay skips a corrupt record in the middle of the log (the key keeps its
+ * previous value, later records still apply) and truncates a torn record
+ * at the end. Exits non-zero on failure.
+ *
+ * Build and run:
+ *   make examples && ./bin/learned_store_example
+ */
+
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "../include/learned_store.h"
+#include "../include/ir_codes.h"
+#include "../include/remote_buttons.h"
+#include "check.h"
+
+#define OVERWRITES  200             /* Enough superseded records to force compaction */
+
+static char path[64];
+
+static int stored_code(uint8_t device, unsigned char button_code, uint32_t* code) {
+    learned_code_t learned;
+
+    if (learned_store_get(device, button_code, &learned) != 0) {
+        return -1;
+    }
+    *code = learned.code;
+    return 0;
+}
+
+static int put_code(uint8_t device, unsigned char button_code, uint32_t code) {
+    learned_code_t learned = {.code = code, .protocol = IR_PROTOCOL_NEC, .bit_length = 32};
+    return learned_store_put(device, button_code, &learned);
+}
+
+/* Overwrite bytes at a file offset */
+static int patch_file(int fd, off_t offset, const void* data, size_t len) {
+    return lseek(fd, offset, SEEK_SET) == offset && write(fd, data, len) == (ssize_t)len ? 0 : -1;
+}
+
+static long file_size(void) {
+    struct stat st;
+    return stat(path, &st) == 0 ? (long)st.st_size : -1;
+}
+
+static void check_round_trip(void) {
+    learned_store_stats_t stats;
+    uint32_t code = 0;
+
+    unlink(path);
+    CHECK(learned_store_open(path) == 0, "open empty store");
+    CHECK(put_code(1, BUTTON_POWER, 0x20DF10EF) == 0, "put");
+    CHECK(put_code(1, BUTTON_VOLUME_UP, 0x20DF40BF) == 0, "put second key");
+    CHECK(put_code(2, BUTTON_POWER, 0x10EF08F7) == 0, "put other device");
+    CHECK(put_code(1, BUTTON_POWER, 0x20DF23DC) == 0, "overwrite");
+    CHECK(learned_store_erase(2, BUTTON_POWER) == 0, "erase");
+    learned_store_close();
+
+    CHECK(learned_store_open(path) == 0, "reopen");
+    learned_store_get_stats(&stats);
+    CHECK(stats.live == 2 && stats.records == 5 && stats.dropped == 0, "reopen replays every record");
+    CHECK(stored_code(1, BUTTON_POWER, &code) == 0 && code == 0x20DF23DC, "overwrite survives reopen");
+    CHECK(stored_code(1, BUTTON_VOLUME_UP, &code) == 0 && code == 0x20DF40BF, "put survives reopen");
+    CHECK(stored_code(2, BUTTON_POWER, &code) != 0, "erase survives reopen");
+    learned_store_close();
+}
+
+static void check_compaction(void) {
+    learned_store_stats_t stats;
+    uint32_t code = 0;
+    uint32_t i;
+
+    CHECK(learned_store_open(path) == 0, "open for compaction");
+    for (i = 0; i < OVERWRITES; i++) {
+        CHECK(put_code(3, BUTTON_MUTE, 0x00FF0000u + i) == 0, "repeated put");
+    }
+    learned_store_get_stats(&stats);
+    CHECK(stats.compactions > 0, "superseded records trigger compaction");
+    CHECK(stats.records <= 2 * stats.live + LEARNED_COMPACT_SLACK, "log stays bounded");
+
+    CHECK(learned_store_compact() == 0, "explicit compaction");
+    learned_store_get_stats(&stats);
+    CHECK(stats.records == stats.live, "compaction keeps only live records");
+    CHECK(file_size() == (long)(stats.live * sizeof(learned_record_t)), "compacted file holds the live records");
+    learned_store_close();
+
+    CHECK(learned_store_open(path) == 0, "reopen after compaction");
+    CHECK(stored_code(3, BUTTON_MUTE, &code) == 0 && code == 0x00FF0000u + OVERWRITES - 1, "last put wins after compaction");
+    CHECK(stored_code(1, BUTTON_POWER, &code) == 0 && code == 0x20DF23DC, "other keys survive compaction");
+    learned_store_close();
+}
+
+static void check_recovery(void) {
+    static const unsigned char torn[7] = {0x4C, 0x52, 0x4E, 0x31, 0x09, 0x00, 0x00};
+    learned_store_stats_t stats;
+    uint32_t code = 0;
+    unsigned char byte;
+    int fd;
+
+    /* Log: [POWER v1][VOL_UP][POWER v2][MUTE] */
+    unlink(path);
+    CHECK(learned_store_open(path) == 0, "open fresh store");
+    CHECK(put_code(1, BUTTON_POWER, 0x11111111) == 0, "put v1");
+    CHECK(put_code(1, BUTTON_VOLUME_UP, 0x22222222) == 0, "put");
+    CHECK(put_code(1, BUTTON_POWER, 0x33333333) == 0, "put v2");
+    CHECK(put_code(1, BUTTON_MUTE, 0x44444444) == 0, "put after v2");
+    learned_store_close();
+
+    /* Flip a code byte in the third record and append a torn record */
+    fd = open(path, O_RDWR);
+    CHECK(fd >= 0, "open log file");
+    if (fd < 0) {
+        return;
+    }
+    CHECK(lseek(fd, 2 * sizeof(learned_record_t) + 8, SEEK_SET) >= 0 && read(fd, &byte, 1) == 1, "read record byte");
+    byte ^= 0xFF;
+    CHECK(patch_file(fd, 2 * sizeof(learned_record_t) + 8, &byte, 1) == 0, "corrupt middle record");
+    CHECK(patch_file(fd, 4 * sizeof(learned_record_t), torn, sizeof(torn)) == 0, "append torn record");
+    close(fd);
+
+    CHECK(learned_store_open(path) == 0, "open damaged store");
+    learned_store_get_stats(&stats);
+    printf("Recovery: %u records, %u dropped, %u live\n", stats.records, stats.dropped, stats.live);
+    CHECK(stats.records == 4 && stats.dropped == 2, "corrupt and torn records are counted");
+    CHECK(stored_code(1, BUTTON_POWER, &code) == 0 && code == 0x11111111, "corrupt record keeps the previous value");
+    CHECK(stored_code(1, BUTTON_VOLUME_UP, &code) == 0 && code == 0x22222222, "record before the corruption applies");
+    CHECK(stored_code(1, BUTTON_MUTE, &code) == 0 && code == 0x44444444, "record after the corruption applies");
+    CHECK(file_size() == (long)(4 * sizeof(learned_record_t)), "torn tail is truncated");
+
+    /* The next append starts on a record boundary */
+    CHECK(put_code(1, BUTTON_POWER, 0x55555555) == 0, "put after recovery");
+    learned_store_close();
+    CHECK(learned_store_open(path) == 0, "reopen after recovery");
+    learned_store_get_stats(&stats);
+    CHECK(stats.dropped == 1, "only the corrupt record is skipped after recovery");
+    CHECK(stored_code(1, BUTTON_POWER, &code) == 0 && code == 0x55555555, "append after recovery is readable");
+    learned_store_close();
+}
+
+int main(void) {
+    printf("=== Learned Store Example ===\n");
+    snprintf(path, sizeof(path), "/tmp/learned_store_example_%ld.dat", (long)getpid());
+
+    check_round_trip();
+    check_compaction();
+    check_recovery();
+
+    unlink(path);
+
+    return check_result();
+}
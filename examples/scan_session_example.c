@@ -0,0 +1,119 @@
+/**
+ * @file scan_session_example.c
+ * @brief Concurrent universal scan sessions against simulated TVs
+ *
+ * Starts one thread per button. Each thread runs its own scan session
+ * with a custom transmitter that plays a TV accepting exactly one frame
+ * of that button's sweep list. The thread sends frames until the TV
+ * reacts, confirms, and checks that the confirmed frame is the one the TV
+ * accepts. Exits non-zero on any mismatch.
+ *
+ * Build and run:
+ *   make examples && ./bin/scan_session_example
+ */
+
+#include <stdio.h>
+#include <pthread.h>
+#include "../include/universal_tv.h"
+#include "../include/universal_db.h"
+#include "../include/remote_buttons.h"
+#include "check.h"
+
+#define SCAN_THREADS 6
+#define SCAN_ROUNDS  20
+
+/* Simulated TV: reacts to one frame */
+typedef struct {
+    unsigned char button_code;
+    uint32_t accepts;           /* Frame code the TV reacts to */
+    uint32_t sent;              /* Frames received */
+    int reacted;                /* Set when the accepted frame arrives */
+    int failures;
+} simulated_tv_t;
+
+static int simulated_tv_send(const universal_tv_code_t* code, void* context) {
+    simulated_tv_t* tv = (simulated_tv_t*)context;
+
+    tv->sent++;
+    tv->reacted = (code->code == tv->accepts);
+    return 0;
+}
+
+static void* scan_thread(void* arg) {
+    simulated_tv_t* tv = (simulated_tv_t*)arg;
+    const universal_db_entry_t* codes;
+    uint32_t count = 0;
+    int round;
+
+    codes = universal_db_button_codes(tv->button_code, &count);
+    if (!codes || count == 0) {
+        tv->failures++;
+        return NULL;
+    }
+
+    for (round = 0; round < SCAN_ROUNDS; round++) {
+        const universal_frame_t* target = universal_db_frame(&codes[(uint32_t)round % count]);
+        universal_scan_t* scan = universal_scan_create(tv->button_code, simulated_tv_send, tv);
+        universal_tv_code_t confirmed;
+        uint32_t i;
+
+        if (!scan || !target) {
+            tv->failures++;
+            universal_scan_destroy(scan);
+            continue;
+        }
+
+        tv->accepts = target->code;
+        tv->reacted = 0;
+        tv->sent = 0;
+
+        /* One lap of the sweep list must reach the accepted frame */
+        for (i = 0; i < count && !tv->reacted; i++) {
+            if (universal_scan_next(scan) != 0) {
+                break;
+            }
+        }
+
+        if (!tv->reacted || universal_scan_confirm(scan, &confirmed) != 0 ||
+            confirmed.code != tv->accepts) {
+            fprintf(stderr, "FAIL: button 0x%02X round %d: TV accepts 0x%08X, confirmed 0x%08X after %u frames\n",
+                    tv->button_code, round, tv->accepts, tv->reacted ? confirmed.code : 0, tv->sent);
+            tv->failures++;
+        }
+        universal_scan_destroy(scan);
+    }
+    return NULL;
+}
+
+int main(void) {
+    static const unsigned char buttons[SCAN_THREADS] = {
+        BUTTON_POWER, BUTTON_VOLUME_UP, BUTTON_VOLUME_DOWN,
+        BUTTON_MUTE, BUTTON_CHANNEL_UP, BUTTON_CHANNEL_DOWN
+    };
+    simulated_tv_t tvs[SCAN_THREADS] = {{0}};
+    pthread_t threads[SCAN_THREADS];
+    int i;
+
+    printf("=== Scan Session Example ===\n");
+    if (universal_tv_init(UNIVERSAL_MODE_MULTI_PROTOCOL) != 0) {
+        fprintf(stderr, "FAIL: universal_tv_init\n");
+        return 1;
+    }
+
+    for (i = 0; i < SCAN_THREADS; i++) {
+        tvs[i].button_code = buttons[i];
+        if (pthread_create(&threads[i], NULL, scan_thread, &tvs[i]) != 0) {
+            fprintf(stderr, "FAIL: pthread_create\n");
+            return 1;
+        }
+    }
+    for (i = 0; i < SCAN_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+        printf("Button 0x%02X: %d rounds, %d failures\n", buttons[i], SCAN_ROUNDS, tvs[i].failures);
+        check_failures += tvs[i].failures;
+    }
+
+    universal_tv_cleanup();
+
+    return check_result();
+}
@@ -0,0 +1,122 @@
+/**
+ * @file timer_wheel_example.c
+ * @brief Timer wheel: one-shot, periodic, cancel and bulk timers
+ *
+ * Runs the wheel thread and checks that one-shot timers fire once and
+ * not early, that a periodic timer stops itself by returning non-zero,
+ * that a cancelled timer never fires, and that a thousand timers spread
+ * over two wheel levels all fire. The pool must be empty at the end.
+ * Exits non-zero on failure.
+ *
+ * Build and run:
+ *   make examples && ./bin/timer_wheel_example
+ */
+
+#include <stdio.h>
+#include <stdatomic.h>
+#include "../include/timer_wheel.h"
+#include "check.h"
+
+#define BULK_TIMERS     1000
+#define PERIODIC_RUNS   5
+#define WAIT_LIMIT_MS   3000
+
+typedef struct {
+    uint64_t due_ms;            /* Earliest wheel time it may fire */
+    atomic_int fired;
+    atomic_int early;
+} one_shot_t;
+
+static atomic_int periodic_runs = 0;
+static atomic_int cancelled_runs = 0;
+static atomic_int bulk_fired = 0;
+
+static int on_one_shot(timer_id_t id, void* context) {
+    one_shot_t* shot = (one_shot_t*)context;
+    (void)id;
+
+    if (timer_wheel_now_ms() < shot->due_ms) {
+        atomic_store(&shot->early, 1);
+    }
+    atomic_fetch_add(&shot->fired, 1);
+    return 0;
+}
+
+static int on_periodic(timer_id_t id, void* context) {
+    (void)id;
+    (void)context;
+    return atomic_fetch_add(&periodic_runs, 1) + 1 >= PERIODIC_RUNS;  /* Stop after N runs */
+}
+
+static int on_cancelled(timer_id_t id, void* context) {
+    (void)id;
+    (void)context;
+    atomic_fetch_add(&cancelled_runs, 1);
+    return 0;
+}
+
+static int on_bulk(timer_id_t id, void* context) {
+    (void)id;
+    (void)context;
+    atomic_fetch_add(&bulk_fired, 1);
+    return 0;
+}
+
+int main(void) {
+    static one_shot_t shots[3];
+    static const uint32_t delays[3] = {1, 20, 150};
+    timer_wheel_stats_t stats;
+    timer_id_t cancelled;
+    uint32_t waited = 0;
+    int i;
+
+    printf("=== Timer Wheel Example ===\n");
+    if (timer_wheel_init(0) != 0 || timer_wheel_start() != 0) {
+        fprintf(stderr, "FAIL: timer wheel did not start (timerfd unsupported?)\n");
+        return 1;
+    }
+
+    for (i = 0; i < 3; i++) {
+        shots[i].due_ms = timer_wheel_now_ms() + delays[i];
+        CHECK(timer_wheel_add(delays[i], 0, on_one_shot, &shots[i]) != TIMER_ID_INVALID, "add one-shot");
+    }
+    CHECK(timer_wheel_add(5, 5, on_periodic, NULL) != TIMER_ID_INVALID, "add periodic");
+
+    cancelled = timer_wheel_add(100, 0, on_cancelled, NULL);
+    CHECK(cancelled != TIMER_ID_INVALID, "add timer to cancel");
+    CHECK(timer_wheel_cancel(cancelled) == 0, "cancel pending timer");
+    CHECK(timer_wheel_cancel(cancelled) != 0, "second cancel is rejected");
+
+    /* Level 0 (< 64 ms) and level 1 (< 4 s) */
+    for (i = 0; i < BULK_TIMERS; i++) {
+        CHECK(timer_wheel_add((uint32_t)(i % 400), 0, on_bulk, NULL) != TIMER_ID_INVALID, "add bulk timer");
+    }
+
+    while (waited < WAIT_LIMIT_MS) {
+        timer_wheel_get_stats(&stats);
+        if (stats.active == 0) {
+            break;
+        }
+        check_sleep_ms(10);
+        waited += 10;
+    }
+
+    timer_wheel_get_stats(&stats);
+    printf("Fired %llu callbacks in %llu wakeups, %u timers still active\n",
+           (unsigned long long)stats.fired, (unsigned long long)stats.wakeups, stats.active);
+
+    for (i = 0; i < 3; i++) {
+        CHECK(atomic_load(&shots[i].fired) == 1, "one-shot fires exactly once");
+        CHECK(!atomic_load(&shots[i].early), "one-shot does not fire early");
+    }
+    CHECK(atomic_load(&periodic_runs) == PERIODIC_RUNS, "periodic timer stops itself");
+    CHECK(atomic_load(&cancelled_runs) == 0, "cancelled timer never fires");
+    CHECK(atomic_load(&bulk_fired) == BULK_TIMERS, "every bulk timer fires");
+    CHECK(stats.active == 0, "pool is empty afterwards");
+    CHECK(stats.wakeups < stats.fired, "timers due together share wakeups");
+
+    timer_wheel_cleanup();
+    CHECK(!timer_wheel_is_running(), "cleanup stops the wheel thread");
+
+    return check_result();
+}
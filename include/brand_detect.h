@@ -0,0 +1,79 @@
+#ifndef BRAND_DETECT_H
+#define BRAND_DETECT_H
+
+#include <stdint.h>
+#include "universal_tv.h"
+#include "universal_db.h"
+
+/**
+ * @file brand_detect.h
+ * @brief TV brand inference from code confirmations
+ *
+ * Keeps a probability for every tv_brand_t and updates it from each
+ * observation "frame F did / did not work". A database entry's brand_mask
+ * says which brands list F for that button, so a working NEC 0x20DF10EF
+ * POWER frame moves the probability onto Samsung, LG, TCL and Vizio, and a
+ * frame that did nothing moves it away from the brands that list it.
+ * Observations are treated as noisy (code lists are incomplete and some
+ * frames work across brands), so no brand is ever ruled out by one answer.
+ *
+ * brand_detect_next_probe() picks the frame whose answer is expected to
+ * leave the least uncertainty (Gini impurity) among the frames not yet
+ * asked about - one greedy decision tree level per call - so setup needs
+ * as few transmissions as the code list allows.
+ */
+
+/* Observation model */
+#define BRAND_DETECT_HIT            0.90f   /* P(frame works | brand lists it) */
+#define BRAND_DETECT_FALSE_HIT      0.05f   /* P(frame works | brand does not list it) */
+
+/* Probability at which a brand is reported as detected */
+#define BRAND_DETECT_CONFIDENCE     0.90f
+
+/**
+ * @brief Forget all observations (uniform probability over known brands)
+ */
+void brand_detect_reset(void);
+
+/**
+ * @brief Record whether a frame worked
+ * @param entry Database entry that was sent
+ * @param worked 1 if the TV reacted, 0 if it did not
+ * @return 1 if this observation made a brand reach BRAND_DETECT_CONFIDENCE,
+ *         0 otherwise, -1 on invalid entry
+ */
+int brand_detect_observe(const universal_db_entry_t* entry, int worked);
+
+/**
+ * @brief Pick the most informative frame to send next
+ * @param button_code Button whose sweep list to choose from
+ * @return Entry to send, or NULL if no unasked frame tells brands apart
+ */
+const universal_db_entry_t* brand_detect_next_probe(unsigned char button_code);
+
+/**
+ * @brief Get the most probable brand
+ * @param probability Output: its probability (may be NULL)
+ * @return Most probable brand (TV_BRAND_UNKNOWN before any observation)
+ */
+tv_brand_t brand_detect_best(float* probability);
+
+/**
+ * @brief Check if a brand has reached BRAND_DETECT_CONFIDENCE
+ * @return Detected brand, or TV_BRAND_UNKNOWN
+ */
+tv_brand_t brand_detect_result(void);
+
+/**
+ * @brief Get the probability of every brand
+ * @param probabilities Output array indexed by tv_brand_t (TV_BRAND_UNKNOWN is 0)
+ */
+void brand_detect_get_probabilities(float probabilities[TV_BRAND_COUNT]);
+
+/**
+ * @brief Get the number of observations since the last reset
+ * @return Observation count
+ */
+uint32_t brand_detect_observations(void);
+
+#endif /* BRAND_DETECT_H */
@@ -0,0 +1,52 @@
+#ifndef BUTTON_TABLE_H
+#define BUTTON_TABLE_H
+
+#include <stdint.h>
+#include "remote_buttons.h"
+
+/**
+ * @file button_table.h
+ * @brief Static 256-entry button lookup table
+ *
+ * One entry per possible button code, indexed directly by the code.
+ * Button validation, name lookup and IR code lookup are single array
+ * reads. The table in src/button_table.c is the single source for button
+ * names; test_simulator/button_codes.py is generated from it with
+ * `make button-codes`.
+ */
+
+/* Button Flags */
+#define BUTTON_FLAG_VALID   0x01    /* Code is a defined button */
+#define BUTTON_FLAG_NO_IR   0x02    /* Simulator/room button, no IR code */
+
+/* Button Table Entry */
+typedef struct {
+    const char* name;        /* Display name (NULL if not a button) */
+    uint32_t ir_code;        /* IR command code (0 if none) */
+    uint8_t protocol;        /* IR protocol (0 if none) */
+    button_type_t type;      /* Button category */
+    uint8_t flags;           /* BUTTON_FLAG_* */
+} button_info_t;
+
+/**
+ * @brief Look up a button table entry
+ * @param button_code Button code from remote_buttons.h
+ * @return Table entry (flags == 0 for undefined codes, never NULL)
+ */
+const button_info_t* button_table_lookup(unsigned char button_code);
+
+/**
+ * @brief Check if a button code is defined
+ * @param button_code Button code
+ * @return 1 if defined, 0 otherwise
+ */
+int button_is_valid(unsigned char button_code);
+
+/**
+ * @brief Check if a button has an IR code
+ * @param button_code Button code
+ * @return 1 if the button transmits IR, 0 otherwise
+ */
+int button_has_ir(unsigned char button_code);
+
+#endif /* BUTTON_TABLE_H */
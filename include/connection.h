@@ -39,8 +39,31 @@ typedef struct {
     uint32_t last_success_time;
     uint32_t last_failure_time;
     connection_quality_t quality;
+    float success_ewma;             /* Rolling success rate of recent attempts (0.0-1.0) */
+    uint32_t latency_ewma_us;       /* Rolling transmit latency (us) */
+    uint8_t retry_budget;           /* Retries the next send may spend */
 } connection_stats_t;
 
+/* Link Probe Strategies (how establish/verify check the link) */
+typedef enum {
+    CONNECTION_PROBE_PASSIVE = 0,   /* Recent transmit success, else PIGGYBACK */
+    CONNECTION_PROBE_PIGGYBACK,     /* The next user transmission verifies the link */
+    CONNECTION_PROBE_NULL_FRAME,    /* Send CONNECTION_NULL_PROBE_CODE (no device acts on it) */
+    CONNECTION_PROBE_POWER,         /* Send a real POWER frame (toggles the TV) */
+    CONNECTION_PROBE_CUSTOM         /* Call the function set by connection_set_custom_probe() */
+} connection_probe_t;
+
+/* RC5 frame to unused system address 27, command 63 */
+#define CONNECTION_NULL_PROBE_CODE  ((27u << 11) | 0x3Fu)
+
+/**
+ * @brief Custom link probe
+ * @param context Context given to connection_set_custom_probe()
+ * @return 0 if the link works, 1 to let the next transmission verify it,
+ *         -1 if the link is down
+ */
+typedef int (*connection_probe_fn_t)(void* context);
+
 /* Connection Configuration */
 typedef struct {
     uint8_t max_retries;           /* Maximum retry attempts */
@@ -49,8 +72,29 @@ typedef struct {
     uint32_t verify_interval_ms;   /* Connection verification interval (ms) */
     uint8_t auto_reconnect;         /* Auto-reconnect on failure */
     uint8_t verify_on_send;        /* Verify connection before each send */
+    uint32_t retry_max_delay_ms;   /* Backoff cap for async retries (0 = default) */
+    uint8_t retry_jitter_percent;  /* Random reduction of each async retry delay (0-100) */
+    uint8_t link_probe;            /* connection_probe_t used by establish/verify */
+    uint8_t adaptive_retries;      /* Size retries from the rolling success rate */
 } connection_config_t;
 
+/* Async Request Handle (0 is never a valid request) */
+typedef uint32_t connection_request_t;
+#define CONNECTION_REQUEST_INVALID  0
+
+/* Concurrent async requests */
+#define CONNECTION_MAX_REQUESTS     32
+
+/**
+ * @brief Async request completion callback
+ * @param request Request that finished
+ * @param result 0 on success, -1 if every attempt failed
+ * @param context Context given when the request was started
+ *
+ * Runs on the timer wheel thread. Not called for cancelled requests.
+ */
+typedef void (*connection_completion_t)(connection_request_t request, int result, void* context);
+
 /**
  * @brief Initialize connection management
  * @return 0 on success, -1 on failure
@@ -93,6 +137,21 @@ int connection_verify(void);
  */
 int connection_test(unsigned char test_button);
 
+/**
+ * @brief Install a custom link probe and select CONNECTION_PROBE_CUSTOM
+ * @param probe Probe function (NULL restores CONNECTION_PROBE_PASSIVE)
+ * @param context Passed back to the probe
+ * @return 0 on success
+ */
+int connection_set_custom_probe(connection_probe_fn_t probe, void* context);
+
+/**
+ * @brief Check if the link has been confirmed since it was established
+ * @return 1 if a probe or a transmission confirmed it, 0 if confirmation
+ *         is still waiting for the next transmission
+ */
+int connection_is_verified(void);
+
 /**
  * @brief Get current connection status
  * @return Connection status
@@ -141,6 +200,64 @@ void connection_disconnect(void);
  */
 int connection_send_with_retry(ir_code_t code);
 
+/**
+ * @brief Send IR code for a held button with verification and retry
+ * @param code IR code to send
+ * @param hold_ms How long the button is held (ms)
+ * @return 0 on success, -1 on failure
+ */
+int connection_send_hold_with_retry(ir_code_t code, uint32_t hold_ms);
+
+/**
+ * @brief Establish a connection without blocking
+ * @param device_type Device type to connect to
+ * @param done Completion callback (may be NULL)
+ * @param context Passed back to the callback
+ * @return Request handle, or CONNECTION_REQUEST_INVALID if the request
+ *         could not be scheduled
+ *
+ * Attempts run on the timer wheel thread (timer_wheel.h). Failed attempts
+ * are retried up to max_retries times after capped exponential backoff:
+ * retry n waits retry_delay_ms * 2^(n-1), at most retry_max_delay_ms,
+ * minus up to retry_jitter_percent of that delay at random, so devices
+ * retrying together spread out.
+ */
+connection_request_t connection_establish_async(unsigned char device_type,
+                                                connection_completion_t done, void* context);
+
+/**
+ * @brief Send an IR code (optionally held) without blocking
+ * @param code IR code to send
+ * @param hold_ms How long the button is held (0 = single press)
+ * @param done Completion callback (may be NULL)
+ * @param context Passed back to the callback
+ * @return Request handle, or CONNECTION_REQUEST_INVALID if the request
+ *         could not be scheduled
+ *
+ * Retries follow the same backoff as connection_establish_async().
+ * verify_on_send and auto_reconnect apply to the blocking send functions
+ * only; establish the connection with connection_establish_async() first.
+ */
+connection_request_t connection_send_async(ir_code_t code, uint32_t hold_ms,
+                                           connection_completion_t done, void* context);
+
+/**
+ * @brief Cancel an async request
+ * @param request Request handle
+ * @return 0 on success, -1 if the request already finished
+ *
+ * An attempt already in progress completes, but is neither retried nor
+ * reported to the completion callback.
+ */
+int connection_request_cancel(connection_request_t request);
+
+/**
+ * @brief Check if an async request is still in flight
+ * @param request Request handle
+ * @return 1 if pending, 0 if finished, cancelled or unknown
+ */
+int connection_request_pending(connection_request_t request);
+
 /**
  * @brief Reset connection statistics
  */
@@ -148,6 +265,9 @@ void connection_reset_stats(void);
 
 /**
  * @brief Cleanup connection management
+ *
+ * Cancels pending async requests (their callbacks do not run) and
+ * releases this module's use of the shared timer wheel.
  */
 void connection_cleanup(void);
 
@@ -158,6 +278,16 @@ void connection_cleanup(void);
 #define CONNECTION_DEFAULT_VERIFY_INTERVAL_MS 30000
 #define CONNECTION_DEFAULT_AUTO_RECONNECT     1
 #define CONNECTION_DEFAULT_VERIFY_ON_SEND     0
+#define CONNECTION_DEFAULT_RETRY_MAX_DELAY_MS 4000
+#define CONNECTION_DEFAULT_RETRY_JITTER       50
+#define CONNECTION_DEFAULT_LINK_PROBE         CONNECTION_PROBE_PASSIVE
+#define CONNECTION_DEFAULT_ADAPTIVE_RETRIES   1
+
+/* Rolling Quality (EWMA weight of each new attempt, and the rolling
+ * success rates that separate a healthy, degraded and dead link) */
+#define CONNECTION_EWMA_ALPHA                 0.125f
+#define CONNECTION_HEALTHY_SUCCESS            0.95f
+#define CONNECTION_DEAD_SUCCESS               0.25f
 
 #endif /* CONNECTION_H */
 
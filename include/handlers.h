@@ -4,10 +4,20 @@
 #include "remote_buttons.h"
 #include "ir_codes.h"
 #include <stdint.h>
+#include <stddef.h>
 
 /**
  * @file handlers.h
  * @brief Interrupt and event handler definitions for remote control system
+ *
+ * Events are delivered through an event bus: each event_type_t has a
+ * fixed-capacity subscriber array kept sorted by priority, and dispatch is
+ * a loop over that array with no allocation. Any number of modules can
+ * subscribe to the same event with event_subscribe().
+ *
+ * The single-slot handler_register_* functions (and handlers_t) still work.
+ * Each slot owns one bus subscription, so registering a new handler for a
+ * slot replaces only that slot's handler, never other subscribers.
  */
 
 /* Handler Return Codes */
@@ -40,7 +50,8 @@ typedef enum {
     EVENT_SYSTEM_SHUTDOWN,
     EVENT_SYSTEM_RESET,
     EVENT_SYSTEM_ERROR,
-    EVENT_SYSTEM_WARNING
+    EVENT_SYSTEM_WARNING,
+    EVENT_TYPE_COUNT            /* Number of event types (not an event) */
 } event_type_t;
 
 /* Error Types */
@@ -112,6 +123,18 @@ typedef int (*universal_scan_handler_t)(unsigned char button_code, uint16_t code
 typedef int (*universal_protocol_handler_t)(uint8_t protocol, uint32_t code, const char* description);
 typedef int (*universal_brand_handler_t)(uint8_t brand, const char* brand_name);
 
+/* Event Bus */
+#define EVENT_BUS_MAX_SUBSCRIBERS   8       /* Per event type */
+#define EVENT_PRIORITY_HIGH         100
+#define EVENT_PRIORITY_DEFAULT      0
+#define EVENT_PRIORITY_LOW          (-100)
+
+typedef uint32_t event_token_t;
+#define EVENT_TOKEN_INVALID         0
+
+/* Bus subscriber: return HANDLER_SUCCESS, HANDLER_ERROR or HANDLER_IGNORE */
+typedef int (*event_subscriber_t)(const event_t* event, void* context);
+
 /* Handler Registration Structure */
 typedef struct {
     button_handler_t button_pressed;
@@ -132,6 +155,122 @@ typedef struct {
     universal_brand_handler_t universal_brand_detected;
 } handlers_t;
 
+/**
+ * @brief Subscribe to an event type
+ * @param type Event type
+ * @param callback Subscriber function
+ * @param context Passed back to the callback
+ * @param priority Higher priorities run first; equal priorities run in
+ *        subscription order (EVENT_PRIORITY_DEFAULT for most subscribers)
+ * @return Unsubscribe token, or EVENT_TOKEN_INVALID if the type already has
+ *         EVENT_BUS_MAX_SUBSCRIBERS subscribers
+ */
+event_token_t event_subscribe(event_type_t type, event_subscriber_t callback, void* context, int priority);
+
+/**
+ * @brief Remove a subscription
+ * @param token Token returned by event_subscribe
+ * @return 0 on success, -1 if the token is unknown
+ *
+ * Safe to call from inside a subscriber, including for itself. A publisher
+ * on another thread that copied the subscriber list before this call may
+ * still run the callback once after it returns, so free the context only
+ * once such publishers are done (handler_async_flush() for async ones).
+ */
+int event_unsubscribe(event_token_t token);
+
+/**
+ * @brief Get the number of subscribers of an event type
+ * @param type Event type
+ * @return Subscriber count (including handler_register_* slots)
+ */
+int event_subscriber_count(event_type_t type);
+
+/**
+ * @brief Deliver an event to every subscriber of its type
+ * @param event Event to deliver (timestamp is set if 0)
+ * @return 0 if every subscriber returned HANDLER_SUCCESS, otherwise the
+ *         first non-zero subscriber result
+ *
+ * All subscribers run, in priority order, even if one returns an error.
+ */
+int event_publish(event_t* event);
+
+/* Async Dispatch */
+#define HANDLER_ASYNC_DEFAULT_CAPACITY  1024    /* Queued events */
+#define HANDLER_ASYNC_BATCH             32      /* Events drained per batch */
+
+/* Full-queue Policy */
+typedef enum {
+    HANDLER_ASYNC_DROP_NEWEST = 0,  /* Discard the event being published */
+    HANDLER_ASYNC_DROP_OLDEST,      /* Discard the oldest queued event */
+    HANDLER_ASYNC_BLOCK             /* Wait for the dispatcher to make room */
+} handler_backpressure_t;
+
+/* Async Dispatch Counters */
+typedef struct {
+    uint64_t queued;                /* Events handed to the dispatcher */
+    uint64_t delivered;             /* Events delivered by the dispatcher */
+    uint64_t dropped;               /* Events discarded by the full-queue policy */
+    uint32_t depth;                 /* Events currently queued */
+} handler_async_stats_t;
+
+/**
+ * @brief Subscribe to an event type on the dispatcher thread
+ * @param type Event type
+ * @param callback Subscriber function
+ * @param context Passed back to the callback
+ * @param priority Higher runs first among async subscribers
+ * @return Subscription token, or EVENT_TOKEN_INVALID on failure
+ *
+ * While handler_async_start() is running, event_publish() queues a copy of
+ * the event and returns without waiting for async subscribers; their
+ * return values are ignored. Pointer fields in the event (messages,
+ * custom data) must stay valid until delivery. Without a dispatcher,
+ * async subscribers run inline like event_subscribe() ones.
+ */
+event_token_t event_subscribe_async(event_type_t type, event_subscriber_t callback, void* context, int priority);
+
+/**
+ * @brief Start the async dispatcher thread
+ * @param capacity Queue size in events (rounded up to a power of two,
+ *                 0 = HANDLER_ASYNC_DEFAULT_CAPACITY)
+ * @param policy What to do when the queue is full
+ * @return 0 on success (or already running), -1 on failure or if
+ *         threads are unsupported on this platform
+ *
+ * Publishing stays lock-free: producers claim a queue slot with a CAS
+ * and wake the dispatcher, which drains in batches of HANDLER_ASYNC_BATCH.
+ */
+int handler_async_start(size_t capacity, handler_backpressure_t policy);
+
+/**
+ * @brief Stop the async dispatcher thread
+ *
+ * Delivers everything already queued, then joins the thread. Publishers
+ * on other threads must have stopped first.
+ */
+void handler_async_stop(void);
+
+/**
+ * @brief Check if the async dispatcher thread is running
+ * @return 1 if running, 0 otherwise
+ */
+int handler_async_is_running(void);
+
+/**
+ * @brief Wait until every queued event has been delivered
+ *
+ * Returns immediately when called from an async subscriber.
+ */
+void handler_async_flush(void);
+
+/**
+ * @brief Get async dispatch counters
+ * @param stats Output counters
+ */
+void handler_async_get_stats(handler_async_stats_t* stats);
+
 /**
  * @brief Register button press handler
  * @param handler Function to call when button is pressed
@@ -195,6 +334,23 @@ int handler_register_custom_event(event_handler_t handler);
  */
 int handler_register_timer(timer_handler_t handler);
 
+/**
+ * @brief Start calling the timer handler periodically
+ * @param interval_ms Timer interval in milliseconds
+ * @return 0 on success, -1 if no timer handler is registered or the
+ *         timer could not be started
+ *
+ * On Linux the timer runs on the shared timer wheel (timer_wheel.h), so
+ * the handler is called on the wheel thread, not from a signal handler,
+ * and receives the wheel timer ID.
+ */
+int handler_setup_timer(uint32_t interval_ms);
+
+/**
+ * @brief Stop the periodic timer
+ */
+void handler_stop_timer(void);
+
 /**
  * @brief Register interrupt handler
  * @param handler Function to call on hardware interrupt
@@ -211,6 +367,8 @@ int handler_register_all(handlers_t* handlers);
 
 /**
  * @brief Unregister all handlers
+ *
+ * Removes every bus subscription as well.
  */
 void handler_unregister_all(void);
 
@@ -243,6 +401,12 @@ int handler_trigger_ir_transmit_start(ir_code_t code);
  */
 int handler_trigger_ir_transmit_complete(ir_code_t code, int success);
 
+/**
+ * @brief Trigger state change event
+ * @return 0 on success, -1 on failure
+ */
+int handler_trigger_state_changed(void);
+
 /**
  * @brief Trigger error event
  * @param error Error type
@@ -255,6 +419,8 @@ int handler_trigger_error(error_type_t error, const char* message);
  * @brief Trigger custom event
  * @param event Event structure
  * @return 0 on success, -1 on failure
+ *
+ * Calls the custom_event handler, then the bus subscribers of event->type.
  */
 int handler_trigger_custom_event(event_t* event);
 
@@ -266,6 +432,10 @@ int handler_init(void);
 
 /**
  * @brief Cleanup handler system
+ *
+ * Cancels the periodic handler timer and releases the shared timer wheel.
+ * The wheel keeps running while another user (such as async connection
+ * requests) still holds it.
  */
 void handler_cleanup(void);
 
@@ -351,12 +521,70 @@ int handler_trigger_universal_brand_detected(uint8_t brand, const char* brand_na
 
 /* Interrupt callback functions (bridges assembly -> C -> JavaScript) */
 
+/* Top half -> bottom half queue (power of two) */
+#define INTERRUPT_QUEUE_SIZE    64
+
+/* Interrupt Counters */
+typedef struct {
+    uint64_t queued;            /* Interrupts queued by the top half */
+    uint64_t processed;         /* Interrupts handled by the bottom half */
+    uint64_t dropped;           /* Interrupts lost to a full queue */
+    uint32_t pending;           /* Interrupts waiting for the bottom half */
+    uint64_t max_dwell_ns;      /* Longest top half seen by the bottom half */
+} interrupt_stats_t;
+
 /**
  * @brief C callback function called from assembly interrupt handlers
  * This is the bridge between hardware interrupts and C handlers
+ *
+ * Top half only: reads the interrupt source, timestamps it and pushes it
+ * into a single-producer ring. Logging, simulator forwarding and handler
+ * dispatch run later in interrupt_process_deferred(). Interrupts must not
+ * nest (one producer).
  */
 void interrupt_callback(void);
 
+/**
+ * @brief Run the bottom half for every queued interrupt
+ * @return Number of interrupts processed (0 if another thread is already
+ *         draining the queue)
+ *
+ * Call from task context after the ISR returns, or let
+ * interrupt_worker_start() call it. Records the "isr_top_half" (dwell),
+ * "isr_queue_wait" and "isr_bottom_half" latency operations.
+ */
+int interrupt_process_deferred(void);
+
+/**
+ * @brief Start a worker thread that runs the bottom half
+ * @return 0 on success (or already running), -1 on failure or if threads
+ *         are unsupported on this platform
+ *
+ * The top half wakes the worker with sem_post(), which is
+ * async-signal-safe.
+ */
+int interrupt_worker_start(void);
+
+/**
+ * @brief Stop the deferred worker thread (processes what is still queued)
+ *
+ * Waits for top halves already posting to the worker before releasing its
+ * semaphore, so it is safe while interrupts keep arriving.
+ */
+void interrupt_worker_stop(void);
+
+/**
+ * @brief Check if the deferred worker thread is running
+ * @return 1 if running, 0 otherwise
+ */
+int interrupt_worker_is_running(void);
+
+/**
+ * @brief Get top half / bottom half counters
+ * @param stats Output counters
+ */
+void interrupt_get_stats(interrupt_stats_t* stats);
+
 /**
  * @brief Set interrupt type before interrupt occurs
  * @param type 0 = timer interrupt, 1 = GPIO interrupt (button press)
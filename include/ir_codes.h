@@ -26,6 +26,7 @@ typedef struct {
     uint8_t protocol;        /* Protocol type */
     uint16_t frequency;       /* Carrier frequency (typically 38kHz) */
     uint8_t repeat_count;    /* Number of repeats for reliability */
+    uint8_t bit_length;      /* Frame length in bits (0 = protocol default) */
 } ir_code_t;
 
 /* Streaming Service IR Codes (Placeholder values - replace with actual codes) */
@@ -150,6 +151,18 @@ int ir_init(void);
  */
 int ir_send(ir_code_t code);
 
+/**
+ * @brief Send IR code while a button is held
+ * @param code IR code structure to send
+ * @param hold_ms How long the button is held (ms)
+ * @return 0 on success, -1 on failure
+ * 
+ * Sends one full frame, then one repeat per frame period until hold_ms
+ * has elapsed. NEC repeats use the short repeat frame; other protocols
+ * replay the full frame with an unchanged toggle bit.
+ */
+int ir_send_hold(ir_code_t code, uint32_t hold_ms);
+
 /**
  * @brief Deinitialize IR transmission hardware
  */
@@ -0,0 +1,144 @@
+#ifndef IR_PULSE_H
+#define IR_PULSE_H
+
+#include <stdint.h>
+#include "ir_codes.h"
+
+/**
+ * @file ir_pulse.h
+ * @brief Precomputed mark/space pulse trains for IR transmission
+ *
+ * Protocol encoders turn an IR code into a compact array of mark (carrier ON)
+ * and space (carrier OFF) durations once. A single replay engine then plays
+ * the array back with one delay per edge instead of one per half-bit.
+ * Encoding and transmission can be measured separately, and repeat frames
+ * reuse the same buffer without being encoded again.
+ */
+
+/* Maximum entries per frame (NEC: leader + 32 bits + stop = 67 entries) */
+#define IR_PULSE_MAX_ENTRIES    80
+
+/* Entry layout: bit 15 = mark (carrier ON), bits 14-0 = duration in us */
+#define IR_PULSE_MARK           0x8000
+#define IR_PULSE_DURATION_MASK  0x7FFF
+
+/* Pulse Train Structure */
+typedef struct {
+    uint16_t entries[IR_PULSE_MAX_ENTRIES]; /* Mark/space entries, in order */
+    uint16_t count;                         /* Number of valid entries */
+    uint16_t frequency;                     /* Carrier frequency (Hz) */
+    uint32_t duration_us;                   /* Total frame duration (us) */
+    uint32_t repeat_gap_us;                 /* Idle time before next repeat (us) */
+} ir_pulse_train_t;
+
+/* Replay Timing Modes */
+typedef enum {
+    IR_TIMING_RELATIVE,     /* delay_us() per entry (errors accumulate) */
+    IR_TIMING_DEADLINE      /* Absolute CLOCK_MONOTONIC deadline per edge */
+} ir_timing_mode_t;
+
+/* Edge Timing Report (filled by deadline-mode replays) */
+typedef struct {
+    uint16_t edge_count;                             /* Edges measured (entries + final OFF) */
+    uint32_t edge_late_ns[IR_PULSE_MAX_ENTRIES + 1]; /* Lateness of each edge (ns) */
+    uint32_t max_late_ns;                            /* Worst edge lateness (ns) */
+    uint32_t avg_late_ns;                            /* Mean edge lateness (ns) */
+    int32_t frame_error_ns;                          /* Actual minus nominal frame length (ns) */
+} ir_pulse_report_t;
+
+/**
+ * @brief Encode an IR code into a pulse train
+ * @param code IR code structure (protocol selects the encoder)
+ * @param train Output pulse train
+ * @return 0 on success, -1 if the protocol is not supported
+ */
+int ir_pulse_encode(ir_code_t code, ir_pulse_train_t* train);
+
+/**
+ * @brief Encode a 14-bit RC5 frame (Manchester, 889us half-bits)
+ * @param rc5_code 14-bit RC5 code (see ir_code_to_rc5)
+ * @param train Output pulse train
+ * @return 0 on success, -1 on failure
+ */
+int ir_pulse_encode_rc5(uint16_t rc5_code, ir_pulse_train_t* train);
+
+/**
+ * @brief Encode a 20-bit RC6 frame (leader + Manchester, 444us half-bits)
+ * @param rc6_code 20-bit RC6 code (see ir_code_to_rc6)
+ * @param train Output pulse train
+ * @return 0 on success, -1 on failure
+ */
+int ir_pulse_encode_rc6(uint32_t rc6_code, ir_pulse_train_t* train);
+
+/**
+ * @brief Encode a 32-bit NEC frame (leader, 32 bits LSB first, stop bit)
+ * @param code 32-bit NEC code
+ * @param train Output pulse train
+ * @return 0 on success, -1 on failure
+ */
+int ir_pulse_encode_nec(uint32_t code, ir_pulse_train_t* train);
+
+/**
+ * @brief Encode the NEC repeat frame (9ms pulse, 2.25ms space, 560us pulse)
+ * @param train Output pulse train
+ * @return 0 on success, -1 on failure
+ *
+ * Sent every 108ms after a full NEC frame while the button is held.
+ */
+int ir_pulse_encode_nec_repeat(ir_pulse_train_t* train);
+
+/**
+ * @brief Encode a Sony SIRC frame (40kHz, pulse-width coded)
+ * @param code SIRC code in MSB-first notation (e.g. 0xA90 = Power)
+ * @param bit_length Frame length: 12, 15 or 20 bits (0 = 12)
+ * @param train Output pulse train
+ * @return 0 on success, -1 on invalid bit length
+ *
+ * repeat_gap_us is set so frames start every 45ms.
+ */
+int ir_pulse_encode_sony(uint32_t code, uint8_t bit_length, ir_pulse_train_t* train);
+
+/**
+ * @brief Replay a pulse train on the IR LED
+ * @param train Encoded pulse train
+ *
+ * Drives the LED once per entry and leaves it OFF when done. Uses the
+ * timing mode selected with ir_pulse_set_timing_mode().
+ */
+void ir_pulse_send(const ir_pulse_train_t* train);
+
+/**
+ * @brief Replay a pulse train against absolute deadlines
+ * @param train Encoded pulse train
+ * @param report Optional output for per-edge lateness (may be NULL)
+ * @return 0 on success, -1 on failure
+ *
+ * Every edge is scheduled at frame start + sum of previous durations on
+ * CLOCK_MONOTONIC, so sleep overshoot on one edge does not shift the
+ * following ones and the frame length does not drift.
+ */
+int ir_pulse_send_deadline(const ir_pulse_train_t* train, ir_pulse_report_t* report);
+
+/**
+ * @brief Select the timing mode used by ir_pulse_send()
+ * @param mode IR_TIMING_RELATIVE (default) or IR_TIMING_DEADLINE
+ */
+void ir_pulse_set_timing_mode(ir_timing_mode_t mode);
+
+/**
+ * @brief Get the timing mode used by ir_pulse_send()
+ * @return Current timing mode
+ */
+ir_timing_mode_t ir_pulse_get_timing_mode(void);
+
+/**
+ * @brief Get the edge report of the calling thread's last deadline-mode replay
+ * @param report Output report
+ * @return 0 on success, -1 if no deadline-mode replay has run on this thread
+ *
+ * Reports are kept per thread, so replays on other threads (for example
+ * repeat frames sent from the timer wheel) do not overwrite it.
+ */
+int ir_pulse_get_last_report(ir_pulse_report_t* report);
+
+#endif /* IR_PULSE_H */
@@ -14,14 +14,54 @@
  * - Universal TV multi-protocol latency
  * - Event handler latency
  * - Overall system latency
+ * 
+ * Samples are recorded lock-free into per-thread rings and merged on
+ * demand by latency_get_stats(). Recording is not async-signal-safe.
+ * 
+ * Latencies are recorded in nanoseconds. Timestamps come from the active
+ * timebase, or from the CPU cycle counter (invariant TSC on x86-64,
+ * CNTVCT on aarch64) when LATENCY_CLOCK_CYCLES is selected.
  */
 
+/* Marks API kept for source compatibility */
+#if defined(__GNUC__) || defined(__clang__)
+#define LATENCY_DEPRECATED __attribute__((deprecated))
+#else
+#define LATENCY_DEPRECATED
+#endif
+
+/* Timestamp Sources */
+typedef enum {
+    LATENCY_CLOCK_TIMEBASE,     /* timebase_now_ns() (realtime or virtual) */
+    LATENCY_CLOCK_CYCLES        /* Calibrated CPU cycle counter */
+} latency_clock_t;
+
+/* Cycle counter calibration window */
+#define LATENCY_CALIBRATION_US  10000
+
+/* Number of per-thread sample rings (extra threads share the last one) */
+#define LATENCY_MAX_RINGS   8
+
+/* Interned operation IDs (see latency_register_op) */
+typedef uint16_t latency_op_t;
+#define LATENCY_MAX_OPS     32              /* Power of two */
+#define LATENCY_OP_NAME_LEN 32              /* Longer names are truncated */
+#define LATENCY_OP_INVALID  ((latency_op_t)0xFFFF)
+
+/* Histogram layout: 2^SUB_BITS linear buckets per power of two (~3% error),
+ * values in nanoseconds up to 2^MAX_BITS - 1 (~18 minutes) */
+#define LATENCY_HIST_SUB_BITS   5
+#define LATENCY_HIST_SUB_COUNT  (1u << LATENCY_HIST_SUB_BITS)
+#define LATENCY_HIST_MAX_BITS   40
+#define LATENCY_HIST_BUCKETS    ((LATENCY_HIST_MAX_BITS + 1u - LATENCY_HIST_SUB_BITS) * LATENCY_HIST_SUB_COUNT)
+
 /* Latency Measurement Structure */
 typedef struct {
-    uint64_t timestamp_us;      /* Timestamp in microseconds */
-    uint32_t latency_us;        /* Measured latency in microseconds */
+    uint64_t timestamp_ns;      /* Completion timestamp in nanoseconds */
+    uint64_t latency_ns;        /* Measured latency in nanoseconds */
     const char* operation;      /* Operation name */
     uint32_t code;              /* Associated code/ID */
+    latency_op_t op;            /* Interned operation ID */
 } latency_sample_t;
 
 /* Latency Statistics */
@@ -34,28 +74,54 @@ typedef struct {
     uint32_t p50_us;            /* 50th percentile (median) */
     uint32_t p95_us;            /* 95th percentile */
     uint32_t p99_us;            /* 99th percentile */
-    latency_sample_t* samples;   /* Sample buffer */
-    size_t sample_capacity;     /* Maximum samples */
-    size_t sample_count;        /* Current sample count */
+    uint64_t min_ns;            /* Minimum latency (nanoseconds) */
+    uint64_t max_ns;            /* Maximum latency (nanoseconds) */
+    uint64_t sum_ns;            /* Sum of all latencies (nanoseconds) */
+    uint64_t avg_ns;            /* Average latency (nanoseconds) */
+    uint64_t p50_ns;            /* 50th percentile (nanoseconds) */
+    uint64_t p95_ns;            /* 95th percentile (nanoseconds) */
+    uint64_t p99_ns;            /* 99th percentile (nanoseconds) */
+    /* Deprecated: never filled (percentiles come from the histogram; use
+     * latency_get_samples() for raw samples) */
+    latency_sample_t* samples LATENCY_DEPRECATED;
+    size_t sample_capacity LATENCY_DEPRECATED;
+    size_t sample_count LATENCY_DEPRECATED;
 } latency_stats_t;
 
+/* Log-linear Latency Histogram (HdrHistogram-style, fixed memory) */
+typedef struct {
+    uint64_t counts[LATENCY_HIST_BUCKETS]; /* Samples per bucket */
+    uint64_t total;                        /* Total samples */
+    uint64_t min_ns;                       /* Minimum latency (UINT64_MAX if empty) */
+    uint64_t max_ns;                       /* Maximum latency */
+} latency_histogram_t;
+
 /* Latency Probe Context */
 typedef struct {
     uint64_t start_time_us;     /* Probe start time */
     uint64_t end_time_us;       /* Probe end time */
+    uint64_t start_time_ns;     /* Probe start time (full resolution) */
+    uint64_t end_time_ns;       /* Probe end time (full resolution) */
     const char* probe_name;     /* Probe identifier */
     int active;                 /* Is probe active */
 } latency_probe_t;
 
 /**
  * @brief Initialize latency measurement system
- * @param max_samples Maximum number of samples to store
+ * @param max_samples Samples kept per thread ring (rounded up to a power of two)
  * @return 0 on success, -1 on failure
+ * 
+ * Each ring keeps its newest max_samples samples; counters (count, sum,
+ * min, max) cover every sample recorded since the last reset.
  */
 int latency_init(size_t max_samples);
 
 /**
  * @brief Cleanup latency measurement system
+ * 
+ * Also closes the binary log (see latency_log.h) if one is open. Records
+ * in progress on other threads are waited for; later records fail. Do not
+ * call it concurrently with latency_init() or with the query functions.
  */
 void latency_cleanup(void);
 
@@ -65,6 +131,33 @@ void latency_cleanup(void);
  */
 uint64_t latency_get_timestamp_us(void);
 
+/**
+ * @brief Get current high-precision timestamp in nanoseconds
+ * @return Timestamp in nanoseconds (cycle counter or timebase)
+ * 
+ * While the virtual timebase is active the timebase is always used, so
+ * simulated delays stay visible in latencies.
+ */
+uint64_t latency_get_timestamp_ns(void);
+
+/**
+ * @brief Select the timestamp source
+ * @param clock LATENCY_CLOCK_TIMEBASE or LATENCY_CLOCK_CYCLES
+ * @return 0 on success, -1 if the cycle counter is unavailable
+ * 
+ * Selecting LATENCY_CLOCK_CYCLES calibrates the counter against the
+ * timebase for LATENCY_CALIBRATION_US (aarch64 reads CNTFRQ instead).
+ * latency_init() selects it automatically when built with
+ * -DLATENCY_CYCLE_CLOCK (make CYCLE_CLOCK=1).
+ */
+int latency_set_clock(latency_clock_t clock);
+
+/**
+ * @brief Get the active timestamp source
+ * @return Active clock
+ */
+latency_clock_t latency_get_clock(void);
+
 /**
  * @brief Start a latency probe
  * @param probe Probe context (must be allocated by caller)
@@ -99,18 +192,146 @@ uint32_t latency_measure(uint64_t start_us, uint64_t end_us);
  */
 int latency_record(uint32_t latency_us, const char* operation, uint32_t code);
 
+/**
+ * @brief Record a latency sample with a known completion timestamp
+ * @param latency_us Latency in microseconds
+ * @param operation Operation name
+ * @param code Associated code/ID
+ * @param timestamp_us Completion timestamp (avoids reading the clock again)
+ * @return 0 on success, -1 on failure
+ * 
+ * Wait-free: writes only to the calling thread's ring.
+ */
+int latency_record_at(uint32_t latency_us, const char* operation, uint32_t code,
+                      uint64_t timestamp_us);
+
+/**
+ * @brief Register an operation name and get its ID
+ * @param name Operation name (copied; only the first
+ *        LATENCY_OP_NAME_LEN - 1 characters are significant)
+ * @return Operation ID, or LATENCY_OP_INVALID if the table is full
+ * 
+ * Registering the same name again returns the same ID. Each ID owns its
+ * own counters and histogram. IDs stay valid across latency_cleanup().
+ * Lookup hashes the name and compares it only against the slot with the
+ * same hash, so string-based recording costs one pass over the name.
+ */
+latency_op_t latency_register_op(const char* name);
+
+/**
+ * @brief Find the ID of a registered operation
+ * @param name Operation name
+ * @return Operation ID, or LATENCY_OP_INVALID if not registered
+ */
+latency_op_t latency_find_op(const char* name);
+
+/**
+ * @brief Get the name of a registered operation
+ * @param op Operation ID
+ * @return Operation name, or NULL if not registered
+ */
+const char* latency_op_name(latency_op_t op);
+
+/**
+ * @brief Record a latency sample for an interned operation
+ * @param op Operation ID (LATENCY_OP_INVALID records global stats only)
+ * @param latency_us Latency in microseconds
+ * @param code Associated code/ID
+ * @param timestamp_us Completion timestamp
+ * @return 0 on success, -1 on failure
+ * 
+ * Wait-free, no string handling.
+ */
+int latency_record_op(latency_op_t op, uint32_t latency_us, uint32_t code, uint64_t timestamp_us);
+
+/**
+ * @brief Record a nanosecond latency sample for an interned operation
+ * @param op Operation ID (LATENCY_OP_INVALID records global stats only)
+ * @param latency_ns Latency in nanoseconds
+ * @param code Associated code/ID
+ * @param timestamp_ns Completion timestamp (latency_get_timestamp_ns time base)
+ * @return 0 on success, -1 on failure
+ */
+int latency_record_op_ns(latency_op_t op, uint64_t latency_ns, uint32_t code, uint64_t timestamp_ns);
+
+/**
+ * @brief Copy the samples still held in the thread rings
+ * @param samples Output buffer
+ * @param max_samples Capacity of the output buffer
+ * @return Number of samples copied
+ */
+size_t latency_get_samples(latency_sample_t* samples, size_t max_samples);
+
 /**
  * @brief Get latency statistics
  * @param stats Output structure for statistics
  * @return 0 on success, -1 on failure
+ * 
+ * Counters and percentiles cover every sample since the last reset.
+ * Percentiles come from the merged histogram (no copy, no sort).
  */
 int latency_get_stats(latency_stats_t* stats);
 
+/**
+ * @brief Get the merged latency histogram of all threads
+ * @param hist Output histogram
+ * @return 0 on success, -1 on failure
+ */
+int latency_get_histogram(latency_histogram_t* hist);
+
+/**
+ * @brief Clear a histogram
+ * @param hist Histogram to clear
+ */
+void latency_histogram_reset(latency_histogram_t* hist);
+
+/**
+ * @brief Add one latency value to a histogram (O(1))
+ * @param hist Histogram
+ * @param value_ns Latency in nanoseconds
+ */
+void latency_histogram_record(latency_histogram_t* hist, uint64_t value_ns);
+
+/**
+ * @brief Add all counts of one histogram to another
+ * @param dst Destination histogram
+ * @param src Source histogram
+ */
+void latency_histogram_merge(latency_histogram_t* dst, const latency_histogram_t* src);
+
+/**
+ * @brief Get the latency at a percentile (O(buckets))
+ * @param hist Histogram
+ * @param percentile Percentile (0-100)
+ * @return Highest latency (ns) in the percentile's bucket (capped at max), 0 if empty
+ */
+uint64_t latency_histogram_percentile(const latency_histogram_t* hist, double percentile);
+
+/**
+ * @brief Get latency statistics for an interned operation
+ * @param op Operation ID
+ * @param stats Output structure for statistics
+ * @return 0 on success, -1 on failure
+ * 
+ * Direct lookup of the operation's counters and histogram.
+ */
+int latency_get_stats_for_op(latency_op_t op, latency_stats_t* stats);
+
+/**
+ * @brief Get the latency histogram of one operation
+ * @param op Operation ID
+ * @param hist Output histogram
+ * @return 0 on success, -1 on failure
+ */
+int latency_get_op_histogram(latency_op_t op, latency_histogram_t* hist);
+
 /**
  * @brief Get latency statistics for a specific operation
  * @param operation Operation name
  * @param stats Output structure for statistics
  * @return 0 on success, -1 on failure
+ * 
+ * Looks up the operation ID once; unknown operations report no samples.
  */
 int latency_get_stats_for_operation(const char* operation, latency_stats_t* stats);
 
@@ -157,14 +378,38 @@ uint32_t latency_get_min(void);
 #define LATENCY_PROBE_STOP(probe, op, code) \
     latency_probe_stop(&(probe), (op), (code))
 
+/* Start/end timestamps are microseconds (see latency_get_timestamp_us) */
 #define LATENCY_MEASURE_START() \
     latency_get_timestamp_us()
 
+/* Interns the operation name once per call site */
 #define LATENCY_MEASURE_END(start, op, code) \
     do { \
+        static _Atomic latency_op_t _op_id = LATENCY_OP_INVALID; \
+        latency_op_t _id = _op_id; \
         uint64_t _end = latency_get_timestamp_us(); \
-        uint32_t _lat = latency_measure((start), _end); \
-        latency_record(_lat, (op), (code)); \
+        if (_id == LATENCY_OP_INVALID) { \
+            _id = latency_register_op(op); \
+            _op_id = _id; \
+        } \
+        latency_record_op(_id, latency_measure((start), _end), (code), _end); \
+    } while(0)
+
+/* Nanosecond variants: start/end timestamps from latency_get_timestamp_ns */
+#define LATENCY_MEASURE_START_NS() \
+    latency_get_timestamp_ns()
+
+#define LATENCY_MEASURE_END_NS(start, op, code) \
+    do { \
+        static _Atomic latency_op_t _op_id = LATENCY_OP_INVALID; \
+        latency_op_t _id = _op_id; \
+        uint64_t _end = latency_get_timestamp_ns(); \
+        uint64_t _start = (start); \
+        if (_id == LATENCY_OP_INVALID) { \
+            _id = latency_register_op(op); \
+            _op_id = _id; \
+        } \
+        latency_record_op_ns(_id, _end > _start ? _end - _start : 0, (code), _end); \
     } while(0)
 
 #endif /* LATENCY_H */
@@ -0,0 +1,138 @@
+#ifndef LATENCY_LOG_H
+#define LATENCY_LOG_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "latency.h"
+
+/**
+ * @file latency_log.h
+ * @brief Memory-mapped binary latency log for long soak runs
+ *
+ * While a log is open, every sample recorded through latency.h is also
+ * appended as a fixed-size record to a size-capped ring file mapped with
+ * mmap(MAP_SHARED). Records land in the page cache as they are written,
+ * so a crash loses nothing that was recorded, and memory use does not
+ * grow with run time. bin/latency_report analyzes the file offline.
+ *
+ * File layout: one LATENCY_LOG_HEADER_SIZE header (counters and operation
+ * names), followed by capacity records. Record i lives in slot
+ * i % capacity; its seq field is i + 1 once it is fully written.
+ *
+ * Records carry the log's operation IDs (indices into op_names), not the
+ * process's: a continued log maps each operation to its existing slot by
+ * name, so records of different runs keep their names.
+ */
+
+#define LATENCY_LOG_MAGIC           0x474F4C4Cu    /* "LLOG" */
+#define LATENCY_LOG_VERSION         1
+#define LATENCY_LOG_HEADER_SIZE     4096
+#define LATENCY_LOG_NAME_LEN        32
+#define LATENCY_LOG_DEFAULT_RECORDS (1u << 20)     /* 32 MB file */
+
+/* Log File Header */
+typedef struct {
+    uint32_t magic;                                     /* LATENCY_LOG_MAGIC */
+    uint16_t version;                                   /* LATENCY_LOG_VERSION */
+    uint16_t record_size;                               /* sizeof(latency_log_record_t) */
+    uint64_t capacity;                                  /* Record slots in the ring */
+    _Atomic uint64_t head;                              /* Records appended so far */
+    uint64_t created_ns;                                /* Timestamp when the log was created */
+    char op_names[LATENCY_MAX_OPS][LATENCY_LOG_NAME_LEN]; /* Operation ID -> name */
+} latency_log_header_t;
+
+/* Log Record (fixed size, 32 bytes) */
+typedef struct {
+    _Atomic uint64_t seq;       /* Record index + 1 (0 while being written) */
+    uint64_t timestamp_ns;      /* Completion timestamp in nanoseconds */
+    uint64_t latency_ns;        /* Measured latency in nanoseconds */
+    uint32_t code;              /* Associated code/ID */
+    uint16_t op;                /* Log operation ID (index into op_names) */
+    uint16_t reserved;
+} latency_log_record_t;
+
+/* Read-only Log Mapping (for offline analysis) */
+typedef struct {
+    const latency_log_header_t* header; /* Mapped header */
+    const latency_log_record_t* records; /* Mapped record slots */
+    size_t map_size;                    /* Size of the mapping */
+} latency_log_view_t;
+
+/**
+ * @brief Open (or create) the binary log and start appending to it
+ * @param path Log file path
+ * @param max_records Ring capacity in records (0 = LATENCY_LOG_DEFAULT_RECORDS)
+ * @return 0 on success, -1 on failure
+ *
+ * An existing log with the same capacity is continued, so a restarted soak
+ * run keeps its history. A file of any other size or format is left
+ * untouched and the call fails.
+ */
+int latency_log_open(const char* path, size_t max_records);
+
+/**
+ * @brief Flush and unmap the binary log
+ *
+ * Waits for appends already in progress on other threads to finish.
+ */
+void latency_log_close(void);
+
+/**
+ * @brief Check if a binary log is open
+ * @return 1 if open, 0 otherwise
+ */
+int latency_log_is_open(void);
+
+/**
+ * @brief Flush mapped records to disk (msync)
+ * @return 0 on success, -1 on failure
+ *
+ * Only needed to survive power loss; a process crash keeps the records.
+ */
+int latency_log_sync(void);
+
+/**
+ * @brief Append one record (called by the latency recording functions)
+ * @param op Operation ID
+ * @param latency_ns Latency in nanoseconds
+ * @param code Associated code/ID
+ * @param timestamp_ns Completion timestamp in nanoseconds
+ *
+ * Lock-free: claims a slot with one atomic add on the mapped header (a
+ * mutex is only taken by the first append of a newly registered
+ * operation, to name it in the file). Does nothing when no log is open.
+ */
+void latency_log_append(latency_op_t op, uint64_t latency_ns, uint32_t code, uint64_t timestamp_ns);
+
+/**
+ * @brief Map an existing log read-only
+ * @param path Log file path
+ * @param view Output mapping
+ * @return 0 on success, -1 if the file is missing or not a valid log
+ */
+int latency_log_view_open(const char* path, latency_log_view_t* view);
+
+/**
+ * @brief Unmap a log opened with latency_log_view_open
+ * @param view Mapping to release
+ */
+void latency_log_view_close(latency_log_view_t* view);
+
+/**
+ * @brief Get the range of records still held by the ring
+ * @param view Log mapping
+ * @param first Output: index of the oldest record kept
+ * @return Index one past the newest record
+ */
+uint64_t latency_log_view_range(const latency_log_view_t* view, uint64_t* first);
+
+/**
+ * @brief Read one record as a latency sample
+ * @param view Log mapping
+ * @param index Record index (from latency_log_view_range)
+ * @param sample Output sample (operation points into the mapping)
+ * @return 0 on success, -1 if the record was overwritten or never completed
+ */
+int latency_log_view_get(const latency_log_view_t* view, uint64_t index, latency_sample_t* sample);
+
+#endif /* LATENCY_LOG_H */
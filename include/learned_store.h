@@ -0,0 +1,122 @@
+#ifndef LEARNED_STORE_H
+#define LEARNED_STORE_H
+
+#include <stdint.h>
+
+/**
+ * @file learned_store.h
+ * @brief Persistent store for learned/confirmed IR codes
+ *
+ * Codes confirmed in scan mode (or captured by an IR receiver) are kept
+ * per (device, button) so UNIVERSAL_MODE_LEARNED can send one frame
+ * instead of sweeping every protocol after a restart.
+ *
+ * The file is an append-only log of fixed-size records, each with its own
+ * CRC-32. A put appends one record with a single write() and syncs it; the
+ * last valid record for a key wins. A record that fails its CRC is
+ * skipped when the store is next opened (the previous value for its key
+ * stays in effect) and replay continues with the next record; only a
+ * partial record at the end, torn by a crash, is truncated. Creating the
+ * file and compacting it also sync the directory. When superseded records
+ * dominate the file, it is compacted by writing the live records to a
+ * temporary file and renaming it over the log.
+ *
+ * The records are loaded into a table indexed directly by device and
+ * button code, so lookups never touch the file.
+ */
+
+#define LEARNED_RECORD_MAGIC        0x314E524Cu    /* "LRN1" */
+#define LEARNED_MAX_DEVICES         8              /* Device types 0-7 (see DEVICE_* in remote_control.h) */
+#define LEARNED_COMPACT_SLACK       64             /* Superseded records tolerated before compaction */
+
+/* Store file (path overridden by the LEARNED_CODES environment variable) */
+#define LEARNED_STORE_DEFAULT_PATH  "learned_codes.dat"
+#define LEARNED_STORE_PATH_ENV      "LEARNED_CODES"
+
+/* Learned Code */
+typedef struct {
+    uint32_t code;              /* IR code value */
+    uint8_t protocol;           /* IR_PROTOCOL_* */
+    uint8_t bit_length;         /* Number of bits */
+} learned_code_t;
+
+/* Log Record (fixed size, 20 bytes) */
+typedef struct {
+    uint32_t magic;             /* LEARNED_RECORD_MAGIC */
+    uint32_t sequence;          /* Write order */
+    uint32_t code;              /* IR code value */
+    uint8_t device;             /* Device type */
+    uint8_t button_code;        /* Button code from remote_buttons.h */
+    uint8_t protocol;           /* IR_PROTOCOL_* (0 = erased) */
+    uint8_t bit_length;         /* Number of bits */
+    uint32_t crc;               /* CRC-32 of the preceding fields */
+} learned_record_t;
+
+/* Store Statistics */
+typedef struct {
+    uint32_t live;              /* Keys with a learned code */
+    uint32_t records;           /* Records in the log */
+    uint32_t dropped;           /* Torn/corrupt records dropped at open */
+    uint32_t compactions;       /* Log rewrites since open */
+} learned_store_stats_t;
+
+/**
+ * @brief Load the store into memory
+ * @param path Store file (NULL = $LEARNED_CODES or LEARNED_STORE_DEFAULT_PATH)
+ * @return 0 on success (a missing file is an empty store), -1 on failure
+ *
+ * The file is created by the first learned_store_put().
+ */
+int learned_store_open(const char* path);
+
+/**
+ * @brief Close the store (learned codes are already on disk)
+ */
+void learned_store_close(void);
+
+/**
+ * @brief Check if the store is open
+ * @return 1 if open, 0 otherwise
+ */
+int learned_store_is_open(void);
+
+/**
+ * @brief Save a code for a device and button
+ * @param device Device type (< LEARNED_MAX_DEVICES)
+ * @param button_code Button code
+ * @param code Code to save (protocol must be non-zero)
+ * @return 0 once the record is on disk, -1 on failure (the stored code is
+ *         unchanged)
+ */
+int learned_store_put(uint8_t device, unsigned char button_code, const learned_code_t* code);
+
+/**
+ * @brief Look up the code for a device and button
+ * @param device Device type
+ * @param button_code Button code
+ * @param code Output code (may be NULL to only test presence)
+ * @return 0 if a code is stored, -1 otherwise
+ */
+int learned_store_get(uint8_t device, unsigned char button_code, learned_code_t* code);
+
+/**
+ * @brief Forget the code for a device and button
+ * @param device Device type
+ * @param button_code Button code
+ * @return 0 on success (or nothing stored), -1 on failure
+ */
+int learned_store_erase(uint8_t device, unsigned char button_code);
+
+/**
+ * @brief Rewrite the log with only the live records (atomic rename)
+ * @return 0 on success, -1 on failure
+ */
+int learned_store_compact(void);
+
+/**
+ * @brief Get store statistics
+ * @param stats Output statistics
+ */
+void learned_store_get_stats(learned_store_stats_t* stats);
+
+#endif /* LEARNED_STORE_H */
@@ -30,9 +30,23 @@ int remote_init(void);
  * @brief Press a button on the remote
  * @param button_code Button code from remote_buttons.h
  * @return 0 on success, -1 on failure
+ *
+ * Blocks until the send and its retries finish. For a non-blocking press,
+ * use connection_send_async() (connection.h).
  */
 int remote_press_button(unsigned char button_code);
 
+/**
+ * @brief Hold a button on the remote
+ * @param button_code Button code from remote_buttons.h
+ * @param hold_ms How long the button is held (ms)
+ * @return 0 on success, -1 on failure
+ * 
+ * Sends one full IR frame followed by repeat frames for the hold time
+ * (the short repeat frame for NEC). Remote state is updated once.
+ */
+int remote_hold_button(unsigned char button_code, uint32_t hold_ms);
+
 /**
  * @brief Get button name from button code
  * @param button_code Button code
@@ -0,0 +1,91 @@
+#ifndef TIMEBASE_H
+#define TIMEBASE_H
+
+#include <stdint.h>
+
+/**
+ * @file timebase.h
+ * @brief Pluggable clock and delay backend
+ *
+ * Every delay (delay_us, retry waits, repeat gaps) and every latency
+ * timestamp goes through the active timebase backend:
+ * - Realtime: CLOCK_MONOTONIC / QueryPerformanceCounter and real sleeps
+ * - Virtual: a simulated clock that advances instantly on every sleep,
+ *   so IR transmission costs zero wall time while timestamps stay exact
+ *
+ * Custom backends (for example a stepped test clock) can be installed
+ * with timebase_set_backend().
+ */
+
+/* Spin-wait window before an absolute deadline (covers Linux 50us timer slack) */
+#define TIMEBASE_SPIN_US    100
+
+/* Timebase Backend */
+typedef struct {
+    const char* name;                               /* Backend name */
+    uint64_t (*now_ns)(void);                       /* Monotonic time (ns) */
+    void (*sleep_us)(uint32_t us);                  /* Relative sleep */
+    void (*sleep_until_ns)(uint64_t deadline_ns);   /* Absolute sleep */
+} timebase_backend_t;
+
+/**
+ * @brief Install a timebase backend
+ * @param backend Backend to use (NULL restores the realtime backend)
+ * @return 0 on success, -1 if the backend is incomplete
+ */
+int timebase_set_backend(const timebase_backend_t* backend);
+
+/**
+ * @brief Get the active timebase backend
+ * @return Active backend (never NULL)
+ */
+const timebase_backend_t* timebase_get_backend(void);
+
+/**
+ * @brief Switch to the realtime backend
+ */
+void timebase_use_realtime(void);
+
+/**
+ * @brief Switch to the virtual clock backend
+ * @param start_ns Initial virtual time in nanoseconds
+ *
+ * Sleeps advance the virtual clock and return immediately.
+ */
+void timebase_use_virtual(uint64_t start_ns);
+
+/**
+ * @brief Check if the virtual clock backend is active
+ * @return 1 if virtual, 0 otherwise
+ */
+int timebase_is_virtual(void);
+
+/**
+ * @brief Advance the virtual clock
+ * @param ns Nanoseconds to advance (ignored unless virtual)
+ */
+void timebase_advance_ns(uint64_t ns);
+
+/**
+ * @brief Get current time from the active backend
+ * @return Monotonic time in nanoseconds
+ */
+uint64_t timebase_now_ns(void);
+
+/**
+ * @brief Sleep for a relative duration on the active backend
+ * @param us Microseconds to sleep
+ */
+void timebase_sleep_us(uint32_t us);
+
+/**
+ * @brief Sleep until an absolute deadline on the active backend
+ * @param deadline_ns Deadline in nanoseconds (timebase_now_ns time base)
+ *
+ * The realtime backend sleeps against the absolute deadline
+ * (clock_nanosleep TIMER_ABSTIME on Linux) until TIMEBASE_SPIN_US before
+ * it, then spin-waits the rest. Returns immediately if already late.
+ */
+void timebase_sleep_until_ns(uint64_t deadline_ns);
+
+#endif /* TIMEBASE_H */
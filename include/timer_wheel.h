@@ -0,0 +1,150 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @file timer_wheel.h
+ * @brief Hierarchical timer wheel for software timers
+ *
+ * Thousands of one-shot and periodic timers share one wheel with a 1 ms
+ * tick. Timers live in a pool allocated by timer_wheel_init() and sit on
+ * intrusive lists, so adding and cancelling are O(1) and never allocate.
+ *
+ * The wheel has TIMER_WHEEL_LEVELS levels of TIMER_WHEEL_SLOTS slots.
+ * Level 0 holds timers due within 64 ms, level 1 within 4 s, level 2
+ * within 4.4 min and level 3 within 4.6 h; far timers move down a level
+ * as their slot comes up.
+ *
+ * On Linux, timer_wheel_start() runs the wheel on a thread blocked in
+ * epoll_wait() on a single timerfd. The timerfd is armed for the next
+ * occupied slot only, so idle ticks cost nothing and all timers due in
+ * the same tick fire from one wakeup. Elsewhere the wheel can be driven
+ * from an existing loop with timer_wheel_advance().
+ *
+ * Callbacks run on the wheel thread (or the thread calling
+ * timer_wheel_advance()), never in signal context.
+ */
+
+/* Wheel Geometry */
+#define TIMER_WHEEL_LEVELS          4
+#define TIMER_WHEEL_SLOT_BITS       6
+#define TIMER_WHEEL_SLOTS           (1 << TIMER_WHEEL_SLOT_BITS)
+#define TIMER_WHEEL_MAX_DELAY_MS    ((1u << (TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOT_BITS)) - 1)
+
+/* Default pool size (timers) */
+#define TIMER_WHEEL_DEFAULT_TIMERS  4096
+
+/* Timer ID (0 is never a valid timer) */
+typedef uint32_t timer_id_t;
+#define TIMER_ID_INVALID            0
+
+/**
+ * @brief Timer callback
+ * @param id Timer that expired
+ * @param context Context given to timer_wheel_add()
+ * @return 0 to keep a periodic timer running, non-zero to cancel it
+ *         (ignored for one-shot timers)
+ */
+typedef int (*timer_wheel_callback_t)(timer_id_t id, void* context);
+
+/* Timer Wheel Statistics */
+typedef struct {
+    uint64_t wakeups;           /* Wheel thread wakeups (timerfd expirations) */
+    uint64_t fired;             /* Callbacks run */
+    uint32_t active;            /* Timers currently scheduled */
+    uint32_t capacity;          /* Pool size */
+} timer_wheel_stats_t;
+
+/**
+ * @brief Allocate the timer pool and reset the wheel
+ * @param max_timers Pool size (0 = TIMER_WHEEL_DEFAULT_TIMERS, max 65535)
+ * @return 0 on success (or already initialized), -1 on failure
+ *
+ * The wheel is shared: every successful call adds a user, and each user
+ * calls timer_wheel_cleanup() once when it is done with the wheel.
+ */
+int timer_wheel_init(size_t max_timers);
+
+/**
+ * @brief Drop one user of the wheel
+ *
+ * The last user stops the wheel thread and frees the timer pool, dropping
+ * any timers still scheduled; earlier calls leave the wheel running.
+ */
+void timer_wheel_cleanup(void);
+
+/**
+ * @brief Start the wheel thread (timerfd + epoll)
+ * @return 0 on success (or already running), -1 on failure or if
+ *         unsupported on this platform
+ */
+int timer_wheel_start(void);
+
+/**
+ * @brief Stop the wheel thread
+ *
+ * Scheduled timers are kept and fire late if the thread is restarted.
+ */
+void timer_wheel_stop(void);
+
+/**
+ * @brief Check if the wheel thread is running
+ * @return 1 if running, 0 otherwise
+ */
+int timer_wheel_is_running(void);
+
+/**
+ * @brief Schedule a timer
+ * @param delay_ms Time until the first expiration (0 = next tick)
+ * @param period_ms Repeat interval (0 = one-shot)
+ * @param callback Function to call on expiration
+ * @param context Passed back to the callback
+ * @return Timer ID, or TIMER_ID_INVALID if the pool is full
+ *
+ * Delays above TIMER_WHEEL_MAX_DELAY_MS are supported but cost one extra
+ * move per TIMER_WHEEL_MAX_DELAY_MS.
+ */
+timer_id_t timer_wheel_add(uint32_t delay_ms, uint32_t period_ms,
+                           timer_wheel_callback_t callback, void* context);
+
+/**
+ * @brief Cancel a timer
+ * @param id Timer ID from timer_wheel_add()
+ * @return 0 on success, -1 if the timer already expired or was cancelled
+ *
+ * Cancelling a timer whose callback is running on the wheel thread stops
+ * it from being rescheduled, but does not wait for the callback.
+ */
+int timer_wheel_cancel(timer_id_t id);
+
+/**
+ * @brief Get the wheel's current time
+ * @return Milliseconds since timer_wheel_init() (CLOCK_MONOTONIC)
+ */
+uint64_t timer_wheel_now_ms(void);
+
+/**
+ * @brief Run every timer due up to a point in time
+ * @param now_ms Wheel time to advance to (see timer_wheel_now_ms())
+ * @return Number of callbacks run
+ *
+ * Used by the wheel thread; call it directly to drive the wheel from
+ * another loop when the thread is not running.
+ */
+size_t timer_wheel_advance(uint64_t now_ms);
+
+/**
+ * @brief Get the time until the next timer may be due
+ * @return Milliseconds (0 if due now), or -1 if no timer is scheduled
+ */
+int64_t timer_wheel_next_delay_ms(void);
+
+/**
+ * @brief Get wheel statistics
+ * @param stats Output statistics
+ */
+void timer_wheel_get_stats(timer_wheel_stats_t* stats);
+
+#endif /* TIMER_WHEEL_H */
@@ -0,0 +1,123 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @file trace.h
+ * @brief Span tracing with Chrome Trace Event / Perfetto export
+ *
+ * Records nested begin/end spans for the stages of a button press
+ * (remote_press_button -> interrupt_callback -> interrupt_bottom_half ->
+ * tv_simulator_send_button -> connection_send_with_retry -> ir_send ->
+ * encoder) into a buffer allocated once by trace_init(). Recording claims
+ * a slot with a single atomic add and never blocks or allocates, so spans
+ * can be emitted from any thread. trace_write_json() writes the buffer as a Chrome Trace Event
+ * file that opens in chrome://tracing or ui.perfetto.dev.
+ *
+ * Timestamps come from latency_get_timestamp_ns(), so spans line up with
+ * latency samples and follow the virtual clock when it is active.
+ */
+
+/* Default buffer size (events) */
+#define TRACE_DEFAULT_EVENTS    65536
+
+/* Event Phases (Chrome Trace Event "ph" field) */
+typedef enum {
+    TRACE_PHASE_BEGIN = 'B',    /* Span start */
+    TRACE_PHASE_END = 'E',      /* Span end (closes the innermost open span) */
+    TRACE_PHASE_INSTANT = 'i'   /* Point event */
+} trace_phase_t;
+
+/* Trace Event */
+typedef struct {
+    const char* name;           /* Span name (must outlive the trace) */
+    uint64_t timestamp_ns;      /* Event time in nanoseconds */
+    uint32_t arg;               /* Associated code/ID */
+    uint16_t tid;               /* Recording thread (1-based) */
+    char phase;                 /* trace_phase_t */
+} trace_event_t;
+
+/**
+ * @brief Allocate the trace buffer
+ * @param max_events Buffer size in events (0 = TRACE_DEFAULT_EVENTS)
+ * @return 0 on success, -1 on failure
+ *
+ * Tracing starts disabled; call trace_enable(1) to record.
+ */
+int trace_init(size_t max_events);
+
+/**
+ * @brief Free the trace buffer and disable tracing
+ *
+ * Waits for events being written on other threads. Do not call it
+ * concurrently with trace_init(), trace_reset() or trace_write_json().
+ */
+void trace_cleanup(void);
+
+/**
+ * @brief Enable or disable recording
+ * @param enabled Non-zero to record events
+ */
+void trace_enable(int enabled);
+
+/**
+ * @brief Check if recording is enabled
+ * @return 1 if enabled, 0 otherwise
+ */
+int trace_is_enabled(void);
+
+/**
+ * @brief Open a span on the calling thread
+ * @param name Span name (string literal or other static string)
+ * @param arg Associated code/ID (written as args.code)
+ */
+void trace_begin(const char* name, uint32_t arg);
+
+/**
+ * @brief Close the innermost open span on the calling thread
+ * @param name Span name (must match the trace_begin call)
+ */
+void trace_end(const char* name);
+
+/**
+ * @brief Record a point event on the calling thread
+ * @param name Event name (string literal or other static string)
+ * @param arg Associated code/ID
+ */
+void trace_instant(const char* name, uint32_t arg);
+
+/**
+ * @brief Get the number of events recorded
+ * @return Events in the buffer
+ */
+size_t trace_event_count(void);
+
+/**
+ * @brief Get the number of events dropped because the buffer was full
+ * @return Dropped events
+ */
+uint64_t trace_dropped_count(void);
+
+/**
+ * @brief Discard all recorded events
+ *
+ * Recording pauses while the buffer is cleared: events in progress are
+ * waited for and events started meanwhile are not recorded. Do not call
+ * it concurrently with trace_enable(), trace_cleanup() or
+ * trace_write_json().
+ */
+void trace_reset(void);
+
+/**
+ * @brief Write the recorded events as Chrome Trace Event JSON
+ * @param path Output file path
+ * @return 0 on success, -1 on failure
+ *
+ * Timestamps are written in microseconds with nanosecond precision,
+ * relative to the first recorded event.
+ */
+int trace_write_json(const char* path);
+
+#endif /* TRACE_H */
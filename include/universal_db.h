@@ -0,0 +1,212 @@
+#ifndef UNIVERSAL_DB_H
+#define UNIVERSAL_DB_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "universal_tv.h"
+
+/**
+ * @file universal_db.h
+ * @brief Indexed, deduplicated universal TV code database
+ *
+ * The source code list (one row per button, brand and code) is compiled
+ * once into a single block:
+ * - frames: one record per distinct wire frame, so a code listed for
+ *   several brands is transmitted once per sweep
+ * - entries: per-button sweep lists, each pointing at a frame and
+ *   carrying the mask of brands that list it for that button
+ * - buttons / brands: ranges indexed directly by button code and brand
+ * - slots: hash of (button, brand, protocol) -> first matching entry
+ *
+ * All references inside the block are indices or byte offsets, never
+ * pointers, so the same block is the codebook file format: `make codebook`
+ * compiles data/universal_codes.csv into bin/universal_codes.bin, and
+ * universal_db_init() maps that file read-only with mmap() instead of
+ * compiling the built-in list. Loading does not parse or copy the tables,
+ * so startup cost does not depend on the number of codes, and processes
+ * using the same codebook share its pages. Files use host byte order.
+ * The built-in list is generated from the same CSV file at build time.
+ *
+ * After universal_db_init() the database is read-only and safe to read
+ * from any thread.
+ */
+
+#define UNIVERSAL_DB_MAGIC          0x42445655u    /* "UVDB" */
+#define UNIVERSAL_DB_VERSION        1
+#define UNIVERSAL_DB_BUTTONS        256
+#define UNIVERSAL_DB_MAX_BRANDS     16             /* Bits in a brand mask */
+
+/* Codebook file (path overridden by the UNIVERSAL_CODEBOOK environment variable) */
+#define UNIVERSAL_DB_DEFAULT_PATH   "bin/universal_codes.bin"
+#define UNIVERSAL_DB_PATH_ENV       "UNIVERSAL_CODEBOOK"
+
+/* Brand mask bit for a tv_brand_t */
+#define UNIVERSAL_BRAND_BIT(brand)  ((uint16_t)(1u << (brand)))
+
+/* Source Row (one button/brand/code listing, duplicates allowed) */
+typedef struct {
+    unsigned char button_code;  /* Button code from remote_buttons.h */
+    universal_tv_code_t code;
+} universal_db_source_t;
+
+/* Distinct Wire Frame */
+typedef struct {
+    uint32_t code;              /* IR code value */
+    uint8_t protocol;           /* IR_PROTOCOL_* */
+    uint8_t bit_length;         /* Number of bits */
+    uint16_t brand_mask;        /* Brands listing this frame for any button */
+} universal_frame_t;
+
+/* Sweep Entry (one distinct frame for one button) */
+typedef struct {
+    uint32_t frame;             /* Index into the frame table */
+    uint32_t description;       /* Byte offset into the string table */
+    uint16_t brand_mask;        /* Brands listing this frame for this button */
+    uint8_t brand;              /* Brand of the first listing */
+    uint8_t button_code;        /* Button code from remote_buttons.h */
+} universal_db_entry_t;
+
+/* Index Range */
+typedef struct {
+    uint32_t first;
+    uint32_t count;
+} universal_db_range_t;
+
+/* Lookup Slot ((button, brand, protocol) key + 1, 0 = empty) */
+typedef struct {
+    uint32_t key;
+    uint32_t entry;
+} universal_db_slot_t;
+
+/* Database Header (offsets are from the start of the header) */
+typedef struct {
+    uint32_t magic;                                     /* UNIVERSAL_DB_MAGIC */
+    uint16_t version;                                   /* UNIVERSAL_DB_VERSION */
+    uint16_t brand_count;                               /* Brand ranges in use */
+    uint32_t source_count;                              /* Source rows compiled */
+    uint32_t frame_count;
+    uint32_t entry_count;
+    uint32_t brand_entry_count;
+    uint32_t slot_count;                                /* Power of two */
+    uint32_t string_size;
+    uint32_t frames_offset;                             /* universal_frame_t[frame_count] */
+    uint32_t entries_offset;                            /* universal_db_entry_t[entry_count] */
+    uint32_t brand_entries_offset;                      /* uint32_t[brand_entry_count] */
+    uint32_t slots_offset;                              /* universal_db_slot_t[slot_count] */
+    uint32_t strings_offset;                            /* char[string_size] */
+    uint32_t total_size;                                /* Header + all tables */
+    universal_db_range_t buttons[UNIVERSAL_DB_BUTTONS]; /* Button code -> entries */
+    universal_db_range_t brands[UNIVERSAL_DB_MAX_BRANDS]; /* Brand -> brand_entries */
+} universal_db_header_t;
+
+/* Database Statistics */
+typedef struct {
+    uint32_t source_codes;      /* Rows in the source list */
+    uint32_t frames;            /* Distinct wire frames */
+    uint32_t entries;           /* Frames across all button sweeps */
+    uint32_t buttons;           /* Buttons with at least one code */
+    uint32_t size_bytes;        /* Size of the compiled database */
+    uint8_t mapped;             /* 1 if loaded from a codebook file */
+} universal_db_stats_t;
+
+/**
+ * @brief Load the codebook file, or compile the built-in code list
+ * @return 0 on success (or already loaded), -1 on failure
+ *
+ * Maps $UNIVERSAL_CODEBOOK or UNIVERSAL_DB_DEFAULT_PATH if it is a valid
+ * codebook, otherwise compiles the built-in list.
+ */
+int universal_db_init(void);
+
+/**
+ * @brief Map a codebook file as the database
+ * @param path Codebook file written by universal_db_save()
+ * @return 0 on success, -1 if a database is already loaded or the file is
+ *         missing or invalid
+ *
+ * Only the header is checked; the tables are used in place.
+ */
+int universal_db_open(const char* path);
+
+/**
+ * @brief Compile a code list and write it as a codebook file
+ * @param path Output file (replaced atomically)
+ * @param source Source rows
+ * @param count Number of rows
+ * @return 0 on success, -1 on failure
+ */
+int universal_db_save(const char* path, const universal_db_source_t* source, size_t count);
+
+/**
+ * @brief Parse one code list row
+ * @param line Row `button,brand,protocol,bits,code,description` (modified)
+ * @param row Output row; its description points into line
+ * @return NULL on success, or a message describing the error
+ *
+ * Buttons are button_table.h names or numeric codes, brands are names as
+ * returned by universal_tv_brand_name(), and protocols are NEC, RC5, RC6,
+ * SONY (or SIRC), PHILLIPS or an IR_PROTOCOL_* value. Sony codes must be
+ * 12, 15 or 20 bits, the lengths the encoder sends.
+ */
+const char* universal_db_parse_row(char* line, universal_db_source_t* row);
+
+/**
+ * @brief Free the database
+ */
+void universal_db_cleanup(void);
+
+/**
+ * @brief Get the sweep list for a button
+ * @param button_code Button code
+ * @param count Output: number of entries (0 if the button has no codes)
+ * @return First entry, or NULL if the button has no codes
+ *
+ * Each entry is a distinct wire frame, in source order.
+ */
+const universal_db_entry_t* universal_db_button_codes(unsigned char button_code, uint32_t* count);
+
+/**
+ * @brief Find the first entry for a button, brand and protocol
+ * @param button_code Button code
+ * @param brand TV brand
+ * @param protocol IR_PROTOCOL_* (0 = any protocol)
+ * @return Entry, or NULL if none matches
+ */
+const universal_db_entry_t* universal_db_find(unsigned char button_code, tv_brand_t brand, uint8_t protocol);
+
+/**
+ * @brief Get every entry listed for a brand
+ * @param brand TV brand
+ * @param count Output: number of entry indices
+ * @return Entry indices (see universal_db_entry()), grouped by button
+ */
+const uint32_t* universal_db_brand_codes(tv_brand_t brand, uint32_t* count);
+
+/**
+ * @brief Get an entry by index
+ * @param index Entry index
+ * @return Entry, or NULL if out of range
+ */
+const universal_db_entry_t* universal_db_entry(uint32_t index);
+
+/**
+ * @brief Get the wire frame of an entry
+ * @param entry Database entry
+ * @return Frame (never NULL for a valid entry)
+ */
+const universal_frame_t* universal_db_frame(const universal_db_entry_t* entry);
+
+/**
+ * @brief Get the description of an entry
+ * @param entry Database entry
+ * @return Description of the first listing of the frame
+ */
+const char* universal_db_description(const universal_db_entry_t* entry);
+
+/**
+ * @brief Get database statistics
+ * @param stats Output statistics
+ */
+void universal_db_get_stats(universal_db_stats_t* stats);
+
+#endif /* UNIVERSAL_DB_H */
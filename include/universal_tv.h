@@ -4,6 +4,13 @@
 #include <stdint.h>
 #include "ir_codes.h"
 
+/* Marks API kept for source compatibility */
+#if defined(__GNUC__) || defined(__clang__)
+#define UNIVERSAL_TV_DEPRECATED __attribute__((deprecated))
+#else
+#define UNIVERSAL_TV_DEPRECATED
+#endif
+
 /**
  * @file universal_tv.h
  * @brief Universal TV support - Multi-protocol IR codes for any TV brand
@@ -37,7 +44,7 @@ typedef enum {
     TV_BRAND_COUNT
 } tv_brand_t;
 
-/* Universal TV Code Entry */
+/* Universal TV Code Entry (one source listing, see universal_db.h) */
 typedef struct {
     uint32_t code;          /* IR code value */
     uint8_t protocol;       /* Protocol type (IR_PROTOCOL_*) */
@@ -46,12 +53,33 @@ typedef struct {
     const char* description; /* Human-readable description */
 } universal_tv_code_t;
 
-/* Universal TV Code Set (for one button across multiple brands/protocols) */
+/* Universal TV Code Set (for one button across multiple brands/protocols)
+ * Deprecated: no function takes or returns it any more; per-button code
+ * lists come from universal_db_button_codes() (see universal_db.h) */
 typedef struct {
     unsigned char button_code;      /* Button code from remote_buttons.h */
     universal_tv_code_t* codes;     /* Array of codes to try */
     uint16_t code_count;            /* Number of codes in array */
-} universal_button_codes_t;
+} universal_button_codes_t UNIVERSAL_TV_DEPRECATED;
+
+/* Per-Frame Hit Statistics (ordering of sweeps and scans) */
+typedef struct {
+    uint32_t attempts;      /* Times transmitted */
+    uint32_t successes;     /* Feedback reports credited to this frame */
+    uint32_t confirmations; /* Scan confirmations */
+    uint32_t score;         /* Estimated probability of working (16.16 fixed point) */
+} universal_code_stats_t;
+
+/* Scan Session (opaque, see universal_scan_create()) */
+typedef struct universal_scan universal_scan_t;
+
+/**
+ * @brief Frame transmitter for a scan session
+ * @param code Frame to send (description valid until the database is freed)
+ * @param context Context given to universal_scan_create()
+ * @return 0 on success, -1 on failure
+ */
+typedef int (*universal_scan_send_t)(const universal_tv_code_t* code, void* context);
 
 /**
  * @brief Initialize universal TV system
@@ -66,7 +94,10 @@ int universal_tv_init(universal_mode_t mode);
  * @return 0 on success, -1 on failure
  * 
  * This function tries multiple protocols and codes for maximum compatibility.
- * Strategy: Send NEC, RC5, RC6, Sony, Samsung, LG codes in sequence.
+ * Strategy: Send NEC, RC5, RC6, Sony, Samsung, LG codes in sequence, each
+ * distinct wire frame once: codes for the current brand first, then in
+ * order of estimated probability of working (see
+ * universal_tv_report_success()), ties in database order.
  */
 int universal_tv_send_button(unsigned char button_code);
 
@@ -75,8 +106,9 @@ int universal_tv_send_button(unsigned char button_code);
  * @param button_code Button code to scan for
  * @return 0 on success, -1 on failure
  * 
- * Cycles through stored codes. User should press button repeatedly
- * until TV responds, then confirm to save that code.
+ * Cycles through stored codes (same order as universal_tv_send_button()).
+ * User should press button repeatedly until TV responds, then confirm to
+ * save that code.
  */
 int universal_tv_scan_start(unsigned char button_code);
 
@@ -97,6 +129,108 @@ int universal_tv_scan_confirm(void);
  */
 void universal_tv_scan_cancel(void);
 
+/**
+ * @brief Create a scan session
+ * @param button_code Button code to scan for
+ * @param send Frame transmitter (NULL = IR transmitter)
+ * @param context Passed to send
+ * @return Session, or NULL if the button has no codes or out of memory
+ *
+ * universal_tv_scan_start()/_next()/_confirm()/_cancel() drive one shared
+ * session with the IR transmitter. Sessions created here are independent:
+ * any number may run at once, each from its own thread, as long as a
+ * session is used by one thread at a time.
+ *
+ * A session with a custom transmitter (e.g. a simulated TV) only calls
+ * send: it prints nothing, raises no events and does not touch hit
+ * statistics, learned codes or brand detection. A session with the IR
+ * transmitter behaves like the universal_tv_scan_* functions.
+ *
+ * Sessions refer to the code database: destroy them before
+ * universal_tv_cleanup().
+ */
+universal_scan_t* universal_scan_create(unsigned char button_code, universal_scan_send_t send, void* context);
+
+/**
+ * @brief Send the next frame of a scan session (loops at the end)
+ * @param scan Session
+ * @return 0 on success, -1 on error (or if send failed)
+ */
+int universal_scan_next(universal_scan_t* scan);
+
+/**
+ * @brief Confirm the frame most recently sent by a scan session
+ * @param scan Session (stays valid; destroy it when done)
+ * @param confirmed Output: confirmed frame (may be NULL)
+ * @return 0 on success, -1 if nothing was sent yet
+ */
+int universal_scan_confirm(universal_scan_t* scan, universal_tv_code_t* confirmed);
+
+/**
+ * @brief Free a scan session
+ * @param scan Session (NULL is ignored)
+ */
+void universal_scan_destroy(universal_scan_t* scan);
+
+/**
+ * @brief Report that the TV reacted to a button (external feedback)
+ * @param button_code Button the TV reacted to
+ * @return 0 if credited, -1 if no frame for this button was sent between
+ *         2 s and the reaction latency ago, or that frame was already
+ *         credited
+ *
+ * Credits the newest frame for this button sent at least the reaction
+ * latency before the call (see universal_tv_set_reaction_latency()), so a
+ * camera or status probe that notices the reaction late still credits the
+ * frame that caused it, and sweeps of other buttons do not interfere. May
+ * be called from another thread while universal_tv_send_button() is
+ * sweeping.
+ */
+int universal_tv_report_success(unsigned char button_code);
+
+/**
+ * @brief Set the delay between a frame and the feedback it causes
+ * @param ms TV reaction plus feedback detection time (default 100 ms)
+ */
+void universal_tv_set_reaction_latency(uint32_t ms);
+
+/**
+ * @brief Stop sweeps as soon as success is reported
+ * @param enable 1 to stop early, 0 to always send every frame (default)
+ */
+void universal_tv_set_early_stop(int enable);
+
+/**
+ * @brief Get the hit statistics of one frame of a button's sweep list
+ * @param button_code Button code
+ * @param index Frame index in database order (< universal_tv_get_code_count())
+ * @param stats Output statistics
+ * @return 0 on success, -1 if out of range or not initialized
+ */
+int universal_tv_get_code_stats(unsigned char button_code, uint16_t index, universal_code_stats_t* stats);
+
+/**
+ * @brief Send the frame that best narrows down the TV brand
+ * @param button_code Button to probe with (e.g. BUTTON_POWER)
+ * @return 0 if a probe was sent (answer with universal_tv_detect_answer()),
+ *         1 if the brand is already detected, -1 if no frame for this
+ *         button tells the remaining brands apart
+ *
+ * Scan confirmations and universal_tv_report_success() also count as
+ * answers (see brand_detect.h). When a brand becomes likely enough, it is
+ * set as with universal_tv_set_brand() and EVENT_UNIVERSAL_BRAND_DETECTED
+ * is raised.
+ */
+int universal_tv_detect_next(unsigned char button_code);
+
+/**
+ * @brief Answer the last probe sent by universal_tv_detect_next()
+ * @param worked 1 if the TV reacted, 0 if it did not
+ * @return 1 if the brand was detected, 0 if more probes are needed,
+ *         -1 if no probe is pending
+ */
+int universal_tv_detect_answer(int worked);
+
 /**
  * @brief Set TV brand (optimizes code selection)
  * @param brand TV brand identifier
@@ -109,10 +243,17 @@ void universal_tv_set_brand(tv_brand_t brand);
  */
 tv_brand_t universal_tv_get_brand(void);
 
+/**
+ * @brief Get the display name of a TV brand
+ * @param brand TV brand identifier
+ * @return Brand name ("Unknown" for out-of-range values)
+ */
+const char* universal_tv_brand_name(tv_brand_t brand);
+
 /**
  * @brief Get universal code count for a button
  * @param button_code Button code
- * @return Number of universal codes available for this button
+ * @return Number of distinct frames available for this button
  */
 uint16_t universal_tv_get_code_count(unsigned char button_code);
 
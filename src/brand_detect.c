@@ -0,0 +1,272 @@
+/* pthread mutexes require POSIX.1-2001 */
+#if defined(__linux__) || defined(__unix__) || defined(__APPLE__)
+#undef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include "../include/brand_detect.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+/**
+ * @file brand_detect.c
+ * @brief Bayesian brand inference over the universal code database
+ */
+
+/* Detection State */
+static float brand_probability[TV_BRAND_COUNT];     /* TV_BRAND_UNKNOWN stays 0 */
+static uint8_t* asked = NULL;                        /* Bitmap of observed entry indices */
+static uint32_t asked_count = 0;                     /* Entries covered by the bitmap */
+static uint32_t observation_count = 0;
+static tv_brand_t detected = TV_BRAND_UNKNOWN;
+static int initialized = 0;
+
+#ifndef _WIN32
+static pthread_mutex_t detect_mutex = PTHREAD_MUTEX_INITIALIZER;
+#define DETECT_LOCK()   pthread_mutex_lock(&detect_mutex)
+#define DETECT_UNLOCK() pthread_mutex_unlock(&detect_mutex)
+#else
+#define DETECT_LOCK()   ((void)0)
+#define DETECT_UNLOCK() ((void)0)
+#endif
+
+/**
+ * @brief Reset to a uniform distribution over known brands (lock held)
+ */
+static void reset_locked(void) {
+    int brand;
+
+    brand_probability[TV_BRAND_UNKNOWN] = 0.0f;
+    for (brand = 1; brand < TV_BRAND_COUNT; brand++) {
+        brand_probability[brand] = 1.0f / (float)(TV_BRAND_COUNT - 1);
+    }
+
+    free(asked);
+    asked = NULL;
+    asked_count = 0;
+    observation_count = 0;
+    detected = TV_BRAND_UNKNOWN;
+    initialized = 1;
+}
+
+/**
+ * @brief P(answer | brand) for a frame listed by the brands in mask
+ */
+static float likelihood(uint16_t brand_mask, int brand, int worked) {
+    float hit = (brand_mask & UNIVERSAL_BRAND_BIT(brand)) ? BRAND_DETECT_HIT : BRAND_DETECT_FALSE_HIT;
+    return worked ? hit : 1.0f - hit;
+}
+
+/**
+ * @brief Update a distribution with one answer
+ * @return P(answer) under the prior
+ */
+static float update(const float* prior, uint16_t brand_mask, int worked, float* posterior) {
+    float total = 0.0f;
+    int brand;
+
+    for (brand = 0; brand < TV_BRAND_COUNT; brand++) {
+        posterior[brand] = prior[brand] * likelihood(brand_mask, brand, worked);
+        total += posterior[brand];
+    }
+    if (total > 0.0f) {
+        for (brand = 0; brand < TV_BRAND_COUNT; brand++) {
+            posterior[brand] /= total;
+        }
+    }
+    return total;
+}
+
+/**
+ * @brief Gini impurity: probability that two brand draws differ
+ */
+static float impurity(const float* probability) {
+    float sum = 0.0f;
+    int brand;
+
+    for (brand = 0; brand < TV_BRAND_COUNT; brand++) {
+        sum += probability[brand] * probability[brand];
+    }
+    return 1.0f - sum;
+}
+
+/**
+ * @brief Most probable brand (lock held)
+ */
+static tv_brand_t best_locked(float* probability) {
+    tv_brand_t best = TV_BRAND_UNKNOWN;
+    float best_probability = 0.0f;
+    int brand;
+
+    if (observation_count > 0) {
+        for (brand = 1; brand < TV_BRAND_COUNT; brand++) {
+            if (brand_probability[brand] > best_probability) {
+                best_probability = brand_probability[brand];
+                best = (tv_brand_t)brand;
+            }
+        }
+    }
+    if (probability) {
+        *probability = best_probability;
+    }
+    return best;
+}
+
+/**
+ * @brief Get the index of a database entry
+ */
+static int entry_index(const universal_db_entry_t* entry, uint32_t* index) {
+    const universal_db_entry_t* first = universal_db_entry(0);
+
+    if (!first || !entry || entry < first) {
+        return -1;
+    }
+    *index = (uint32_t)(entry - first);
+    return universal_db_entry(*index) == entry ? 0 : -1;
+}
+
+/**
+ * @brief Check if an entry has been observed (lock held)
+ */
+static int was_asked(uint32_t index) {
+    return asked && index < asked_count && (asked[index / 8] & (1u << (index % 8)));
+}
+
+/**
+ * @brief Mark an entry as observed (lock held)
+ */
+static void mark_asked(uint32_t index) {
+    if (!asked) {
+        universal_db_stats_t stats;
+        universal_db_get_stats(&stats);
+        asked = (uint8_t*)calloc((stats.entries + 7) / 8 + 1, 1);
+        asked_count = asked ? stats.entries : 0;
+    }
+    if (index < asked_count) {
+        asked[index / 8] |= (uint8_t)(1u << (index % 8));
+    }
+}
+
+void brand_detect_reset(void) {
+    DETECT_LOCK();
+    reset_locked();
+    DETECT_UNLOCK();
+}
+
+int brand_detect_observe(const universal_db_entry_t* entry, int worked) {
+    float posterior[TV_BRAND_COUNT];
+    float probability;
+    tv_brand_t best;
+    uint32_t index;
+    int result = 0;
+
+    if (entry_index(entry, &index) != 0) {
+        return -1;
+    }
+
+    DETECT_LOCK();
+    if (!initialized) {
+        reset_locked();
+    }
+
+    update(brand_probability, entry->brand_mask, worked ? 1 : 0, posterior);
+    memcpy(brand_probability, posterior, sizeof(brand_probability));
+    mark_asked(index);
+    observation_count++;
+
+    best = best_locked(&probability);
+    if (probability >= BRAND_DETECT_CONFIDENCE) {
+        if (detected != best) {
+            detected = best;
+            result = 1;
+        }
+    } else {
+        /* Allow a later answer to detect again */
+        detected = TV_BRAND_UNKNOWN;
+    }
+    DETECT_UNLOCK();
+
+    printf("[BrandDetect] Frame for button 0x%02X %s: %s %.0f%%\n", entry->button_code,
+           worked ? "worked" : "did nothing", universal_tv_brand_name(best), probability * 100.0f);
+    return result;
+}
+
+const universal_db_entry_t* brand_detect_next_probe(unsigned char button_code) {
+    const universal_db_entry_t* codes;
+    const universal_db_entry_t* best = NULL;
+    float yes[TV_BRAND_COUNT];
+    float no[TV_BRAND_COUNT];
+    float best_impurity;
+    uint32_t count = 0;
+    uint32_t first_index;
+    uint32_t i;
+
+    if (universal_db_init() != 0) {
+        return NULL;
+    }
+    codes = universal_db_button_codes(button_code, &count);
+    if (!codes || entry_index(codes, &first_index) != 0) {
+        return NULL;
+    }
+
+    DETECT_LOCK();
+    if (!initialized) {
+        reset_locked();
+    }
+
+    /* Greedy split: minimise the expected impurity after the answer */
+    best_impurity = impurity(brand_probability) - 1e-4f;
+    for (i = 0; i < count; i++) {
+        float p_yes, expected;
+
+        if ((codes[i].brand_mask & ~UNIVERSAL_BRAND_BIT(TV_BRAND_UNKNOWN)) == 0 ||
+            was_asked(first_index + i)) {
+            continue;
+        }
+
+        p_yes = update(brand_probability, codes[i].brand_mask, 1, yes);
+        update(brand_probability, codes[i].brand_mask, 0, no);
+        expected = p_yes * impurity(yes) + (1.0f - p_yes) * impurity(no);
+        if (expected < best_impurity) {
+            best_impurity = expected;
+            best = &codes[i];
+        }
+    }
+    DETECT_UNLOCK();
+
+    return best;
+}
+
+tv_brand_t brand_detect_best(float* probability) {
+    tv_brand_t best;
+
+    DETECT_LOCK();
+    best = best_locked(probability);
+    DETECT_UNLOCK();
+    return best;
+}
+
+tv_brand_t brand_detect_result(void) {
+    float probability;
+    tv_brand_t best = brand_detect_best(&probability);
+
+    return probability >= BRAND_DETECT_CONFIDENCE ? best : TV_BRAND_UNKNOWN;
+}
+
+void brand_detect_get_probabilities(float probabilities[TV_BRAND_COUNT]) {
+    DETECT_LOCK();
+    if (!initialized) {
+        reset_locked();
+    }
+    memcpy(probabilities, brand_probability, sizeof(brand_probability));
+    DETECT_UNLOCK();
+}
+
+uint32_t brand_detect_observations(void) {
+    return observation_count;
+}
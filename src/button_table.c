@@ -0,0 +1,172 @@
+#include "../include/button_table.h"
+#include "../include/remote_buttons.h"
+#include "../include/ir_codes.h"
+
+/**
+ * @file button_table.c
+ * @brief Button code lookup table
+ *
+ * Entries use designated initializers indexed by button code, so unused
+ * codes are zero (flags == 0). Keep one entry per line:
+ * test_simulator/gen_button_codes.py parses this file to generate
+ * button_codes.py.
+ */
+
+static const button_info_t button_table[256] = {
+    /* Streaming Service Buttons */
+    [BUTTON_YOUTUBE] = { "YouTube", IR_YOUTUBE, IR_PROTOCOL_PHILLIPS, BTN_STREAMING, BUTTON_FLAG_VALID },
+    [BUTTON_NETFLIX] = { "Netflix", IR_NETFLIX, IR_PROTOCOL_PHILLIPS, BTN_STREAMING, BUTTON_FLAG_VALID },
+    [BUTTON_AMAZON_PRIME] = { "Amazon Prime", IR_AMAZON_PRIME, IR_PROTOCOL_PHILLIPS, BTN_STREAMING, BUTTON_FLAG_VALID },
+    [BUTTON_HBO_MAX] = { "HBO Max", IR_HBO_MAX, IR_PROTOCOL_PHILLIPS, BTN_STREAMING, BUTTON_FLAG_VALID },
+
+    /* Basic Control Buttons */
+    [BUTTON_POWER] = { "Power", IR_POWER, IR_PROTOCOL_PHILLIPS, BTN_BASIC, BUTTON_FLAG_VALID },
+    [BUTTON_VOLUME_UP] = { "Volume Up", IR_VOLUME_UP, IR_PROTOCOL_PHILLIPS, BTN_BASIC, BUTTON_FLAG_VALID },
+    [BUTTON_VOLUME_DOWN] = { "Volume Down", IR_VOLUME_DOWN, IR_PROTOCOL_PHILLIPS, BTN_BASIC, BUTTON_FLAG_VALID },
+    [BUTTON_MUTE] = { "Mute", IR_MUTE, IR_PROTOCOL_PHILLIPS, BTN_BASIC, BUTTON_FLAG_VALID },
+    [BUTTON_CHANNEL_UP] = { "Channel Up", IR_CHANNEL_UP, IR_PROTOCOL_PHILLIPS, BTN_BASIC, BUTTON_FLAG_VALID },
+    [BUTTON_CHANNEL_DOWN] = { "Channel Down", IR_CHANNEL_DOWN, IR_PROTOCOL_PHILLIPS, BTN_BASIC, BUTTON_FLAG_VALID },
+
+    /* Navigation Buttons */
+    [BUTTON_HOME] = { "Home", IR_HOME, IR_PROTOCOL_PHILLIPS, BTN_NAVIGATION, BUTTON_FLAG_VALID },
+    [BUTTON_MENU] = { "Menu", IR_MENU, IR_PROTOCOL_PHILLIPS, BTN_NAVIGATION, BUTTON_FLAG_VALID },
+    [BUTTON_BACK] = { "Back", IR_BACK, IR_PROTOCOL_PHILLIPS, BTN_NAVIGATION, BUTTON_FLAG_VALID },
+    [BUTTON_EXIT] = { "Exit", IR_EXIT, IR_PROTOCOL_PHILLIPS, BTN_NAVIGATION, BUTTON_FLAG_VALID },
+    [BUTTON_OPTIONS] = { "Options", IR_OPTIONS, IR_PROTOCOL_PHILLIPS, BTN_NAVIGATION, BUTTON_FLAG_VALID },
+    [BUTTON_INPUT] = { "Input", IR_INPUT, IR_PROTOCOL_PHILLIPS, BTN_NAVIGATION, BUTTON_FLAG_VALID },
+    [BUTTON_SOURCE] = { "Source", IR_INPUT, IR_PROTOCOL_PHILLIPS, BTN_NAVIGATION, BUTTON_FLAG_VALID },
+
+    /* Directional Pad */
+    [BUTTON_UP] = { "Up", IR_UP, IR_PROTOCOL_PHILLIPS, BTN_DIRECTIONAL, BUTTON_FLAG_VALID },
+    [BUTTON_DOWN] = { "Down", IR_DOWN, IR_PROTOCOL_PHILLIPS, BTN_DIRECTIONAL, BUTTON_FLAG_VALID },
+    [BUTTON_LEFT] = { "Left", IR_LEFT, IR_PROTOCOL_PHILLIPS, BTN_DIRECTIONAL, BUTTON_FLAG_VALID },
+    [BUTTON_RIGHT] = { "Right", IR_RIGHT, IR_PROTOCOL_PHILLIPS, BTN_DIRECTIONAL, BUTTON_FLAG_VALID },
+    [BUTTON_OK] = { "OK", IR_OK, IR_PROTOCOL_PHILLIPS, BTN_DIRECTIONAL, BUTTON_FLAG_VALID },
+    [BUTTON_ENTER] = { "Enter", IR_ENTER, IR_PROTOCOL_PHILLIPS, BTN_DIRECTIONAL, BUTTON_FLAG_VALID },
+
+    /* Playback Controls */
+    [BUTTON_PLAY] = { "Play", IR_PLAY, IR_PROTOCOL_PHILLIPS, BTN_PLAYBACK, BUTTON_FLAG_VALID },
+    [BUTTON_PAUSE] = { "Pause", IR_PAUSE, IR_PROTOCOL_PHILLIPS, BTN_PLAYBACK, BUTTON_FLAG_VALID },
+    [BUTTON_STOP] = { "Stop", IR_STOP, IR_PROTOCOL_PHILLIPS, BTN_PLAYBACK, BUTTON_FLAG_VALID },
+    [BUTTON_FAST_FORWARD] = { "Fast Forward", IR_FAST_FORWARD, IR_PROTOCOL_PHILLIPS, BTN_PLAYBACK, BUTTON_FLAG_VALID },
+    [BUTTON_REWIND] = { "Rewind", IR_REWIND, IR_PROTOCOL_PHILLIPS, BTN_PLAYBACK, BUTTON_FLAG_VALID },
+    [BUTTON_RECORD] = { "Record", IR_RECORD, IR_PROTOCOL_PHILLIPS, BTN_PLAYBACK, BUTTON_FLAG_VALID },
+
+    /* Number Pad */
+    [BUTTON_0] = { "0", IR_0, IR_PROTOCOL_PHILLIPS, BTN_NUMBER, BUTTON_FLAG_VALID },
+    [BUTTON_1] = { "1", IR_1, IR_PROTOCOL_PHILLIPS, BTN_NUMBER, BUTTON_FLAG_VALID },
+    [BUTTON_2] = { "2", IR_2, IR_PROTOCOL_PHILLIPS, BTN_NUMBER, BUTTON_FLAG_VALID },
+    [BUTTON_3] = { "3", IR_3, IR_PROTOCOL_PHILLIPS, BTN_NUMBER, BUTTON_FLAG_VALID },
+    [BUTTON_4] = { "4", IR_4, IR_PROTOCOL_PHILLIPS, BTN_NUMBER, BUTTON_FLAG_VALID },
+    [BUTTON_5] = { "5", IR_5, IR_PROTOCOL_PHILLIPS, BTN_NUMBER, BUTTON_FLAG_VALID },
+    [BUTTON_6] = { "6", IR_6, IR_PROTOCOL_PHILLIPS, BTN_NUMBER, BUTTON_FLAG_VALID },
+    [BUTTON_7] = { "7", IR_7, IR_PROTOCOL_PHILLIPS, BTN_NUMBER, BUTTON_FLAG_VALID },
+    [BUTTON_8] = { "8", IR_8, IR_PROTOCOL_PHILLIPS, BTN_NUMBER, BUTTON_FLAG_VALID },
+    [BUTTON_9] = { "9", IR_9, IR_PROTOCOL_PHILLIPS, BTN_NUMBER, BUTTON_FLAG_VALID },
+    [BUTTON_DASH] = { "Dash (-)", IR_DASH, IR_PROTOCOL_PHILLIPS, BTN_NUMBER, BUTTON_FLAG_VALID },
+
+    /* Color Buttons */
+    [BUTTON_RED] = { "Red", IR_RED, IR_PROTOCOL_PHILLIPS, BTN_COLOR, BUTTON_FLAG_VALID },
+    [BUTTON_GREEN] = { "Green", IR_GREEN, IR_PROTOCOL_PHILLIPS, BTN_COLOR, BUTTON_FLAG_VALID },
+    [BUTTON_YELLOW] = { "Yellow", IR_YELLOW, IR_PROTOCOL_PHILLIPS, BTN_COLOR, BUTTON_FLAG_VALID },
+    [BUTTON_BLUE] = { "Blue", IR_BLUE, IR_PROTOCOL_PHILLIPS, BTN_COLOR, BUTTON_FLAG_VALID },
+
+    /* Advanced TV Controls */
+    [BUTTON_INFO] = { "Info", IR_INFO, IR_PROTOCOL_PHILLIPS, BTN_ADVANCED, BUTTON_FLAG_VALID },
+    [BUTTON_GUIDE] = { "Guide", IR_GUIDE, IR_PROTOCOL_PHILLIPS, BTN_ADVANCED, BUTTON_FLAG_VALID },
+    [BUTTON_SETTINGS] = { "Settings", IR_SETTINGS, IR_PROTOCOL_PHILLIPS, BTN_ADVANCED, BUTTON_FLAG_VALID },
+    [BUTTON_CC] = { "Closed Captions", IR_CC, IR_PROTOCOL_PHILLIPS, BTN_ADVANCED, BUTTON_FLAG_VALID },
+    [BUTTON_SUBTITLES] = { "Subtitles", IR_CC, IR_PROTOCOL_PHILLIPS, BTN_ADVANCED, BUTTON_FLAG_VALID },
+    [BUTTON_SAP] = { "SAP", IR_SAP, IR_PROTOCOL_PHILLIPS, BTN_ADVANCED, BUTTON_FLAG_VALID },
+    [BUTTON_AUDIO] = { "Audio", IR_SAP, IR_PROTOCOL_PHILLIPS, BTN_ADVANCED, BUTTON_FLAG_VALID },
+    [BUTTON_SLEEP] = { "Sleep", IR_SLEEP, IR_PROTOCOL_PHILLIPS, BTN_ADVANCED, BUTTON_FLAG_VALID },
+    [BUTTON_PICTURE_MODE] = { "Picture Mode", IR_PICTURE_MODE, IR_PROTOCOL_PHILLIPS, BTN_ADVANCED, BUTTON_FLAG_VALID },
+    [BUTTON_ASPECT] = { "Aspect", IR_ASPECT, IR_PROTOCOL_PHILLIPS, BTN_ADVANCED, BUTTON_FLAG_VALID },
+    [BUTTON_ZOOM] = { "Zoom", IR_ASPECT, IR_PROTOCOL_PHILLIPS, BTN_ADVANCED, BUTTON_FLAG_VALID },
+    [BUTTON_P_SIZE] = { "Picture Size", IR_ASPECT, IR_PROTOCOL_PHILLIPS, BTN_ADVANCED, BUTTON_FLAG_VALID },
+
+    /* Smart TV Features */
+    [BUTTON_VOICE] = { "Voice", IR_VOICE, IR_PROTOCOL_PHILLIPS, BTN_SMART, BUTTON_FLAG_VALID },
+    [BUTTON_MIC] = { "Microphone", IR_VOICE, IR_PROTOCOL_PHILLIPS, BTN_SMART, BUTTON_FLAG_VALID },
+    [BUTTON_LIVE_TV] = { "Live TV", IR_LIVE_TV, IR_PROTOCOL_PHILLIPS, BTN_SMART, BUTTON_FLAG_VALID },
+    [BUTTON_STREAM] = { "Stream", IR_STREAM, IR_PROTOCOL_PHILLIPS, BTN_SMART, BUTTON_FLAG_VALID },
+
+    /* System & Diagnostic */
+    [BUTTON_DISPLAY] = { "Display", IR_DISPLAY, IR_PROTOCOL_PHILLIPS, BTN_SYSTEM, BUTTON_FLAG_VALID },
+    [BUTTON_STATUS] = { "Status", IR_DISPLAY, IR_PROTOCOL_PHILLIPS, BTN_SYSTEM, BUTTON_FLAG_VALID },
+    [BUTTON_HELP] = { "Help", IR_HELP, IR_PROTOCOL_PHILLIPS, BTN_SYSTEM, BUTTON_FLAG_VALID },
+    [BUTTON_E_MANUAL] = { "E-Manual", IR_HELP, IR_PROTOCOL_PHILLIPS, BTN_SYSTEM, BUTTON_FLAG_VALID },
+
+    /* Gaming Controls */
+    [BUTTON_GAME_MODE] = { "Game Mode", IR_GAME_MODE, IR_PROTOCOL_PHILLIPS, BTN_GAMING, BUTTON_FLAG_VALID },
+
+    /* Picture Controls */
+    [BUTTON_MOTION] = { "Motion", IR_MOTION, IR_PROTOCOL_PHILLIPS, BTN_PICTURE, BUTTON_FLAG_VALID },
+    [BUTTON_BACKLIGHT] = { "Backlight", IR_BRIGHTNESS, IR_PROTOCOL_PHILLIPS, BTN_PICTURE, BUTTON_FLAG_VALID },
+    [BUTTON_BRIGHTNESS] = { "Brightness", IR_BRIGHTNESS, IR_PROTOCOL_PHILLIPS, BTN_PICTURE, BUTTON_FLAG_VALID },
+
+    /* Audio Controls */
+    [BUTTON_SOUND_MODE] = { "Sound Mode", IR_SOUND_MODE, IR_PROTOCOL_PHILLIPS, BTN_AUDIO, BUTTON_FLAG_VALID },
+    [BUTTON_SYNC] = { "Sync", IR_SYNC, IR_PROTOCOL_PHILLIPS, BTN_AUDIO, BUTTON_FLAG_VALID },
+    [BUTTON_SOUND_OUTPUT] = { "Sound Output", IR_SOUND_OUTPUT, IR_PROTOCOL_PHILLIPS, BTN_AUDIO, BUTTON_FLAG_VALID },
+
+    /* Input & Connectivity */
+    [BUTTON_MULTI_VIEW] = { "Multi View", IR_MULTI_VIEW, IR_PROTOCOL_PHILLIPS, BTN_CONNECTIVITY, BUTTON_FLAG_VALID },
+    [BUTTON_PIP] = { "Picture in Picture", IR_PIP, IR_PROTOCOL_PHILLIPS, BTN_CONNECTIVITY, BUTTON_FLAG_VALID },
+    [BUTTON_SCREEN_MIRROR] = { "Screen Mirror", IR_SCREEN_MIRROR, IR_PROTOCOL_PHILLIPS, BTN_CONNECTIVITY, BUTTON_FLAG_VALID },
+
+    /* Room / Smart Home Automation (remote controls TV + room devices) */
+    [BUTTON_ROOM_SCENE_MOVIE] = { "Room: Movie", 0x00000000, 0, BTN_ROOM, BUTTON_FLAG_VALID | BUTTON_FLAG_NO_IR },
+    [BUTTON_ROOM_SCENE_RELAX] = { "Room: Relax", 0x00000000, 0, BTN_ROOM, BUTTON_FLAG_VALID | BUTTON_FLAG_NO_IR },
+    [BUTTON_ROOM_SCENE_OFF] = { "Room: Off", 0x00000000, 0, BTN_ROOM, BUTTON_FLAG_VALID | BUTTON_FLAG_NO_IR },
+    [BUTTON_ROOM_LIGHTS_DIM] = { "Room: Lights Dim", 0x00000000, 0, BTN_ROOM, BUTTON_FLAG_VALID | BUTTON_FLAG_NO_IR },
+    [BUTTON_ROOM_LIGHTS_FULL] = { "Room: Lights Full", 0x00000000, 0, BTN_ROOM, BUTTON_FLAG_VALID | BUTTON_FLAG_NO_IR },
+    [BUTTON_ROOM_SMART_PLUG1] = { "Room: Plug 1", 0x00000000, 0, BTN_ROOM, BUTTON_FLAG_VALID | BUTTON_FLAG_NO_IR },
+    [BUTTON_ROOM_SMART_SPEAKER] = { "Room: Speaker", 0x00000000, 0, BTN_ROOM, BUTTON_FLAG_VALID | BUTTON_FLAG_NO_IR },
+    [BUTTON_ROOM_AMBIENT_STRIP] = { "Room: Ambient", 0x00000000, 0, BTN_ROOM, BUTTON_FLAG_VALID | BUTTON_FLAG_NO_IR },
+    [BUTTON_ROOM_SMART_PLUG2] = { "Room: Plug 2", 0x00000000, 0, BTN_ROOM, BUTTON_FLAG_VALID | BUTTON_FLAG_NO_IR },
+    [BUTTON_ROOM_SMART_PLUG3] = { "Room: Plug 3", 0x00000000, 0, BTN_ROOM, BUTTON_FLAG_VALID | BUTTON_FLAG_NO_IR },
+    [BUTTON_ROOM_KITCHEN_LIGHT] = { "Room: Kitchen Light", 0x00000000, 0, BTN_ROOM, BUTTON_FLAG_VALID | BUTTON_FLAG_NO_IR },
+    [BUTTON_ROOM_FRIDGE] = { "Room: Fridge", 0x00000000, 0, BTN_ROOM, BUTTON_FLAG_VALID | BUTTON_FLAG_NO_IR },
+    [BUTTON_ROOM_OVEN] = { "Room: Oven", 0x00000000, 0, BTN_ROOM, BUTTON_FLAG_VALID | BUTTON_FLAG_NO_IR },
+    [BUTTON_ROOM_BEDROOM_LAMP] = { "Room: Bedroom Lamp", 0x00000000, 0, BTN_ROOM, BUTTON_FLAG_VALID | BUTTON_FLAG_NO_IR },
+    [BUTTON_ROOM_BATHROOM_LIGHT] = { "Room: Bathroom Light", 0x00000000, 0, BTN_ROOM, BUTTON_FLAG_VALID | BUTTON_FLAG_NO_IR },
+    [BUTTON_ROOM_UPSTAIRS_HALL] = { "Room: Upstairs Hall", 0x00000000, 0, BTN_ROOM, BUTTON_FLAG_VALID | BUTTON_FLAG_NO_IR },
+    [BUTTON_ROOM_ENTRY_LIGHT] = { "Room: Entry Light", 0x00000000, 0, BTN_ROOM, BUTTON_FLAG_VALID | BUTTON_FLAG_NO_IR },
+    [BUTTON_ROOM_UPSTAIRS_BEDROOM] = { "Room: Upstairs Bedroom", 0x00000000, 0, BTN_ROOM, BUTTON_FLAG_VALID | BUTTON_FLAG_NO_IR },
+    [BUTTON_ROOM_UPSTAIRS_BATHROOM] = { "Room: Upstairs Bathroom", 0x00000000, 0, BTN_ROOM, BUTTON_FLAG_VALID | BUTTON_FLAG_NO_IR },
+    [BUTTON_ROOM_HOOD_LIGHT] = { "Room: Hood Light", 0x00000000, 0, BTN_ROOM, BUTTON_FLAG_VALID | BUTTON_FLAG_NO_IR },
+    [BUTTON_ROOM_THERMOSTAT_UP] = { "Room: Thermostat Up", 0x00000000, 0, BTN_ROOM, BUTTON_FLAG_VALID | BUTTON_FLAG_NO_IR },
+    [BUTTON_ROOM_THERMOSTAT_DOWN] = { "Room: Thermostat Down", 0x00000000, 0, BTN_ROOM, BUTTON_FLAG_VALID | BUTTON_FLAG_NO_IR },
+    [BUTTON_ROOM_AC_ON] = { "Room: AC On", 0x00000000, 0, BTN_ROOM, BUTTON_FLAG_VALID | BUTTON_FLAG_NO_IR },
+    [BUTTON_ROOM_HEATING_ON] = { "Room: Heating On", 0x00000000, 0, BTN_ROOM, BUTTON_FLAG_VALID | BUTTON_FLAG_NO_IR },
+    [BUTTON_ROOM_GARAGE_DOOR] = { "Room: Garage Door", 0x00000000, 0, BTN_ROOM, BUTTON_FLAG_VALID | BUTTON_FLAG_NO_IR },
+    [BUTTON_ROOM_DOOR_LOCK] = { "Room: Door Lock", 0x00000000, 0, BTN_ROOM, BUTTON_FLAG_VALID | BUTTON_FLAG_NO_IR },
+    [BUTTON_ROOM_SECURITY_ARM] = { "Room: Security Arm", 0x00000000, 0, BTN_ROOM, BUTTON_FLAG_VALID | BUTTON_FLAG_NO_IR },
+    [BUTTON_ROOM_BLINDS_OPEN] = { "Room: Blinds Open", 0x00000000, 0, BTN_ROOM, BUTTON_FLAG_VALID | BUTTON_FLAG_NO_IR },
+    [BUTTON_ROOM_BLINDS_CLOSE] = { "Room: Blinds Close", 0x00000000, 0, BTN_ROOM, BUTTON_FLAG_VALID | BUTTON_FLAG_NO_IR },
+    [BUTTON_ROOM_CEILING_FAN] = { "Room: Ceiling Fan", 0x00000000, 0, BTN_ROOM, BUTTON_FLAG_VALID | BUTTON_FLAG_NO_IR },
+    [BUTTON_ROOM_LIVING_ROOM_LIGHT] = { "Room: Living Room Light", 0x00000000, 0, BTN_ROOM, BUTTON_FLAG_VALID | BUTTON_FLAG_NO_IR },
+    [BUTTON_ROOM_DINING_ROOM_LIGHT] = { "Room: Dining Room Light", 0x00000000, 0, BTN_ROOM, BUTTON_FLAG_VALID | BUTTON_FLAG_NO_IR },
+};
+
+/**
+ * @brief Look up a button table entry
+ */
+const button_info_t* button_table_lookup(unsigned char button_code) {
+    return &button_table[button_code];
+}
+
+/**
+ * @brief Check if a button code is defined
+ */
+int button_is_valid(unsigned char button_code) {
+    return (button_table[button_code].flags & BUTTON_FLAG_VALID) != 0;
+}
+
+/**
+ * @brief Check if a button has an IR code
+ */
+int button_has_ir(unsigned char button_code) {
+    return (button_table[button_code].flags & (BUTTON_FLAG_VALID | BUTTON_FLAG_NO_IR)) == BUTTON_FLAG_VALID;
+}
@@ -1,10 +1,19 @@
-#define _POSIX_C_SOURCE 199309L
+/* pthread mutexes require POSIX.1-2001, recursive ones XSI */
+#undef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200112L
+#undef _XOPEN_SOURCE
+#define _XOPEN_SOURCE 600
 #include "../include/connection.h"
 #include "../include/handlers.h"
+#include "../include/latency.h"
 #include "../include/remote_buttons.h"
+#include "../include/timebase.h"
+#include "../include/timer_wheel.h"
+#include "../include/trace.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdatomic.h>
 #include <time.h>
 
 #ifdef _WIN32
@@ -12,6 +21,7 @@
 #else
 #include <unistd.h>
 #include <sys/time.h>
+#include <pthread.h>
 #endif
 
 /* Connection State */
@@ -21,6 +31,44 @@ static connection_stats_t connection_stats = {0};
 static int connection_initialized = 0;
 static unsigned char connected_device = 0;
 static uint32_t last_verify_time = 0;
+static int link_unverified = 0;     /* Waiting for a transmission to confirm the link */
+static connection_probe_fn_t custom_probe = NULL;
+static void* custom_probe_context = NULL;
+static uint32_t ewma_samples = 0;   /* Attempts folded into the rolling success rate */
+static uint32_t latency_samples = 0; /* Single-frame sends folded into the rolling latency */
+
+/* The state above and the transmitter are shared by the caller's thread
+ * (blocking API) and the timer wheel thread (async requests). One
+ * recursive lock covers both: public functions take it and nested helpers
+ * re-enter it. Blocking retry loops and reconnects drop it while they
+ * wait, so async attempts are never stalled behind a retry delay. Lock
+ * order: request_mutex before state_mutex. */
+#ifndef _WIN32
+static pthread_mutex_t state_mutex;
+static pthread_once_t state_mutex_once = PTHREAD_ONCE_INIT;
+
+static void state_mutex_init(void) {
+    pthread_mutexattr_t attr;
+    
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&state_mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+}
+#endif
+
+static void state_lock(void) {
+#ifndef _WIN32
+    pthread_once(&state_mutex_once, state_mutex_init);
+    pthread_mutex_lock(&state_mutex);
+#endif
+}
+
+static void state_unlock(void) {
+#ifndef _WIN32
+    pthread_mutex_unlock(&state_mutex);
+#endif
+}
 
 /* Make connection_config accessible externally */
 connection_config_t connection_config = {
@@ -29,43 +77,36 @@ connection_config_t connection_config = {
     .connection_timeout_ms = CONNECTION_DEFAULT_TIMEOUT_MS,
     .verify_interval_ms = CONNECTION_DEFAULT_VERIFY_INTERVAL_MS,
     .auto_reconnect = CONNECTION_DEFAULT_AUTO_RECONNECT,
-    .verify_on_send = CONNECTION_DEFAULT_VERIFY_ON_SEND
+    .verify_on_send = CONNECTION_DEFAULT_VERIFY_ON_SEND,
+    .retry_max_delay_ms = CONNECTION_DEFAULT_RETRY_MAX_DELAY_MS,
+    .retry_jitter_percent = CONNECTION_DEFAULT_RETRY_JITTER,
+    .link_probe = CONNECTION_DEFAULT_LINK_PROBE,
+    .adaptive_retries = CONNECTION_DEFAULT_ADAPTIVE_RETRIES
 };
 
 /**
  * @brief Get current timestamp in milliseconds
  */
 static uint32_t get_timestamp_ms(void) {
-#ifdef _WIN32
-    return (uint32_t)GetTickCount();
-#else
-    struct timespec ts;
-    clock_gettime(CLOCK_MONOTONIC, &ts);
-    return (uint32_t)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
-#endif
+    return (uint32_t)(timebase_now_ns() / 1000000ULL);
 }
 
 /**
  * @brief Delay in milliseconds
  */
 static void delay_ms(uint32_t ms) {
-#ifdef _WIN32
-    Sleep(ms);
-#else
-    usleep(ms * 1000);
-#endif
+    timebase_sleep_us(ms * 1000);
 }
 
 /**
- * @brief Calculate connection quality based on statistics
+ * @brief Calculate connection quality from the rolling success rate
  */
 static connection_quality_t calculate_quality(void) {
-    if (connection_stats.total_transmissions == 0) {
+    if (ewma_samples == 0) {
         return QUALITY_NONE;
     }
     
-    float success_rate = (float)connection_stats.successful_transmissions / 
-                         (float)connection_stats.total_transmissions;
+    float success_rate = connection_stats.success_ewma;
     
     if (success_rate >= 0.95f) {
         return QUALITY_EXCELLENT;
@@ -78,19 +119,262 @@ static connection_quality_t calculate_quality(void) {
     }
 }
 
+/**
+ * @brief Retries the next send may spend, from the rolling success rate
+ *
+ * A healthy link loses the odd frame, so one quick retry is enough; a dead
+ * link fails fast instead of stalling every press for the full budget.
+ */
+static uint8_t calculate_retry_budget(void) {
+    uint8_t max = connection_config.max_retries;
+    
+    if (!connection_config.adaptive_retries || ewma_samples == 0) {
+        return max;
+    }
+    if (connection_stats.success_ewma >= CONNECTION_HEALTHY_SUCCESS) {
+        return max < 1 ? max : 1;
+    }
+    if (connection_stats.success_ewma < CONNECTION_DEAD_SUCCESS) {
+        return 0;
+    }
+    return max;
+}
+
+/**
+ * @brief Fold one transmit attempt into the rolling averages
+ * @param single_frame Nonzero if the attempt sent one frame; held buttons
+ *        repeat for hold_ms and would skew the transmit latency
+ *
+ * The success rate starts from 1.0 rather than from the first outcome, so
+ * one lost frame at start-up does not mark the link dead and empty the
+ * retry budget.
+ */
+static void record_attempt(int result, uint64_t start_ns, uint32_t code, int single_frame) {
+    static _Atomic latency_op_t attempt_op = LATENCY_OP_INVALID;
+    float outcome = (result == 0) ? 1.0f : 0.0f;
+    
+    if (ewma_samples == 0) {
+        connection_stats.success_ewma = 1.0f;
+    }
+    connection_stats.success_ewma += CONNECTION_EWMA_ALPHA * (outcome - connection_stats.success_ewma);
+    ewma_samples++;
+    
+    if (single_frame) {
+        uint64_t end_ns = latency_get_timestamp_ns();
+        uint64_t latency_ns = end_ns - start_ns;
+        uint32_t latency_us = (uint32_t)(latency_ns / 1000);
+        latency_op_t op = atomic_load_explicit(&attempt_op, memory_order_relaxed);
+        
+        if (op == LATENCY_OP_INVALID) {
+            op = latency_register_op("connection_attempt");
+            atomic_store_explicit(&attempt_op, op, memory_order_relaxed);
+        }
+        latency_record_op_ns(op, latency_ns, code, end_ns);
+        
+        if (latency_samples == 0) {
+            connection_stats.latency_ewma_us = latency_us;
+        } else {
+            connection_stats.latency_ewma_us = (uint32_t)((float)connection_stats.latency_ewma_us +
+                CONNECTION_EWMA_ALPHA * ((float)latency_us - (float)connection_stats.latency_ewma_us));
+        }
+        latency_samples++;
+    }
+    
+    connection_stats.quality = calculate_quality();
+    connection_stats.retry_budget = calculate_retry_budget();
+}
+
+/**
+ * @brief Delay before a blocking retry
+ *
+ * On a healthy link a lost frame is a one-off, so the retry goes out after
+ * a couple of transmit times instead of the full retry_delay_ms.
+ */
+static uint32_t retry_delay(void) {
+    uint32_t quick;
+    
+    if (!connection_config.adaptive_retries || latency_samples == 0 ||
+        connection_stats.success_ewma < CONNECTION_HEALTHY_SUCCESS) {
+        return connection_config.retry_delay_ms;
+    }
+    
+    quick = connection_stats.latency_ewma_us * 2 / 1000 + 1;
+    return quick < connection_config.retry_delay_ms ? quick : connection_config.retry_delay_ms;
+}
+
+/**
+ * @brief Get a display name for a device type
+ */
+static const char* get_device_name(unsigned char device_type) {
+    switch (device_type) {
+        case 0x01: return "TV";
+        case 0x02: return "DVD";
+        case 0x03: return "Streaming";
+        case 0x04: return "Cable";
+        case 0x05: return "Audio";
+        default:   return "Unknown";
+    }
+}
+
+/**
+ * @brief Send a probe frame and count it in the statistics
+ */
+static int probe_send(ir_code_t code) {
+    uint64_t start_ns = latency_get_timestamp_ns();
+    int result = ir_send(code);
+    
+    if (result == 0) {
+        connection_stats.successful_transmissions++;
+    } else {
+        connection_stats.failed_transmissions++;
+    }
+    
+    connection_stats.total_transmissions++;
+    record_attempt(result, start_ns, code.code, 1);
+    
+    return result;
+}
+
+/**
+ * @brief Check the link with the configured probe strategy
+ * @return 0 if the link works, 1 if the next transmission verifies it,
+ *         -1 if the link is down
+ */
+static int run_probe(void) {
+    ir_code_t null_code;
+    
+    switch ((connection_probe_t)connection_config.link_probe) {
+        case CONNECTION_PROBE_POWER:
+            return connection_test(BUTTON_POWER);
+        
+        case CONNECTION_PROBE_NULL_FRAME:
+            null_code = get_ir_code(BUTTON_POWER);
+            null_code.code = CONNECTION_NULL_PROBE_CODE;
+            null_code.protocol = IR_PROTOCOL_RC5;
+            null_code.repeat_count = 1;
+            return probe_send(null_code);
+        
+        case CONNECTION_PROBE_CUSTOM:
+            if (custom_probe != NULL) {
+                return custom_probe(custom_probe_context);
+            }
+            return 1;
+        
+        case CONNECTION_PROBE_PASSIVE:
+            /* A transmission succeeded recently enough: nothing to send */
+            if (connection_stats.last_success_time != 0 &&
+                get_timestamp_ms() - connection_stats.last_success_time < connection_config.verify_interval_ms) {
+                return 0;
+            }
+            return 1;
+        
+        case CONNECTION_PROBE_PIGGYBACK:
+        default:
+            return 1;
+    }
+}
+
+/**
+ * @brief Mark the connection established after a probe
+ * @param probe_result 0 if the probe confirmed the link, 1 if the next
+ *                     transmission confirms it
+ */
+static void establish_succeeded(unsigned char device_type, int probe_result) {
+    connection_status = CONNECTION_CONNECTED;
+    connected_device = device_type;
+    last_verify_time = get_timestamp_ms();
+    link_unverified = (probe_result != 0);
+    if (!link_unverified) {
+        connection_stats.last_success_time = last_verify_time;
+    }
+    connection_stats.quality = QUALITY_GOOD;
+    
+    printf("[Connection] Successfully connected to %s (device %d)%s\n", get_device_name(device_type), device_type,
+           link_unverified ? ", confirmed by the next transmission" : "");
+    printf("[Connection] Connection quality: Good\n");
+}
+
+/* Error events for failed requests (fired once no lock is held, since
+ * subscribers run synchronously and may start new requests) */
+#define ESTABLISH_FAILED_MESSAGE    "Connection establishment failed"
+#define SEND_FAILED_MESSAGE         "IR transmission failed after retries"
+
+/**
+ * @brief Mark the connection failed after the last test attempt (lock held)
+ *
+ * The caller fires ESTABLISH_FAILED_MESSAGE after unlocking.
+ */
+static void establish_failed(unsigned char device_type) {
+    connection_status = CONNECTION_FAILED;
+    connection_stats.last_failure_time = get_timestamp_ms();
+    fprintf(stderr, "[Connection] Failed to connect to %s (device %d) after %d attempts\n", 
+            get_device_name(device_type), device_type, connection_config.max_retries + 1);
+}
+
+/**
+ * @brief Record one send attempt in the statistics
+ * @return The attempt result
+ */
+static int send_attempt(ir_code_t code, uint32_t hold_ms) {
+    uint64_t start_ns = latency_get_timestamp_ns();
+    int result = (hold_ms > 0) ? ir_send_hold(code, hold_ms) : ir_send(code);
+    
+    record_attempt(result, start_ns, code.code, hold_ms == 0);
+    
+    if (result == 0) {
+        connection_stats.successful_transmissions++;
+        connection_stats.total_transmissions++;
+        connection_stats.last_success_time = get_timestamp_ms();
+        
+        /* Piggybacked verification: this transmission confirms the link */
+        if (link_unverified) {
+            link_unverified = 0;
+            last_verify_time = connection_stats.last_success_time;
+        }
+    } else {
+        connection_stats.failed_transmissions++;
+        connection_stats.retry_count++;
+    }
+    
+    return result;
+}
+
+/**
+ * @brief Record a send that failed on every attempt (lock held)
+ *
+ * The caller fires SEND_FAILED_MESSAGE after unlocking.
+ */
+static void send_failed(void) {
+    connection_stats.total_transmissions++;
+    connection_stats.last_failure_time = get_timestamp_ms();
+    connection_stats.quality = calculate_quality();
+    
+    /* The transmission that was to confirm the link failed */
+    if (link_unverified && connection_status == CONNECTION_CONNECTED) {
+        link_unverified = 0;
+        connection_status = CONNECTION_FAILED;
+        fprintf(stderr, "[Connection] Link not confirmed by first transmission\n");
+    }
+}
+
 /**
  * @brief Initialize connection management
  */
 int connection_init(void) {
+    state_lock();
     if (connection_initialized) {
+        state_unlock();
         return 0;
     }
     
     connection_status = CONNECTION_DISCONNECTED;
     memset(&connection_stats, 0, sizeof(connection_stats_t));
     connection_stats.quality = QUALITY_NONE;
+    ewma_samples = 0;
+    latency_samples = 0;
     
     connection_initialized = 1;
+    state_unlock();
     printf("[Connection] Connection management initialized\n");
     return 0;
 }
@@ -103,7 +387,9 @@ int connection_set_config(connection_config_t* config) {
         return -1;
     }
     
+    state_lock();
     connection_config = *config;
+    state_unlock();
     printf("[Connection] Configuration updated\n");
     return 0;
 }
@@ -119,7 +405,9 @@ connection_config_t* connection_get_config(void) {
  * @brief Establish connection to target device
  */
 int connection_establish(unsigned char device_type) {
+    state_lock();
     if (!connection_initialized) {
+        state_unlock();
         fprintf(stderr, "[Connection] Error: Connection system not initialized\n");
         handler_trigger_error(ERROR_IR_NOT_INITIALIZED, "Connection system not initialized");
         return -1;
@@ -127,28 +415,21 @@ int connection_establish(unsigned char device_type) {
     
     /* If already connected to the same device, return success */
     if (connection_status == CONNECTION_CONNECTED && connected_device == device_type) {
+        state_unlock();
         printf("[Connection] Already connected to device %d\n", device_type);
         return 0;
     }
     
     connection_status = CONNECTION_CONNECTING;
     connection_stats.connection_attempts++;
+    state_unlock();
     
-    const char* device_name = "Unknown";
-    switch (device_type) {
-        case 0x01: device_name = "TV"; break;
-        case 0x02: device_name = "DVD"; break;
-        case 0x03: device_name = "Streaming"; break;
-        case 0x04: device_name = "Cable"; break;
-        case 0x05: device_name = "Audio"; break;
-    }
-    
-    printf("[Connection] Establishing connection to %s (device %d)...\n", device_name, device_type);
+    printf("[Connection] Establishing connection to %s (device %d)...\n", get_device_name(device_type), device_type);
     
     /* Verify IR system is initialized */
     /* In a real implementation, this would test hardware */
     
-    /* Test connection by sending a test command with retries */
+    /* Probe the link with retries (passive and piggyback probes send nothing) */
     int test_result = -1;
     int attempt;
     
@@ -158,37 +439,39 @@ int connection_establish(unsigned char device_type) {
             delay_ms(connection_config.retry_delay_ms);
         }
         
-        test_result = connection_test(BUTTON_POWER);
+        state_lock();
+        test_result = run_probe();
+        state_unlock();
         
-        if (test_result == 0) {
+        if (test_result >= 0) {
             break;  /* Success */
         }
     }
     
-    if (test_result == 0) {
-        connection_status = CONNECTION_CONNECTED;
-        connected_device = device_type;
-        last_verify_time = get_timestamp_ms();
-        connection_stats.last_success_time = last_verify_time;
-        connection_stats.quality = QUALITY_GOOD;
-        
-        printf("[Connection] Successfully connected to %s (device %d)\n", device_name, device_type);
-        printf("[Connection] Connection quality: Good\n");
-        return 0;
+    state_lock();
+    if (test_result >= 0) {
+        establish_succeeded(device_type, test_result);
     } else {
-        connection_status = CONNECTION_FAILED;
-        connection_stats.last_failure_time = get_timestamp_ms();
-        fprintf(stderr, "[Connection] Failed to connect to %s (device %d) after %d attempts\n", 
-                device_name, device_type, connection_config.max_retries + 1);
-        handler_trigger_error(ERROR_TRANSMISSION_FAILED, "Connection establishment failed");
+        establish_failed(device_type);
+    }
+    state_unlock();
+    
+    if (test_result < 0) {
+        handler_trigger_error(ERROR_TRANSMISSION_FAILED, ESTABLISH_FAILED_MESSAGE);
         return -1;
     }
+    return 0;
 }
 
+/* verify_locked() result: link lost, reconnect once the lock is released */
+#define VERIFY_RECONNECT    1
+
 /**
- * @brief Verify connection to target device
+ * @brief Verify connection to target device (lock held)
+ * @return 0 if the link is up, -1 if not, VERIFY_RECONNECT if it was lost
+ *         and auto_reconnect is set
  */
-int connection_verify(void) {
+static int verify_locked(void) {
     if (!connection_initialized) {
         return -1;
     }
@@ -203,35 +486,54 @@ int connection_verify(void) {
         return 0;  /* Still within verification interval */
     }
     
+    /* A piggybacked check is still waiting for its transmission */
+    if (link_unverified) {
+        return 0;
+    }
+    
     connection_status = CONNECTION_VERIFYING;
     
-    /* Send a test command to verify connection */
-    if (connection_test(BUTTON_POWER) == 0) {
+    /* Probe the link with the configured strategy */
+    int probe_result = run_probe();
+    if (probe_result >= 0) {
         connection_status = CONNECTION_CONNECTED;
         last_verify_time = current_time;
-        connection_stats.last_success_time = current_time;
+        link_unverified = (probe_result != 0);
+        if (!link_unverified) {
+            connection_stats.last_success_time = current_time;
+        }
         connection_stats.quality = calculate_quality();
         return 0;
     } else {
         connection_status = CONNECTION_FAILED;
         connection_stats.last_failure_time = current_time;
         
-        if (connection_config.auto_reconnect) {
-            printf("[Connection] Connection lost, attempting reconnect...\n");
-            return connection_reconnect();
-        }
-        
-        return -1;
+        return connection_config.auto_reconnect ? VERIFY_RECONNECT : -1;
     }
 }
 
+/**
+ * @brief Verify connection to target device
+ */
+int connection_verify(void) {
+    int result;
+    
+    state_lock();
+    result = verify_locked();
+    state_unlock();
+    
+    if (result == VERIFY_RECONNECT) {
+        printf("[Connection] Connection lost, attempting reconnect...\n");
+        result = connection_reconnect();
+    }
+    return result;
+}
+
 /**
  * @brief Test connection by sending a test command
  */
 int connection_test(unsigned char test_button) {
-    if (!connection_initialized) {
-        return -1;
-    }
+    int result = -1;
     
     /* Get IR code for test button */
     ir_code_t test_code = get_ir_code(test_button);
@@ -240,31 +542,57 @@ int connection_test(unsigned char test_button) {
     }
     
     /* Send test command */
-    int result = ir_send(test_code);
-    
-    if (result == 0) {
-        connection_stats.successful_transmissions++;
-    } else {
-        connection_stats.failed_transmissions++;
+    state_lock();
+    if (connection_initialized) {
+        result = probe_send(test_code);
     }
-    
-    connection_stats.total_transmissions++;
-    connection_stats.quality = calculate_quality();
-    
+    state_unlock();
     return result;
 }
 
+/**
+ * @brief Install a custom link probe and select CONNECTION_PROBE_CUSTOM
+ */
+int connection_set_custom_probe(connection_probe_fn_t probe, void* context) {
+    state_lock();
+    custom_probe = probe;
+    custom_probe_context = context;
+    connection_config.link_probe = probe ? CONNECTION_PROBE_CUSTOM : CONNECTION_PROBE_PASSIVE;
+    state_unlock();
+    return 0;
+}
+
+/**
+ * @brief Check if the link has been confirmed since it was established
+ */
+int connection_is_verified(void) {
+    int verified;
+    
+    state_lock();
+    verified = (connection_status == CONNECTION_CONNECTED && !link_unverified);
+    state_unlock();
+    return verified;
+}
+
 /**
  * @brief Get current connection status
  */
 connection_status_t connection_get_status(void) {
-    return connection_status;
+    connection_status_t status;
+    
+    state_lock();
+    status = connection_status;
+    state_unlock();
+    return status;
 }
 
 /**
  * @brief Get connection statistics
  */
 connection_stats_t* connection_get_stats(void) {
+    state_lock();
+    connection_stats.retry_budget = calculate_retry_budget();
+    state_unlock();
     return &connection_stats;
 }
 
@@ -272,76 +600,105 @@ connection_stats_t* connection_get_stats(void) {
  * @brief Get connection quality
  */
 connection_quality_t connection_get_quality(void) {
-    connection_stats.quality = calculate_quality();
-    return connection_stats.quality;
+    connection_quality_t quality;
+    
+    state_lock();
+    quality = connection_stats.quality = calculate_quality();
+    state_unlock();
+    return quality;
 }
 
 /**
  * @brief Check if connection is active
  */
 int connection_is_connected(void) {
+    int result = -1;
+    
+    state_lock();
     if (connection_status == CONNECTION_CONNECTED) {
         /* Verify connection if configured */
-        if (connection_config.verify_on_send) {
-            return connection_verify() == 0;
-        }
-        return 1;
+        result = connection_config.verify_on_send ? verify_locked() : 0;
     }
-    return 0;
+    state_unlock();
+    
+    if (result == VERIFY_RECONNECT) {
+        printf("[Connection] Connection lost, attempting reconnect...\n");
+        result = connection_reconnect();
+    }
+    return result == 0;
 }
 
 /**
  * @brief Get currently connected device
  */
 unsigned char connection_get_connected_device(void) {
+    unsigned char device = 0;
+    
+    state_lock();
     if (connection_status == CONNECTION_CONNECTED) {
-        return connected_device;
+        device = connected_device;
     }
-    return 0;
+    state_unlock();
+    return device;
 }
 
 /**
  * @brief Reconnect to device
  */
 int connection_reconnect(void) {
-    if (!connection_initialized) {
-        return -1;
-    }
+    unsigned char device;
     
-    if (connected_device == 0) {
-        fprintf(stderr, "[Connection] No device to reconnect to\n");
+    state_lock();
+    device = connected_device;
+    if (!connection_initialized || device == 0) {
+        state_unlock();
+        if (connection_initialized) {
+            fprintf(stderr, "[Connection] No device to reconnect to\n");
+        }
         return -1;
     }
     
-    printf("[Connection] Reconnecting to device %d...\n", connected_device);
+    printf("[Connection] Reconnecting to device %d...\n", device);
     
-    /* Disconnect first */
+    /* Disconnect first (this forgets the device, hence the copy) */
     connection_disconnect();
+    state_unlock();
     
     /* Wait before reconnecting */
     delay_ms(connection_config.retry_delay_ms);
     
     /* Attempt to reconnect */
-    return connection_establish(connected_device);
+    return connection_establish(device);
 }
 
 /**
  * @brief Disconnect from device
  */
 void connection_disconnect(void) {
+    state_lock();
     if (connection_status == CONNECTION_DISCONNECTED) {
+        state_unlock();
         return;
     }
     
     connection_status = CONNECTION_DISCONNECTED;
     connected_device = 0;
+    link_unverified = 0;
+    state_unlock();
     printf("[Connection] Disconnected\n");
 }
 
 /**
- * @brief Send IR code with connection verification and retry
+ * @brief Send IR code (optionally held) with verification and retry
+ * @param hold_ms Button hold time in ms (0 = single press)
  */
-int connection_send_with_retry(ir_code_t code) {
+static int connection_send_internal(ir_code_t code, uint32_t hold_ms) {
+    int attempt;
+    int result = -1;
+    int budget;
+    int reconnect;
+    uint32_t start_time;
+    
     if (!connection_initialized) {
         handler_trigger_error(ERROR_IR_NOT_INITIALIZED, "Connection system not initialized");
         return -1;
@@ -362,38 +719,47 @@ int connection_send_with_retry(ir_code_t code) {
         }
     }
     
-    /* Send with retry logic */
-    int attempt;
-    int result = -1;
+    /* Send with retry logic (budget fixed for this send, so a failing
+     * attempt cannot stretch it; connection_timeout_ms bounds the total).
+     * The lock is held per attempt, not across the waits. */
+    state_lock();
+    budget = calculate_retry_budget();
+    state_unlock();
+    start_time = get_timestamp_ms();
     
-    for (attempt = 0; attempt <= connection_config.max_retries; attempt++) {
+    for (attempt = 0; attempt <= budget; attempt++) {
         if (attempt > 0) {
-            printf("[Connection] Retry attempt %d/%d\n", attempt, connection_config.max_retries);
-            delay_ms(connection_config.retry_delay_ms);
+            uint32_t wait;
+            
+            state_lock();
+            wait = retry_delay();
+            state_unlock();
+            
+            if (connection_config.adaptive_retries && connection_config.connection_timeout_ms > 0 &&
+                get_timestamp_ms() - start_time + wait > connection_config.connection_timeout_ms) {
+                printf("[Connection] Retry budget exhausted after %u ms\n", get_timestamp_ms() - start_time);
+                break;
+            }
+            printf("[Connection] Retry attempt %d/%d\n", attempt, budget);
+            delay_ms(wait);
         }
         
-        result = ir_send(code);
-        
+        state_lock();
+        result = send_attempt(code, hold_ms);
+        state_unlock();
         if (result == 0) {
-            connection_stats.successful_transmissions++;
-            connection_stats.total_transmissions++;
-            connection_stats.last_success_time = get_timestamp_ms();
-            connection_stats.quality = calculate_quality();
             return 0;
-        } else {
-            connection_stats.failed_transmissions++;
-            connection_stats.retry_count++;
         }
     }
     
-    connection_stats.total_transmissions++;
-    connection_stats.last_failure_time = get_timestamp_ms();
-    connection_stats.quality = calculate_quality();
+    state_lock();
+    send_failed();
+    reconnect = connection_config.auto_reconnect && connection_status == CONNECTION_CONNECTED;
+    state_unlock();
+    handler_trigger_error(ERROR_TRANSMISSION_FAILED, SEND_FAILED_MESSAGE);
     
-    handler_trigger_error(ERROR_TRANSMISSION_FAILED, "IR transmission failed after retries");
-    
-    /* Auto-reconnect on failure if configured */
-    if (connection_config.auto_reconnect && connection_status == CONNECTION_CONNECTED) {
+    /* Auto-reconnect on failure if configured (its waits run unlocked) */
+    if (reconnect) {
         printf("[Connection] Transmission failed, attempting reconnect...\n");
         connection_reconnect();
     }
@@ -401,12 +767,370 @@ int connection_send_with_retry(ir_code_t code) {
     return -1;
 }
 
+/**
+ * @brief Send IR code with connection verification and retry
+ */
+int connection_send_with_retry(ir_code_t code) {
+    int result;
+    
+    trace_begin("connection_send_with_retry", code.code);
+    result = connection_send_internal(code, 0);
+    trace_end("connection_send_with_retry");
+    return result;
+}
+
+/**
+ * @brief Send held IR code with connection verification and retry
+ */
+int connection_send_hold_with_retry(ir_code_t code, uint32_t hold_ms) {
+    int result;
+    
+    trace_begin("connection_send_hold_with_retry", code.code);
+    result = connection_send_internal(code, hold_ms);
+    trace_end("connection_send_hold_with_retry");
+    return result;
+}
+
+/* ============================================================================
+ * ASYNC REQUESTS
+ * ============================================================================ */
+
+/* Request Kinds */
+typedef enum {
+    REQUEST_FREE = 0,
+    REQUEST_ESTABLISH,
+    REQUEST_SEND
+} request_kind_t;
+
+/* Async Request (state machine entry on the timer wheel) */
+typedef struct {
+    request_kind_t kind;
+    connection_request_t id;        /* Generation << 8 | (index + 1) */
+    ir_code_t code;                 /* REQUEST_SEND */
+    uint32_t hold_ms;               /* REQUEST_SEND */
+    unsigned char device_type;      /* REQUEST_ESTABLISH */
+    int attempt;                    /* Attempts made so far */
+    int max_retries;                /* Retry budget fixed when the request started */
+    int cancelled;
+    timer_id_t timer;               /* Next attempt */
+    connection_completion_t done;
+    void* context;
+} connection_request_entry_t;
+
+static connection_request_entry_t requests[CONNECTION_MAX_REQUESTS];
+static uint32_t next_request_generation = 1;
+static int timer_wheel_acquired = 0;    /* Holds a timer_wheel_init() use until cleanup */
+static _Atomic uint64_t jitter_sequence = 0;
+
+#ifndef _WIN32
+static pthread_mutex_t request_mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+static void request_lock(void) {
+#ifndef _WIN32
+    pthread_mutex_lock(&request_mutex);
+#endif
+}
+
+static void request_unlock(void) {
+#ifndef _WIN32
+    pthread_mutex_unlock(&request_mutex);
+#endif
+}
+
+/**
+ * @brief Delay before retry number `retry` (1-based): capped exponential backoff with jitter
+ */
+static uint32_t retry_backoff_ms(int retry) {
+    uint64_t cap = connection_config.retry_max_delay_ms ? connection_config.retry_max_delay_ms
+                                                        : CONNECTION_DEFAULT_RETRY_MAX_DELAY_MS;
+    uint64_t delay = connection_config.retry_delay_ms;
+    uint64_t jitter;
+    int i;
+    
+    for (i = 1; i < retry && delay < cap; i++) {
+        delay *= 2;
+    }
+    if (delay > cap) {
+        delay = cap;
+    }
+    
+    jitter = delay * (connection_config.retry_jitter_percent > 100 ? 100 : connection_config.retry_jitter_percent) / 100;
+    if (jitter > 0) {
+        /* splitmix64 over a shared counter: thread-safe without a lock */
+        uint64_t x = atomic_fetch_add_explicit(&jitter_sequence, 0x9E3779B97F4A7C15ULL,
+                                               memory_order_relaxed) + timebase_now_ns();
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+        x ^= x >> 31;
+        delay -= x % (jitter + 1);
+    }
+    
+    return (uint32_t)delay;
+}
+
+/**
+ * @brief Look up an in-flight request (lock held)
+ */
+static connection_request_entry_t* request_lookup(connection_request_t id) {
+    uint32_t index = id & 0xFFu;
+    
+    if (index == 0 || index > CONNECTION_MAX_REQUESTS) {
+        return NULL;
+    }
+    if (requests[index - 1].kind == REQUEST_FREE || requests[index - 1].id != id) {
+        return NULL;
+    }
+    return &requests[index - 1];
+}
+
+/**
+ * @brief Cancel a request (lock held)
+ */
+static void request_cancel_locked(connection_request_entry_t* request) {
+    if (request->timer != TIMER_ID_INVALID && timer_wheel_cancel(request->timer) == 0) {
+        memset(request, 0, sizeof(*request));  /* Pending or just fired: free now */
+    } else {
+        request->cancelled = 1;                 /* Attempt in progress frees it */
+    }
+}
+
+/**
+ * @brief Run one attempt of a request (timer wheel callback)
+ */
+static int request_attempt(timer_id_t timer, void* context) {
+    connection_request_entry_t* request = (connection_request_entry_t*)context;
+    connection_completion_t done;
+    connection_request_t id;
+    void* done_context;
+    const char* error = NULL;
+    int result;
+    int finished;
+    
+    /* A request cancelled as this timer fired has already been freed
+     * (and its slot possibly reused), so its timer no longer matches */
+    request_lock();
+    if (request->timer != timer) {
+        request_unlock();
+        return 0;
+    }
+    request->timer = TIMER_ID_INVALID;
+    request->attempt++;
+    request_unlock();
+    
+    if (request->kind == REQUEST_ESTABLISH) {
+        if (request->attempt > 1) {
+            printf("[Connection] Connection test retry %d/%d...\n",
+                   request->attempt - 1, request->max_retries);
+        }
+        state_lock();
+        result = run_probe();
+        state_unlock();
+    } else {
+        if (request->attempt > 1) {
+            printf("[Connection] Retry attempt %d/%d\n", request->attempt - 1, request->max_retries);
+        }
+        trace_begin("connection_send_async", request->code.code);
+        state_lock();
+        result = send_attempt(request->code, request->hold_ms);
+        state_unlock();
+        trace_end("connection_send_async");
+    }
+    
+    /* A deferred probe (1) still establishes the connection */
+    finished = ((request->kind == REQUEST_ESTABLISH ? result >= 0 : result == 0) ||
+                request->attempt > request->max_retries);
+    
+    request_lock();
+    if (request->cancelled) {
+        memset(request, 0, sizeof(*request));
+        request_unlock();
+        return 0;
+    }
+    
+    if (!finished) {
+        request->timer = timer_wheel_add(retry_backoff_ms(request->attempt), 0, request_attempt, request);
+        if (request->timer != TIMER_ID_INVALID) {
+            request_unlock();
+            return 0;
+        }
+        finished = 1;  /* Wheel full: give up now rather than never */
+    }
+    
+    id = request->id;
+    done = request->done;
+    done_context = request->context;
+    
+    state_lock();
+    if (request->kind == REQUEST_ESTABLISH) {
+        if (result >= 0) {
+            establish_succeeded(request->device_type, result);
+            result = 0;
+        } else {
+            establish_failed(request->device_type);
+            error = ESTABLISH_FAILED_MESSAGE;
+        }
+    } else if (result != 0) {
+        send_failed();
+        error = SEND_FAILED_MESSAGE;
+    }
+    state_unlock();
+    
+    memset(request, 0, sizeof(*request));
+    request_unlock();
+    
+    /* Outside both locks: subscribers may start or cancel requests */
+    if (error != NULL) {
+        handler_trigger_error(ERROR_TRANSMISSION_FAILED, error);
+    }
+    if (done != NULL) {
+        done(id, result == 0 ? 0 : -1, done_context);
+    }
+    return 0;
+}
+
+/**
+ * @brief Allocate a request and schedule its first attempt
+ */
+static connection_request_t request_start(request_kind_t kind, connection_completion_t done, void* context,
+                                          connection_request_entry_t* init) {
+    connection_request_entry_t* request = NULL;
+    connection_request_t id;
+    int i;
+    
+    if (!connection_initialized) {
+        handler_trigger_error(ERROR_IR_NOT_INITIALIZED, "Connection system not initialized");
+        return CONNECTION_REQUEST_INVALID;
+    }
+    
+    request_lock();
+    if (!timer_wheel_acquired) {
+        if (timer_wheel_init(0) != 0) {
+            request_unlock();
+            return CONNECTION_REQUEST_INVALID;
+        }
+        timer_wheel_acquired = 1;
+    }
+    request_unlock();
+    if (timer_wheel_start() != 0) {
+        return CONNECTION_REQUEST_INVALID;
+    }
+    
+    request_lock();
+    for (i = 0; i < CONNECTION_MAX_REQUESTS; i++) {
+        if (requests[i].kind == REQUEST_FREE) {
+            request = &requests[i];
+            break;
+        }
+    }
+    if (request == NULL) {
+        request_unlock();
+        fprintf(stderr, "[Connection] Too many requests in flight (%d)\n", CONNECTION_MAX_REQUESTS);
+        return CONNECTION_REQUEST_INVALID;
+    }
+    
+    *request = *init;
+    request->kind = kind;
+    state_lock();
+    request->max_retries = (kind == REQUEST_SEND) ? calculate_retry_budget() : connection_config.max_retries;
+    state_unlock();
+    request->id = (next_request_generation << 8) | (uint32_t)(i + 1);
+    request->done = done;
+    request->context = context;
+    if (++next_request_generation > 0xFFFFFFu) {
+        next_request_generation = 1;
+    }
+    
+    request->timer = timer_wheel_add(0, 0, request_attempt, request);
+    if (request->timer == TIMER_ID_INVALID) {
+        memset(request, 0, sizeof(*request));
+        request_unlock();
+        return CONNECTION_REQUEST_INVALID;
+    }
+    
+    id = request->id;
+    request_unlock();
+    return id;
+}
+
+/**
+ * @brief Establish a connection without blocking
+ */
+connection_request_t connection_establish_async(unsigned char device_type,
+                                                connection_completion_t done, void* context) {
+    connection_request_entry_t init;
+    
+    memset(&init, 0, sizeof(init));
+    init.device_type = device_type;
+    
+    state_lock();
+    if (connection_initialized) {
+        connection_status = CONNECTION_CONNECTING;
+        connection_stats.connection_attempts++;
+        printf("[Connection] Establishing connection to %s (device %d) in background...\n",
+               get_device_name(device_type), device_type);
+    }
+    state_unlock();
+    
+    return request_start(REQUEST_ESTABLISH, done, context, &init);
+}
+
+/**
+ * @brief Send an IR code (optionally held) without blocking
+ */
+connection_request_t connection_send_async(ir_code_t code, uint32_t hold_ms,
+                                           connection_completion_t done, void* context) {
+    connection_request_entry_t init;
+    
+    memset(&init, 0, sizeof(init));
+    init.code = code;
+    init.hold_ms = hold_ms;
+    
+    return request_start(REQUEST_SEND, done, context, &init);
+}
+
+/**
+ * @brief Cancel an async request
+ */
+int connection_request_cancel(connection_request_t request_id) {
+    connection_request_entry_t* request;
+    
+    request_lock();
+    request = request_lookup(request_id);
+    if (request == NULL || request->cancelled) {
+        request_unlock();
+        return -1;
+    }
+    
+    request_cancel_locked(request);
+    request_unlock();
+    return 0;
+}
+
+/**
+ * @brief Check if an async request is still in flight
+ */
+int connection_request_pending(connection_request_t request_id) {
+    connection_request_entry_t* request;
+    int pending;
+    
+    request_lock();
+    request = request_lookup(request_id);
+    pending = (request != NULL && !request->cancelled);
+    request_unlock();
+    return pending;
+}
+
 /**
  * @brief Reset connection statistics
  */
 void connection_reset_stats(void) {
+    state_lock();
     memset(&connection_stats, 0, sizeof(connection_stats_t));
     connection_stats.quality = QUALITY_NONE;
+    ewma_samples = 0;
+    latency_samples = 0;
+    state_unlock();
     printf("[Connection] Statistics reset\n");
 }
 
@@ -414,12 +1138,33 @@ void connection_reset_stats(void) {
  * @brief Cleanup connection management
  */
 void connection_cleanup(void) {
+    int release_wheel;
+    
     if (!connection_initialized) {
         return;
     }
     
+    /* Pending async requests are dropped without completion */
+    request_lock();
+    for (int i = 0; i < CONNECTION_MAX_REQUESTS; i++) {
+        if (requests[i].kind != REQUEST_FREE && !requests[i].cancelled) {
+            request_cancel_locked(&requests[i]);
+        }
+    }
+    release_wheel = timer_wheel_acquired;
+    timer_wheel_acquired = 0;
+    request_unlock();
+    
+    /* Outside request_mutex: the last wheel user joins the wheel thread,
+     * which may be waiting for it in request_attempt() */
+    if (release_wheel) {
+        timer_wheel_cleanup();
+    }
+    
+    state_lock();
     connection_disconnect();
     connection_initialized = 0;
+    state_unlock();
     printf("[Connection] Connection management cleaned up\n");
 }
 
@@ -1,7 +1,12 @@
-#define _POSIX_C_SOURCE 199309L
+/* pthreads and sem_t require POSIX.1-2001 */
+#undef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200112L
 #include "../include/handlers.h"
 #include "../include/remote_control.h"
 #include "../include/remote_buttons.h"
+#include "../include/trace.h"
+#include "../include/timer_wheel.h"
+#include "../include/latency.h"
 #ifdef SIMULATOR
 # include "../include/tv_simulator.h"
 #endif
@@ -9,12 +14,16 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <stdatomic.h>
 #ifdef _WIN32
 # include <windows.h>
 #else
 # include <unistd.h>
 # include <signal.h>
 # include <sys/time.h>
+# include <pthread.h>
+# include <semaphore.h>
+# include <sched.h>
 #endif
 
 /* Forward declaration for interrupt callback (called from assembly) */
@@ -23,10 +32,786 @@ void interrupt_callback(void);
 /* Handler Storage */
 handlers_t registered_handlers = {0};
 static int handlers_initialized = 0;
+static int timer_wheel_acquired = 0;    /* Holds a timer_wheel_init() use */
 
 /* Interrupt callback storage (used by handler_register_interrupt and assembly path) */
 static interrupt_handler_t interrupt_callback_storage = NULL;
 
+/* ============================================================================
+ * EVENT BUS
+ * ============================================================================ */
+
+/* Subscription (snapshot copy used while dispatching) */
+typedef struct {
+    event_subscriber_t callback;    /* Subscriber function */
+    void* context;                  /* Passed back to the callback */
+    int priority;                   /* Higher runs first */
+    int async;                      /* Deliver on the dispatcher thread */
+    event_token_t token;            /* Unsubscribe token */
+} event_subscription_t;
+
+/* Stored subscription. Publishers read it while a writer may change it, so
+ * every field is a relaxed atomic and bus_version orders the accesses. */
+typedef struct {
+    _Atomic(event_subscriber_t) callback;
+    _Atomic(void*) context;
+    _Atomic int priority;
+    _Atomic int async;
+    _Atomic event_token_t token;
+} event_bus_entry_t;
+
+/* Subscribers of one event type, sorted by priority */
+typedef struct {
+    event_bus_entry_t entries[EVENT_BUS_MAX_SUBSCRIBERS];
+    _Atomic int count;
+    _Atomic int async_count;        /* Entries with async set */
+} event_subscriber_list_t;
+
+static event_subscriber_list_t event_bus[EVENT_TYPE_COUNT];
+static event_token_t next_token = 1;
+
+/* Odd while a subscription change is in progress (readers retry) */
+static _Atomic uint32_t bus_version = 0;
+
+/* Serializes subscription changes; readers only use bus_version */
+#ifndef _WIN32
+static pthread_mutex_t bus_writer_mutex = PTHREAD_MUTEX_INITIALIZER;
+#define BUS_WRITER_LOCK()   pthread_mutex_lock(&bus_writer_mutex)
+#define BUS_WRITER_UNLOCK() pthread_mutex_unlock(&bus_writer_mutex)
+#else
+#define BUS_WRITER_LOCK()   ((void)0)
+#define BUS_WRITER_UNLOCK() ((void)0)
+#endif
+
+/* Bus subscriptions that forward to the single-slot handlers_t callbacks */
+static event_token_t legacy_tokens[EVENT_TYPE_COUNT];
+
+/**
+ * @brief Get current timestamp in milliseconds
+ */
+static uint32_t get_timestamp(void) {
+#ifdef _WIN32
+    return (uint32_t)GetTickCount();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+#endif
+}
+
+/**
+ * @brief Begin/end a subscription change (seqlock writer side)
+ *
+ * Callers hold bus_writer_mutex, so only one change bumps the version at a
+ * time and it is odd exactly while the lists are being modified.
+ */
+static void bus_write_begin(void) {
+    atomic_fetch_add_explicit(&bus_version, 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);  /* Odd version before any entry store */
+}
+
+static void bus_write_end(void) {
+    atomic_fetch_add_explicit(&bus_version, 1, memory_order_release);
+}
+
+/**
+ * @brief Read or write one stored subscription (relaxed)
+ */
+static void bus_entry_load(const event_bus_entry_t* entry, event_subscription_t* out) {
+    out->callback = atomic_load_explicit(&entry->callback, memory_order_relaxed);
+    out->context = atomic_load_explicit(&entry->context, memory_order_relaxed);
+    out->priority = atomic_load_explicit(&entry->priority, memory_order_relaxed);
+    out->async = atomic_load_explicit(&entry->async, memory_order_relaxed);
+    out->token = atomic_load_explicit(&entry->token, memory_order_relaxed);
+}
+
+static void bus_entry_store(event_bus_entry_t* entry, const event_subscription_t* in) {
+    atomic_store_explicit(&entry->callback, in->callback, memory_order_relaxed);
+    atomic_store_explicit(&entry->context, in->context, memory_order_relaxed);
+    atomic_store_explicit(&entry->priority, in->priority, memory_order_relaxed);
+    atomic_store_explicit(&entry->async, in->async, memory_order_relaxed);
+    atomic_store_explicit(&entry->token, in->token, memory_order_relaxed);
+}
+
+/**
+ * @brief Get the number of subscribers of an event type (may be stale)
+ */
+static int bus_count(event_type_t type) {
+    return atomic_load_explicit(&event_bus[type].count, memory_order_relaxed);
+}
+
+/**
+ * @brief Remove every subscription (writer lock held)
+ */
+static void bus_clear(void) {
+    int type;
+    
+    bus_write_begin();
+    for (type = 0; type < EVENT_TYPE_COUNT; type++) {
+        atomic_store_explicit(&event_bus[type].count, 0, memory_order_relaxed);
+        atomic_store_explicit(&event_bus[type].async_count, 0, memory_order_relaxed);
+    }
+    bus_write_end();
+}
+
+/**
+ * @brief Copy the subscribers of an event type
+ * @return Number of subscribers copied
+ *
+ * Retries if a subscription change overlaps the copy, so the dispatcher
+ * thread always sees a consistent list.
+ */
+static int bus_snapshot(event_type_t type, event_subscription_t* snapshot, int* async_count) {
+    const event_subscriber_list_t* list = &event_bus[type];
+    uint32_t version;
+    int count;
+    int i;
+    
+    do {
+        version = atomic_load_explicit(&bus_version, memory_order_acquire);
+        count = atomic_load_explicit(&list->count, memory_order_relaxed);
+        *async_count = atomic_load_explicit(&list->async_count, memory_order_relaxed);
+        if (count > EVENT_BUS_MAX_SUBSCRIBERS) {
+            count = EVENT_BUS_MAX_SUBSCRIBERS;  /* Torn read: the version check retries */
+        }
+        for (i = 0; i < count; i++) {
+            bus_entry_load(&list->entries[i], &snapshot[i]);
+        }
+        atomic_thread_fence(memory_order_acquire);
+    } while ((version & 1u) || version != atomic_load_explicit(&bus_version, memory_order_relaxed));
+    
+    return count;
+}
+
+/**
+ * @brief Add a subscription
+ */
+static event_token_t bus_subscribe(event_type_t type, event_subscriber_t callback, void* context,
+                                   int priority, int async) {
+    event_subscriber_list_t* list;
+    event_subscription_t entry;
+    event_subscription_t moved;
+    event_token_t token;
+    int count;
+    int pos;
+    
+    if ((unsigned int)type >= EVENT_TYPE_COUNT || callback == NULL) {
+        return EVENT_TOKEN_INVALID;
+    }
+    
+    list = &event_bus[type];
+    BUS_WRITER_LOCK();
+    count = atomic_load_explicit(&list->count, memory_order_relaxed);
+    if (count >= EVENT_BUS_MAX_SUBSCRIBERS) {
+        BUS_WRITER_UNLOCK();
+        fprintf(stderr, "[Handler] Event %d: subscriber limit (%d) reached\n",
+                type, EVENT_BUS_MAX_SUBSCRIBERS);
+        return EVENT_TOKEN_INVALID;
+    }
+    
+    token = next_token++;
+    if (next_token == EVENT_TOKEN_INVALID) {
+        next_token = 1;
+    }
+    
+    entry.callback = callback;
+    entry.context = context;
+    entry.priority = priority;
+    entry.async = async;
+    entry.token = token;
+    
+    bus_write_begin();
+    
+    /* Insert after every subscriber with the same or higher priority */
+    pos = count;
+    while (pos > 0 && atomic_load_explicit(&list->entries[pos - 1].priority, memory_order_relaxed) < priority) {
+        bus_entry_load(&list->entries[pos - 1], &moved);
+        bus_entry_store(&list->entries[pos], &moved);
+        pos--;
+    }
+    
+    bus_entry_store(&list->entries[pos], &entry);
+    atomic_store_explicit(&list->count, count + 1, memory_order_relaxed);
+    if (async) {
+        atomic_fetch_add_explicit(&list->async_count, 1, memory_order_relaxed);
+    }
+    
+    bus_write_end();
+    BUS_WRITER_UNLOCK();
+    return token;
+}
+
+/**
+ * @brief Subscribe to an event type
+ */
+event_token_t event_subscribe(event_type_t type, event_subscriber_t callback, void* context, int priority) {
+    return bus_subscribe(type, callback, context, priority, 0);
+}
+
+/**
+ * @brief Subscribe to an event type on the dispatcher thread
+ */
+event_token_t event_subscribe_async(event_type_t type, event_subscriber_t callback, void* context, int priority) {
+    return bus_subscribe(type, callback, context, priority, 1);
+}
+
+/**
+ * @brief Remove a subscription
+ */
+int event_unsubscribe(event_token_t token) {
+    event_subscription_t moved;
+    int type;
+    int count;
+    int i;
+    
+    if (token == EVENT_TOKEN_INVALID) {
+        return -1;
+    }
+    
+    BUS_WRITER_LOCK();
+    for (type = 0; type < EVENT_TYPE_COUNT; type++) {
+        event_subscriber_list_t* list = &event_bus[type];
+        
+        count = atomic_load_explicit(&list->count, memory_order_relaxed);
+        for (i = 0; i < count; i++) {
+            if (atomic_load_explicit(&list->entries[i].token, memory_order_relaxed) == token) {
+                bus_write_begin();
+                if (atomic_load_explicit(&list->entries[i].async, memory_order_relaxed)) {
+                    atomic_fetch_sub_explicit(&list->async_count, 1, memory_order_relaxed);
+                }
+                for (; i < count - 1; i++) {
+                    bus_entry_load(&list->entries[i + 1], &moved);
+                    bus_entry_store(&list->entries[i], &moved);
+                }
+                atomic_store_explicit(&list->count, count - 1, memory_order_relaxed);
+                bus_write_end();
+                BUS_WRITER_UNLOCK();
+                return 0;
+            }
+        }
+    }
+    BUS_WRITER_UNLOCK();
+    
+    return -1;
+}
+
+/**
+ * @brief Get the number of subscribers of an event type
+ */
+int event_subscriber_count(event_type_t type) {
+    if ((unsigned int)type >= EVENT_TYPE_COUNT) {
+        return 0;
+    }
+    return bus_count(type);
+}
+
+/* ============================================================================
+ * ASYNC DISPATCH
+ * ============================================================================ */
+
+/* Queue slot: seq == position when free, position + 1 when filled */
+typedef struct {
+    _Atomic size_t seq;
+    event_t event;
+} event_queue_slot_t;
+
+static event_queue_slot_t* queue_slots = NULL;
+static size_t queue_mask = 0;
+static _Atomic size_t queue_head = 0;       /* Next position to dequeue */
+static _Atomic size_t queue_tail = 0;       /* Next position to enqueue */
+static handler_backpressure_t queue_policy = HANDLER_ASYNC_DROP_NEWEST;
+
+static _Atomic int async_running = 0;
+static _Atomic int dispatcher_busy = 0;
+static _Atomic uint64_t async_queued = 0;
+static _Atomic uint64_t async_delivered = 0;
+static _Atomic uint64_t async_dropped = 0;
+static _Thread_local int on_dispatcher_thread = 0;
+
+#ifndef _WIN32
+static pthread_t dispatcher_thread;
+static sem_t dispatcher_wake;
+#endif
+
+/**
+ * @brief Enqueue one event (lock-free, any number of producers)
+ * @return 0 on success, -1 if the queue is full
+ */
+static int queue_push(const event_t* event) {
+    size_t pos = atomic_load_explicit(&queue_tail, memory_order_relaxed);
+    
+    for (;;) {
+        event_queue_slot_t* slot = &queue_slots[pos & queue_mask];
+        size_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&queue_tail, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                slot->event = *event;
+                atomic_store_explicit(&slot->seq, pos + 1, memory_order_release);
+                return 0;
+            }
+        } else if (diff < 0) {
+            return -1;  /* Full: the slot still holds an event from the previous lap */
+        } else {
+            pos = atomic_load_explicit(&queue_tail, memory_order_relaxed);
+        }
+    }
+}
+
+/**
+ * @brief Dequeue one event (the dispatcher, or a producer dropping the oldest)
+ * @return 0 on success, -1 if the queue is empty
+ */
+static int queue_pop(event_t* event) {
+    size_t pos = atomic_load_explicit(&queue_head, memory_order_relaxed);
+    
+    for (;;) {
+        event_queue_slot_t* slot = &queue_slots[pos & queue_mask];
+        size_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+        
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&queue_head, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                *event = slot->event;
+                atomic_store_explicit(&slot->seq, pos + queue_mask + 1, memory_order_release);
+                return 0;
+            }
+        } else if (diff < 0) {
+            return -1;  /* Empty */
+        } else {
+            pos = atomic_load_explicit(&queue_head, memory_order_relaxed);
+        }
+    }
+}
+
+/**
+ * @brief Hand an event to the dispatcher thread, applying the backpressure policy
+ */
+static void async_enqueue(const event_t* event) {
+    while (queue_push(event) != 0) {
+        event_t oldest;
+        
+        switch (queue_policy) {
+            case HANDLER_ASYNC_DROP_OLDEST:
+                if (queue_pop(&oldest) == 0) {
+                    atomic_fetch_add_explicit(&async_dropped, 1, memory_order_relaxed);
+                }
+                break;
+            
+            case HANDLER_ASYNC_BLOCK:
+#ifndef _WIN32
+                sched_yield();
+#endif
+                break;
+            
+            case HANDLER_ASYNC_DROP_NEWEST:
+            default:
+                atomic_fetch_add_explicit(&async_dropped, 1, memory_order_relaxed);
+                return;
+        }
+    }
+    
+    atomic_fetch_add_explicit(&async_queued, 1, memory_order_relaxed);
+#ifndef _WIN32
+    sem_post(&dispatcher_wake);
+#endif
+}
+
+/**
+ * @brief Deliver a dequeued event to the async subscribers of its type
+ */
+static void async_deliver(event_t* event) {
+    event_subscription_t snapshot[EVENT_BUS_MAX_SUBSCRIBERS];
+    int async_count;
+    int count = bus_snapshot(event->type, snapshot, &async_count);
+    int i;
+    
+    for (i = 0; i < count; i++) {
+        if (snapshot[i].async) {
+            snapshot[i].callback(event, snapshot[i].context);
+        }
+    }
+}
+
+/**
+ * @brief Drain the queue in batches
+ */
+static void async_drain(void) {
+    event_t batch[HANDLER_ASYNC_BATCH];
+    
+    for (;;) {
+        size_t n = 0;
+        size_t i;
+        
+        atomic_store(&dispatcher_busy, 1);
+        while (n < HANDLER_ASYNC_BATCH && queue_pop(&batch[n]) == 0) {
+            n++;
+        }
+        if (n == 0) {
+            atomic_store(&dispatcher_busy, 0);
+            return;
+        }
+        
+        for (i = 0; i < n; i++) {
+            async_deliver(&batch[i]);
+        }
+        atomic_fetch_add_explicit(&async_delivered, n, memory_order_relaxed);
+    }
+}
+
+#ifndef _WIN32
+/**
+ * @brief Dispatcher thread: sleep until events arrive, then drain
+ */
+static void* dispatcher_main(void* arg) {
+    (void)arg;
+    on_dispatcher_thread = 1;
+    
+    while (atomic_load(&async_running)) {
+        if (sem_wait(&dispatcher_wake) != 0) {
+            continue;  /* EINTR */
+        }
+        /* One wakeup drains everything queued so far */
+        while (sem_trywait(&dispatcher_wake) == 0) {
+        }
+        async_drain();
+    }
+    
+    async_drain();
+    return NULL;
+}
+#endif
+
+/**
+ * @brief Start the async dispatcher thread
+ */
+int handler_async_start(size_t capacity, handler_backpressure_t policy) {
+#ifdef _WIN32
+    (void)capacity;
+    (void)policy;
+    fprintf(stderr, "[Handler] Async dispatch not supported on this platform\n");
+    return -1;
+#else
+    size_t size = 2;
+    size_t i;
+    
+    if (atomic_load(&async_running)) {
+        return 0;
+    }
+    
+    if (capacity == 0) {
+        capacity = HANDLER_ASYNC_DEFAULT_CAPACITY;
+    }
+    while (size < capacity) {
+        size <<= 1;
+    }
+    
+    queue_slots = (event_queue_slot_t*)calloc(size, sizeof(event_queue_slot_t));
+    if (queue_slots == NULL) {
+        return -1;
+    }
+    for (i = 0; i < size; i++) {
+        atomic_init(&queue_slots[i].seq, i);
+    }
+    queue_mask = size - 1;
+    queue_policy = policy;
+    atomic_store(&queue_head, 0);
+    atomic_store(&queue_tail, 0);
+    atomic_store(&async_queued, 0);
+    atomic_store(&async_delivered, 0);
+    atomic_store(&async_dropped, 0);
+    
+    if (sem_init(&dispatcher_wake, 0, 0) != 0) {
+        free(queue_slots);
+        queue_slots = NULL;
+        return -1;
+    }
+    
+    atomic_store(&async_running, 1);
+    if (pthread_create(&dispatcher_thread, NULL, dispatcher_main, NULL) != 0) {
+        atomic_store(&async_running, 0);
+        sem_destroy(&dispatcher_wake);
+        free(queue_slots);
+        queue_slots = NULL;
+        return -1;
+    }
+    
+    return 0;
+#endif
+}
+
+/**
+ * @brief Stop the async dispatcher thread
+ */
+void handler_async_stop(void) {
+#ifndef _WIN32
+    if (!atomic_load(&async_running)) {
+        return;
+    }
+    
+    atomic_store(&async_running, 0);
+    sem_post(&dispatcher_wake);
+    pthread_join(dispatcher_thread, NULL);
+    
+    /* Deliver anything queued after the thread's final drain */
+    async_drain();
+    
+    sem_destroy(&dispatcher_wake);
+    free(queue_slots);
+    queue_slots = NULL;
+    queue_mask = 0;
+#endif
+}
+
+/**
+ * @brief Check if the async dispatcher thread is running
+ */
+int handler_async_is_running(void) {
+    return atomic_load(&async_running);
+}
+
+/**
+ * @brief Wait until every queued event has been delivered
+ */
+void handler_async_flush(void) {
+    if (!atomic_load(&async_running) || on_dispatcher_thread) {
+        return;
+    }
+    
+    while (atomic_load(&queue_head) != atomic_load(&queue_tail) ||
+           atomic_load(&dispatcher_busy)) {
+#ifndef _WIN32
+        sched_yield();
+#endif
+    }
+}
+
+/**
+ * @brief Get async dispatch counters
+ */
+void handler_async_get_stats(handler_async_stats_t* stats) {
+    if (stats == NULL) {
+        return;
+    }
+    
+    stats->queued = atomic_load(&async_queued);
+    stats->delivered = atomic_load(&async_delivered);
+    stats->dropped = atomic_load(&async_dropped);
+    stats->depth = (uint32_t)(atomic_load(&queue_tail) - atomic_load(&queue_head));
+}
+
+/**
+ * @brief Deliver an event to every subscriber of its type
+ */
+int event_publish(event_t* event) {
+    event_subscription_t snapshot[EVENT_BUS_MAX_SUBSCRIBERS];
+    int async_count;
+    int queue_async;
+    int result = 0;
+    int count;
+    int i;
+    
+    if (event == NULL || (unsigned int)event->type >= EVENT_TYPE_COUNT) {
+        return -1;
+    }
+    
+    if (bus_count(event->type) == 0) {
+        return 0;
+    }
+    
+    /* Copy first so subscribers may unsubscribe (or subscribe) while running */
+    count = bus_snapshot(event->type, snapshot, &async_count);
+    
+    if (event->timestamp == 0) {
+        event->timestamp = get_timestamp();
+    }
+    
+    /* Without a dispatcher (or on it), async subscribers run inline */
+    queue_async = async_count > 0 && atomic_load_explicit(&async_running, memory_order_relaxed) &&
+                  !on_dispatcher_thread;
+    
+    for (i = 0; i < count; i++) {
+        int r;
+        
+        if (snapshot[i].async && queue_async) {
+            continue;
+        }
+        r = snapshot[i].callback(event, snapshot[i].context);
+        if (r != 0 && result == 0) {
+            result = r;
+        }
+    }
+    
+    if (queue_async) {
+        async_enqueue(event);
+    }
+    
+    return result;
+}
+
+/* ============================================================================
+ * LEGACY SINGLE-SLOT HANDLERS
+ * ============================================================================ */
+
+static int legacy_button_pressed(const event_t* event, void* context) {
+    (void)context;
+    return registered_handlers.button_pressed ?
+           registered_handlers.button_pressed(event->data.button.button_code,
+                                              event->data.button.button_name) : 0;
+}
+
+static int legacy_button_released(const event_t* event, void* context) {
+    (void)context;
+    return registered_handlers.button_released ?
+           registered_handlers.button_released(event->data.button.button_code,
+                                               event->data.button.button_name) : 0;
+}
+
+static int legacy_ir_transmit_start(const event_t* event, void* context) {
+    (void)context;
+    return registered_handlers.ir_transmit_start ?
+           registered_handlers.ir_transmit_start(event->data.ir_transmit.code,
+                                                 event->data.ir_transmit.success) : 0;
+}
+
+static int legacy_ir_transmit_complete(const event_t* event, void* context) {
+    (void)context;
+    return registered_handlers.ir_transmit_complete ?
+           registered_handlers.ir_transmit_complete(event->data.ir_transmit.code,
+                                                    event->data.ir_transmit.success) : 0;
+}
+
+static int legacy_ir_transmit_error(const event_t* event, void* context) {
+    (void)context;
+    return registered_handlers.ir_transmit_error ?
+           registered_handlers.ir_transmit_error(event->data.ir_transmit.code,
+                                                 event->data.ir_transmit.success) : 0;
+}
+
+static int legacy_error(const event_t* event, void* context) {
+    (void)context;
+    return registered_handlers.error_handler ?
+           registered_handlers.error_handler(event->data.error.error, event->data.error.message) : 0;
+}
+
+static int legacy_state_changed(const event_t* event, void* context) {
+    (void)event;
+    (void)context;
+    return registered_handlers.state_changed ? registered_handlers.state_changed() : 0;
+}
+
+static int legacy_interrupt(const event_t* event, void* context) {
+    (void)event;
+    (void)context;
+    if (registered_handlers.interrupt_handler) {
+        registered_handlers.interrupt_handler();
+    }
+    return 0;
+}
+
+static int legacy_universal_scan_started(const event_t* event, void* context) {
+    (void)context;
+    return registered_handlers.universal_scan_started ?
+           registered_handlers.universal_scan_started(event->data.universal_scan.button_code,
+                                                      event->data.universal_scan.code_index,
+                                                      event->data.universal_scan.total_codes) : 0;
+}
+
+static int legacy_universal_scan_next(const event_t* event, void* context) {
+    (void)context;
+    return registered_handlers.universal_scan_next ?
+           registered_handlers.universal_scan_next(event->data.universal_scan.button_code,
+                                                   event->data.universal_scan.code_index,
+                                                   event->data.universal_scan.total_codes) : 0;
+}
+
+static int legacy_universal_scan_confirmed(const event_t* event, void* context) {
+    (void)context;
+    return registered_handlers.universal_scan_confirmed ?
+           registered_handlers.universal_scan_confirmed(event->data.universal_scan.button_code,
+                                                        event->data.universal_scan.code_index,
+                                                        event->data.universal_scan.total_codes) : 0;
+}
+
+static int legacy_universal_protocol_attempt(const event_t* event, void* context) {
+    (void)context;
+    return registered_handlers.universal_protocol_attempt ?
+           registered_handlers.universal_protocol_attempt(event->data.universal_protocol.protocol,
+                                                          event->data.universal_protocol.code,
+                                                          event->data.universal_protocol.description) : 0;
+}
+
+static int legacy_universal_brand_detected(const event_t* event, void* context) {
+    (void)context;
+    return registered_handlers.universal_brand_detected ?
+           registered_handlers.universal_brand_detected(event->data.universal_brand.brand,
+                                                        event->data.universal_brand.brand_name) : 0;
+}
+
+/**
+ * @brief Keep the bus subscription of one handlers_t slot in sync
+ * @param type Event type of the slot
+ * @param adapter Forwarding subscriber for the slot
+ * @param set Non-zero if the slot holds a handler
+ *
+ * A slot owns exactly one subscription, so registering a new handler for
+ * it replaces the previous one without touching other subscribers.
+ */
+static int legacy_sync(event_type_t type, event_subscriber_t adapter, int set) {
+    if (set && legacy_tokens[type] == EVENT_TOKEN_INVALID) {
+        legacy_tokens[type] = event_subscribe(type, adapter, NULL, EVENT_PRIORITY_DEFAULT);
+        return legacy_tokens[type] != EVENT_TOKEN_INVALID ? 0 : -1;
+    }
+    if (!set && legacy_tokens[type] != EVENT_TOKEN_INVALID) {
+        event_unsubscribe(legacy_tokens[type]);
+        legacy_tokens[type] = EVENT_TOKEN_INVALID;
+    }
+    return 0;
+}
+
+/**
+ * @brief Sync every handlers_t slot with the bus
+ */
+static int legacy_sync_all(void) {
+    int result = 0;
+    
+    result |= legacy_sync(EVENT_BUTTON_PRESSED, legacy_button_pressed,
+                          registered_handlers.button_pressed != NULL);
+    result |= legacy_sync(EVENT_BUTTON_RELEASED, legacy_button_released,
+                          registered_handlers.button_released != NULL);
+    result |= legacy_sync(EVENT_IR_TRANSMIT_START, legacy_ir_transmit_start,
+                          registered_handlers.ir_transmit_start != NULL);
+    result |= legacy_sync(EVENT_IR_TRANSMIT_COMPLETE, legacy_ir_transmit_complete,
+                          registered_handlers.ir_transmit_complete != NULL);
+    result |= legacy_sync(EVENT_IR_TRANSMIT_ERROR, legacy_ir_transmit_error,
+                          registered_handlers.ir_transmit_error != NULL);
+    result |= legacy_sync(EVENT_ERROR, legacy_error,
+                          registered_handlers.error_handler != NULL);
+    result |= legacy_sync(EVENT_STATE_CHANGED, legacy_state_changed,
+                          registered_handlers.state_changed != NULL);
+    result |= legacy_sync(EVENT_HARDWARE_INTERRUPT, legacy_interrupt,
+                          registered_handlers.interrupt_handler != NULL);
+    result |= legacy_sync(EVENT_UNIVERSAL_SCAN_STARTED, legacy_universal_scan_started,
+                          registered_handlers.universal_scan_started != NULL);
+    result |= legacy_sync(EVENT_UNIVERSAL_SCAN_NEXT, legacy_universal_scan_next,
+                          registered_handlers.universal_scan_next != NULL);
+    result |= legacy_sync(EVENT_UNIVERSAL_SCAN_CONFIRMED, legacy_universal_scan_confirmed,
+                          registered_handlers.universal_scan_confirmed != NULL);
+    result |= legacy_sync(EVENT_UNIVERSAL_PROTOCOL_ATTEMPT, legacy_universal_protocol_attempt,
+                          registered_handlers.universal_protocol_attempt != NULL);
+    result |= legacy_sync(EVENT_UNIVERSAL_BRAND_DETECTED, legacy_universal_brand_detected,
+                          registered_handlers.universal_brand_detected != NULL);
+    
+    return result ? -1 : 0;
+}
+
+/* ============================================================================
+ * REGISTRATION
+ * ============================================================================ */
+
 /**
  * @brief Initialize handler system
  */
@@ -37,6 +822,10 @@ int handler_init(void) {
     
     /* Clear all handlers */
     memset(&registered_handlers, 0, sizeof(handlers_t));
+    BUS_WRITER_LOCK();
+    bus_clear();
+    BUS_WRITER_UNLOCK();
+    memset(legacy_tokens, 0, sizeof(legacy_tokens));
     
     handlers_initialized = 1;
     return 0;
@@ -50,7 +839,17 @@ void handler_cleanup(void) {
         return;
     }
     
+    handler_stop_timer();
+    interrupt_worker_stop();
+    handler_async_stop();
     handler_unregister_all();
+    
+    /* Drop this module's wheel user; the wheel stops once no other user
+     * (such as async connection requests) still holds it */
+    if (timer_wheel_acquired) {
+        timer_wheel_acquired = 0;
+        timer_wheel_cleanup();
+    }
     handlers_initialized = 0;
 }
 
@@ -63,7 +862,7 @@ int handler_register_button_pressed(button_handler_t handler) {
     }
     
     registered_handlers.button_pressed = handler;
-    return 0;
+    return legacy_sync(EVENT_BUTTON_PRESSED, legacy_button_pressed, handler != NULL);
 }
 
 /**
@@ -75,7 +874,7 @@ int handler_register_button_released(button_handler_t handler) {
     }
     
     registered_handlers.button_released = handler;
-    return 0;
+    return legacy_sync(EVENT_BUTTON_RELEASED, legacy_button_released, handler != NULL);
 }
 
 /**
@@ -87,7 +886,7 @@ int handler_register_ir_transmit_start(ir_handler_t handler) {
     }
     
     registered_handlers.ir_transmit_start = handler;
-    return 0;
+    return legacy_sync(EVENT_IR_TRANSMIT_START, legacy_ir_transmit_start, handler != NULL);
 }
 
 /**
@@ -99,7 +898,7 @@ int handler_register_ir_transmit_complete(ir_handler_t handler) {
     }
     
     registered_handlers.ir_transmit_complete = handler;
-    return 0;
+    return legacy_sync(EVENT_IR_TRANSMIT_COMPLETE, legacy_ir_transmit_complete, handler != NULL);
 }
 
 /**
@@ -111,7 +910,7 @@ int handler_register_ir_transmit_error(ir_handler_t handler) {
     }
     
     registered_handlers.ir_transmit_error = handler;
-    return 0;
+    return legacy_sync(EVENT_IR_TRANSMIT_ERROR, legacy_ir_transmit_error, handler != NULL);
 }
 
 /**
@@ -123,7 +922,7 @@ int handler_register_error(error_handler_t handler) {
     }
     
     registered_handlers.error_handler = handler;
-    return 0;
+    return legacy_sync(EVENT_ERROR, legacy_error, handler != NULL);
 }
 
 /**
@@ -135,7 +934,7 @@ int handler_register_state_changed(state_handler_t handler) {
     }
     
     registered_handlers.state_changed = handler;
-    return 0;
+    return legacy_sync(EVENT_STATE_CHANGED, legacy_state_changed, handler != NULL);
 }
 
 /**
@@ -172,7 +971,7 @@ int handler_register_interrupt(interrupt_handler_t handler) {
     
     registered_handlers.interrupt_handler = handler;
     interrupt_callback_storage = handler;  /* Store for assembly callback */
-    return 0;
+    return legacy_sync(EVENT_HARDWARE_INTERRUPT, legacy_interrupt, handler != NULL);
 }
 
 /**
@@ -188,7 +987,7 @@ int handler_register_all(handlers_t* handlers) {
     }
     
     registered_handlers = *handlers;
-    return 0;
+    return legacy_sync_all();
 }
 
 /**
@@ -196,6 +995,10 @@ int handler_register_all(handlers_t* handlers) {
  */
 void handler_unregister_all(void) {
     memset(&registered_handlers, 0, sizeof(handlers_t));
+    BUS_WRITER_LOCK();
+    bus_clear();
+    BUS_WRITER_UNLOCK();
+    memset(legacy_tokens, 0, sizeof(legacy_tokens));
 }
 
 /* Universal TV Handler Registration Functions */
@@ -205,7 +1008,7 @@ int handler_register_universal_scan_started(universal_scan_handler_t handler) {
         handler_init();
     }
     registered_handlers.universal_scan_started = handler;
-    return 0;
+    return legacy_sync(EVENT_UNIVERSAL_SCAN_STARTED, legacy_universal_scan_started, handler != NULL);
 }
 
 int handler_register_universal_scan_next(universal_scan_handler_t handler) {
@@ -213,7 +1016,7 @@ int handler_register_universal_scan_next(universal_scan_handler_t handler) {
         handler_init();
     }
     registered_handlers.universal_scan_next = handler;
-    return 0;
+    return legacy_sync(EVENT_UNIVERSAL_SCAN_NEXT, legacy_universal_scan_next, handler != NULL);
 }
 
 int handler_register_universal_scan_confirmed(universal_scan_handler_t handler) {
@@ -221,7 +1024,7 @@ int handler_register_universal_scan_confirmed(universal_scan_handler_t handler)
         handler_init();
     }
     registered_handlers.universal_scan_confirmed = handler;
-    return 0;
+    return legacy_sync(EVENT_UNIVERSAL_SCAN_CONFIRMED, legacy_universal_scan_confirmed, handler != NULL);
 }
 
 int handler_register_universal_protocol_attempt(universal_protocol_handler_t handler) {
@@ -229,7 +1032,7 @@ int handler_register_universal_protocol_attempt(universal_protocol_handler_t han
         handler_init();
     }
     registered_handlers.universal_protocol_attempt = handler;
-    return 0;
+    return legacy_sync(EVENT_UNIVERSAL_PROTOCOL_ATTEMPT, legacy_universal_protocol_attempt, handler != NULL);
 }
 
 int handler_register_universal_brand_detected(universal_brand_handler_t handler) {
@@ -237,173 +1040,188 @@ int handler_register_universal_brand_detected(universal_brand_handler_t handler)
         handler_init();
     }
     registered_handlers.universal_brand_detected = handler;
-    return 0;
+    return legacy_sync(EVENT_UNIVERSAL_BRAND_DETECTED, legacy_universal_brand_detected, handler != NULL);
 }
 
+/* ============================================================================
+ * EVENT TRIGGERS
+ * ============================================================================ */
+
 /* Universal TV Event Trigger Functions */
 
 int handler_trigger_universal_scan_started(unsigned char button_code, uint16_t total_codes) {
+    event_t event = { .type = EVENT_UNIVERSAL_SCAN_STARTED };
+    
     if (!handlers_initialized) {
         return -1;
     }
     
-    if (registered_handlers.universal_scan_started != NULL) {
-        return registered_handlers.universal_scan_started(button_code, 0, total_codes);
-    }
-    
-    return 0;
+    event.data.universal_scan.button_code = button_code;
+    event.data.universal_scan.code_index = 0;
+    event.data.universal_scan.total_codes = total_codes;
+    return event_publish(&event);
 }
 
 int handler_trigger_universal_scan_next(unsigned char button_code, uint16_t code_index, uint16_t total_codes) {
+    event_t event = { .type = EVENT_UNIVERSAL_SCAN_NEXT };
+    
     if (!handlers_initialized) {
         return -1;
     }
     
-    if (registered_handlers.universal_scan_next != NULL) {
-        return registered_handlers.universal_scan_next(button_code, code_index, total_codes);
-    }
-    
-    return 0;
+    event.data.universal_scan.button_code = button_code;
+    event.data.universal_scan.code_index = code_index;
+    event.data.universal_scan.total_codes = total_codes;
+    return event_publish(&event);
 }
 
 int handler_trigger_universal_scan_confirmed(unsigned char button_code, uint16_t code_index, uint16_t total_codes) {
+    event_t event = { .type = EVENT_UNIVERSAL_SCAN_CONFIRMED };
+    
     if (!handlers_initialized) {
         return -1;
     }
     
-    if (registered_handlers.universal_scan_confirmed != NULL) {
-        return registered_handlers.universal_scan_confirmed(button_code, code_index, total_codes);
-    }
-    
-    return 0;
+    event.data.universal_scan.button_code = button_code;
+    event.data.universal_scan.code_index = code_index;
+    event.data.universal_scan.total_codes = total_codes;
+    return event_publish(&event);
 }
 
 int handler_trigger_universal_protocol_attempt(uint8_t protocol, uint32_t code, const char* description) {
+    event_t event = { .type = EVENT_UNIVERSAL_PROTOCOL_ATTEMPT };
+    
     if (!handlers_initialized) {
         return -1;
     }
     
-    if (registered_handlers.universal_protocol_attempt != NULL) {
-        return registered_handlers.universal_protocol_attempt(protocol, code, description);
-    }
-    
-    return 0;
+    event.data.universal_protocol.protocol = protocol;
+    event.data.universal_protocol.code = code;
+    event.data.universal_protocol.description = description;
+    return event_publish(&event);
 }
 
 int handler_trigger_universal_brand_detected(uint8_t brand, const char* brand_name) {
+    event_t event = { .type = EVENT_UNIVERSAL_BRAND_DETECTED };
+    
     if (!handlers_initialized) {
         return -1;
     }
     
-    if (registered_handlers.universal_brand_detected != NULL) {
-        return registered_handlers.universal_brand_detected(brand, brand_name);
-    }
-    
-    return 0;
-}
-
-/**
- * @brief Get current timestamp in milliseconds
- */
-static uint32_t get_timestamp(void) {
-#ifdef _WIN32
-    return (uint32_t)GetTickCount();
-#else
-    struct timespec ts;
-    clock_gettime(CLOCK_MONOTONIC, &ts);
-    return (uint32_t)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
-#endif
+    event.data.universal_brand.brand = brand;
+    event.data.universal_brand.brand_name = brand_name;
+    return event_publish(&event);
 }
 
 /**
  * @brief Trigger button press event
  */
 int handler_trigger_button_pressed(unsigned char button_code) {
+    event_t event = { .type = EVENT_BUTTON_PRESSED };
+    
     if (!handlers_initialized) {
         return -1;
     }
     
-    if (registered_handlers.button_pressed != NULL) {
-        const char* button_name = get_button_name(button_code);
-        return registered_handlers.button_pressed(button_code, button_name);
+    if (bus_count(EVENT_BUTTON_PRESSED) == 0) {
+        return 0;
     }
     
-    return 0;
+    event.data.button.button_code = button_code;
+    event.data.button.button_name = get_button_name(button_code);
+    return event_publish(&event);
 }
 
 /**
  * @brief Trigger button release event
  */
 int handler_trigger_button_released(unsigned char button_code) {
+    event_t event = { .type = EVENT_BUTTON_RELEASED };
+    
     if (!handlers_initialized) {
         return -1;
     }
     
-    if (registered_handlers.button_released != NULL) {
-        const char* button_name = get_button_name(button_code);
-        return registered_handlers.button_released(button_code, button_name);
+    if (bus_count(EVENT_BUTTON_RELEASED) == 0) {
+        return 0;
     }
     
-    return 0;
+    event.data.button.button_code = button_code;
+    event.data.button.button_name = get_button_name(button_code);
+    return event_publish(&event);
 }
 
 /**
  * @brief Trigger IR transmission start event
  */
 int handler_trigger_ir_transmit_start(ir_code_t code) {
+    event_t event = { .type = EVENT_IR_TRANSMIT_START };
+    
     if (!handlers_initialized) {
         return -1;
     }
     
-    if (registered_handlers.ir_transmit_start != NULL) {
-        return registered_handlers.ir_transmit_start(code, 0);
-    }
-    
-    return 0;
+    event.data.ir_transmit.code = code;
+    event.data.ir_transmit.success = 0;
+    return event_publish(&event);
 }
 
 /**
  * @brief Trigger IR transmission complete event
  */
 int handler_trigger_ir_transmit_complete(ir_code_t code, int success) {
+    event_t event = { .type = success ? EVENT_IR_TRANSMIT_COMPLETE : EVENT_IR_TRANSMIT_ERROR };
+    
     if (!handlers_initialized) {
         return -1;
     }
     
-    if (success) {
-        if (registered_handlers.ir_transmit_complete != NULL) {
-            return registered_handlers.ir_transmit_complete(code, success);
-        }
-    } else {
-        if (registered_handlers.ir_transmit_error != NULL) {
-            return registered_handlers.ir_transmit_error(code, success);
-        }
+    event.data.ir_transmit.code = code;
+    event.data.ir_transmit.success = success;
+    return event_publish(&event);
+}
+
+/**
+ * @brief Trigger state change event
+ */
+int handler_trigger_state_changed(void) {
+    event_t event = { .type = EVENT_STATE_CHANGED };
+    
+    if (!handlers_initialized) {
+        return -1;
     }
     
-    return 0;
+    return event_publish(&event);
 }
 
 /**
  * @brief Trigger error event
  */
 int handler_trigger_error(error_type_t error, const char* message) {
+    event_t event = { .type = EVENT_ERROR };
+    
     if (!handlers_initialized) {
         return -1;
     }
     
-    if (registered_handlers.error_handler != NULL) {
-        return registered_handlers.error_handler(error, message);
+    if (bus_count(EVENT_ERROR) == 0) {
+        /* Default error handling */
+        fprintf(stderr, "[Handler] Error %d: %s\n", error, message ? message : "Unknown error");
+        return 0;
     }
     
-    /* Default error handling */
-    fprintf(stderr, "[Handler] Error %d: %s\n", error, message ? message : "Unknown error");
-    return 0;
+    event.data.error.error = error;
+    event.data.error.message = message;
+    return event_publish(&event);
 }
 
 /**
  * @brief Trigger custom event
  */
 int handler_trigger_custom_event(event_t* event) {
+    int result = 0;
+    int bus_result;
+    
     if (!handlers_initialized) {
         return -1;
     }
@@ -418,10 +1236,12 @@ int handler_trigger_custom_event(event_t* event) {
     }
     
     if (registered_handlers.custom_event != NULL) {
-        return registered_handlers.custom_event(event);
+        result = registered_handlers.custom_event(event);
     }
     
-    return 0;
+    /* Subscribers of the event's own type see custom events too */
+    bus_result = event_publish(event);
+    return result != 0 ? result : bus_result;
 }
 
 #ifdef _WIN32
@@ -432,42 +1252,40 @@ int handler_trigger_custom_event(event_t* event) {
 
 /* Timer and Interrupt Handler Support */
 
-static timer_handler_t timer_callback = NULL;
-
 #ifdef _WIN32
 static HANDLE timer_handle = NULL;
 #else
-static struct itimerval timer_value;
-static struct sigaction sa;
+static timer_id_t timer_id = TIMER_ID_INVALID;
 #endif
 
 /**
- * @brief Timer interrupt handler (platform-specific)
+ * @brief Timer expiration (runs on the timer thread, never in signal context)
  */
 #ifdef _WIN32
 static VOID CALLBACK timer_callback_wrapper(PVOID lpParam, BOOLEAN TimerOrWaitFired) {
     (void)lpParam;
     (void)TimerOrWaitFired;
-    if (timer_callback != NULL) {
-        timer_callback(0);
+    if (registered_handlers.timer_handler != NULL) {
+        registered_handlers.timer_handler(0);
     }
 }
 #else
-static void timer_signal_handler(int sig) {
-    (void)sig;
-    if (timer_callback != NULL) {
-        timer_callback(0);
+static int timer_expired(timer_id_t id, void* context) {
+    (void)context;
+    if (registered_handlers.timer_handler != NULL) {
+        registered_handlers.timer_handler(id);
     }
+    return 0;
 }
 #endif
 
 /**
- * @brief Setup hardware timer
+ * @brief Setup periodic timer
  * @param interval_ms Timer interval in milliseconds
  * @return 0 on success, -1 on failure
  */
 int handler_setup_timer(uint32_t interval_ms) {
-    if (timer_callback == NULL) {
+    if (registered_handlers.timer_handler == NULL || interval_ms == 0) {
         return -1;
     }
     
@@ -482,21 +1300,20 @@ int handler_setup_timer(uint32_t interval_ms) {
         return -1;
     }
 #else
-    /* Unix/Linux: Use setitimer */
-    sa.sa_handler = timer_signal_handler;
-    sigemptyset(&sa.sa_mask);
-    sa.sa_flags = 0;
-    
-    if (sigaction(SIGALRM, &sa, NULL) == -1) {
+    /* Unix/Linux: One periodic timer on the shared timer wheel */
+    if (!timer_wheel_acquired) {
+        if (timer_wheel_init(0) != 0) {
+            return -1;
+        }
+        timer_wheel_acquired = 1;
+    }
+    if (timer_wheel_start() != 0) {
         return -1;
     }
     
-    timer_value.it_value.tv_sec = interval_ms / 1000;
-    timer_value.it_value.tv_usec = (interval_ms % 1000) * 1000;
-    timer_value.it_interval.tv_sec = interval_ms / 1000;
-    timer_value.it_interval.tv_usec = (interval_ms % 1000) * 1000;
-    
-    if (setitimer(ITIMER_REAL, &timer_value, NULL) == -1) {
+    handler_stop_timer();
+    timer_id = timer_wheel_add(interval_ms, interval_ms, timer_expired, NULL);
+    if (timer_id == TIMER_ID_INVALID) {
         return -1;
     }
 #endif
@@ -505,7 +1322,7 @@ int handler_setup_timer(uint32_t interval_ms) {
 }
 
 /**
- * @brief Stop hardware timer
+ * @brief Stop periodic timer
  */
 void handler_stop_timer(void) {
 #ifdef _WIN32
@@ -514,11 +1331,10 @@ void handler_stop_timer(void) {
         timer_handle = NULL;
     }
 #else
-    timer_value.it_value.tv_sec = 0;
-    timer_value.it_value.tv_usec = 0;
-    timer_value.it_interval.tv_sec = 0;
-    timer_value.it_interval.tv_usec = 0;
-    setitimer(ITIMER_REAL, &timer_value, NULL);
+    if (timer_id != TIMER_ID_INVALID) {
+        timer_wheel_cancel(timer_id);
+        timer_id = TIMER_ID_INVALID;
+    }
 #endif
 }
 
@@ -547,6 +1363,30 @@ static volatile uint32_t interrupt_timestamp = 0;
 static volatile int interrupt_type = 0; /* 0 = timer, 1 = GPIO */
 static volatile unsigned char pending_button_code = 0; /* Button code from hardware interrupt */
 
+/* Top half -> bottom half queue entry */
+typedef struct {
+    uint64_t timestamp_ns;          /* Interrupt entry time */
+    uint32_t dwell_ns;              /* Time spent in the top half */
+    uint8_t type;                   /* 0 = timer, 1 = GPIO */
+    uint8_t button_code;            /* GPIO button (0 for timer) */
+} interrupt_entry_t;
+
+/* Single-producer (top half) / single-consumer (bottom half) ring */
+static interrupt_entry_t interrupt_queue[INTERRUPT_QUEUE_SIZE];
+static _Atomic uint32_t interrupt_head = 0;     /* Written by the top half */
+static _Atomic uint32_t interrupt_tail = 0;     /* Written by the bottom half */
+static _Atomic uint64_t interrupt_dropped = 0;
+static _Atomic int interrupt_draining = 0;      /* Bottom half owner */
+static _Atomic uint64_t interrupt_processed = 0;      /* Written by the bottom half */
+static _Atomic uint64_t interrupt_max_dwell_ns = 0;   /* Written by the bottom half */
+
+static _Atomic int interrupt_worker_running = 0;
+static _Atomic int interrupt_posting = 0;       /* Top halves that may sem_post() */
+#ifndef _WIN32
+static pthread_t interrupt_worker_thread;
+static sem_t interrupt_wake;
+#endif
+
 /**
  * @brief Read GPIO state to detect button press (platform-specific)
  * @return Button code or 0 if no button pressed
@@ -578,49 +1418,264 @@ void interrupt_set_button(unsigned char button_code) {
     pending_button_code = button_code;
 }
 
+/**
+ * @brief Publish EVENT_HARDWARE_INTERRUPT to its subscribers
+ */
+static void interrupt_publish(void) {
+    event_t event = { .type = EVENT_HARDWARE_INTERRUPT };
+    
+    if (handlers_initialized) {
+        event_publish(&event);
+    }
+}
+
+/**
+ * @brief Record an interrupt latency under a lazily registered operation
+ */
+static void interrupt_record(_Atomic latency_op_t* op, const char* name,
+                             uint64_t latency_ns, uint32_t code, uint64_t timestamp_ns) {
+    latency_op_t id = atomic_load_explicit(op, memory_order_relaxed);
+    
+    if (id == LATENCY_OP_INVALID) {
+        id = latency_register_op(name);
+        atomic_store_explicit(op, id, memory_order_relaxed);
+    }
+    latency_record_op_ns(id, latency_ns, code, timestamp_ns);
+}
+
 /**
  * @brief C callback function for interrupt handlers (called from assembly)
- * This bridges hardware interrupts (assembly) -> C handlers -> JavaScript (via WebSocket)
+ *
+ * Top half: runs in interrupt context, so it only identifies the source,
+ * timestamps it and queues it for interrupt_process_deferred(). No I/O,
+ * no locks, no handler calls.
  */
 void interrupt_callback(void) {
+    uint64_t start = latency_get_timestamp_ns();
+    uint32_t head = atomic_load_explicit(&interrupt_head, memory_order_relaxed);
+    unsigned char button_code = 0;
+    interrupt_entry_t* entry;
+    
+    trace_begin("interrupt_callback", interrupt_type);
+    
     /* Get current timestamp */
     interrupt_timestamp = (uint32_t)time(NULL);
     
     /* Check if this is a GPIO interrupt (button press) */
     if (interrupt_type == 1) {
         /* Read GPIO state to detect which button was pressed */
-        unsigned char button_code = read_gpio_button_state();
-        
-        if (button_code != 0 && button_code != last_gpio_state) {
-            /* Button press detected - trigger C command chain */
-            printf("[Interrupt] Button press detected: 0x%02X\n", button_code);
+        button_code = read_gpio_button_state();
+        if (button_code == 0 || button_code == last_gpio_state) {
+            trace_end("interrupt_callback");
+            return;
+        }
+        last_gpio_state = button_code;
+    }
+    
+    if (head - atomic_load_explicit(&interrupt_tail, memory_order_acquire) >= INTERRUPT_QUEUE_SIZE) {
+        atomic_fetch_add_explicit(&interrupt_dropped, 1, memory_order_relaxed);
+        trace_end("interrupt_callback");
+        return;
+    }
+    
+    entry = &interrupt_queue[head & (INTERRUPT_QUEUE_SIZE - 1)];
+    entry->timestamp_ns = start;
+    entry->type = (uint8_t)interrupt_type;
+    entry->button_code = button_code;
+    entry->dwell_ns = (uint32_t)(latency_get_timestamp_ns() - start);
+    atomic_store_explicit(&interrupt_head, head + 1, memory_order_release);
+    
+#ifndef _WIN32
+    /* Announce the post before checking the flag, so that
+     * interrupt_worker_stop() waits for it before destroying the semaphore */
+    atomic_fetch_add(&interrupt_posting, 1);
+    if (atomic_load(&interrupt_worker_running)) {
+        sem_post(&interrupt_wake);  /* Async-signal-safe */
+    }
+    atomic_fetch_sub(&interrupt_posting, 1);
+#endif
+    
+    trace_end("interrupt_callback");
+}
+
+/**
+ * @brief Bottom half for one queued interrupt
+ *
+ * Naming, logging, simulator forwarding and a single handler dispatch.
+ */
+static void interrupt_bottom_half(const interrupt_entry_t* entry) {
+    static _Atomic latency_op_t top_half_op = LATENCY_OP_INVALID;
+    static _Atomic latency_op_t queue_wait_op = LATENCY_OP_INVALID;
+    static _Atomic latency_op_t bottom_half_op = LATENCY_OP_INVALID;
+    uint64_t top_end = entry->timestamp_ns + entry->dwell_ns;
+    uint64_t begin = latency_get_timestamp_ns();
+    uint64_t end;
+    
+    trace_begin("interrupt_bottom_half", entry->button_code);
+    
+    if (entry->type == 1) {
+        /* Button press detected - trigger C command chain */
+        printf("[Interrupt] Button press detected: %s (0x%02X)\n",
+               get_button_name(entry->button_code), entry->button_code);
 #ifdef SIMULATOR
-            /* Send to TV simulator when using assembly ISR path (simulated GPIO) */
-            tv_simulator_send_button(button_code);
+        /* Send to TV simulator when using assembly ISR path (simulated GPIO) */
+        trace_begin("tv_simulator_send_button", entry->button_code);
+        tv_simulator_send_button(entry->button_code);
+        trace_end("tv_simulator_send_button");
 #endif
-            /* Trigger hardware interrupt event */
-            if (registered_handlers.interrupt_handler != NULL) {
-                registered_handlers.interrupt_handler();
-            }
-            
-            /* Trigger button press handler - this is the C command */
-            if (registered_handlers.button_pressed != NULL) {
-                const char* button_name = get_button_name(button_code);
-                registered_handlers.button_pressed(button_code, button_name);
-            }
-            
-            /* Also trigger via handler system for full event chain */
-            handler_trigger_button_pressed(button_code);
-            
-            /* Update last state */
-            last_gpio_state = button_code;
-        }
+        /* Trigger hardware interrupt event */
+        interrupt_publish();
+        
+        /* Trigger button press subscribers - this is the C command */
+        handler_trigger_button_pressed(entry->button_code);
     } else {
         /* Timer interrupt - handle IR timing */
-        if (registered_handlers.interrupt_handler != NULL) {
-            registered_handlers.interrupt_handler();
+        interrupt_publish();
+    }
+    
+    trace_end("interrupt_bottom_half");
+    end = latency_get_timestamp_ns();
+    
+    interrupt_record(&top_half_op, "isr_top_half", entry->dwell_ns, entry->button_code, top_end);
+    interrupt_record(&queue_wait_op, "isr_queue_wait", begin > top_end ? begin - top_end : 0,
+                     entry->button_code, begin);
+    interrupt_record(&bottom_half_op, "isr_bottom_half", end - begin, entry->button_code, end);
+    
+    /* Single consumer (interrupt_draining), so no read-modify-write race */
+    if (entry->dwell_ns > atomic_load_explicit(&interrupt_max_dwell_ns, memory_order_relaxed)) {
+        atomic_store_explicit(&interrupt_max_dwell_ns, entry->dwell_ns, memory_order_relaxed);
+    }
+    atomic_fetch_add_explicit(&interrupt_processed, 1, memory_order_relaxed);
+}
+
+/**
+ * @brief Run the bottom half for every queued interrupt
+ */
+int interrupt_process_deferred(void) {
+    int expected = 0;
+    uint32_t tail;
+    uint32_t head;
+    int count = 0;
+    
+    /* One consumer at a time (caller or worker thread) */
+    if (!atomic_compare_exchange_strong(&interrupt_draining, &expected, 1)) {
+        return 0;
+    }
+    
+    tail = atomic_load_explicit(&interrupt_tail, memory_order_relaxed);
+    head = atomic_load_explicit(&interrupt_head, memory_order_acquire);
+    
+    while (tail != head) {
+        interrupt_entry_t entry = interrupt_queue[tail & (INTERRUPT_QUEUE_SIZE - 1)];
+        
+        /* Free the slot before the (slow) bottom half runs */
+        tail++;
+        atomic_store_explicit(&interrupt_tail, tail, memory_order_release);
+        
+        interrupt_bottom_half(&entry);
+        count++;
+        
+        if (tail == head) {
+            head = atomic_load_explicit(&interrupt_head, memory_order_acquire);
+        }
+    }
+    
+    atomic_store(&interrupt_draining, 0);
+    return count;
+}
+
+#ifndef _WIN32
+/**
+ * @brief Deferred worker: sleep until the top half queues work, then drain
+ */
+static void* interrupt_worker_main(void* arg) {
+    (void)arg;
+    
+    while (atomic_load(&interrupt_worker_running)) {
+        if (sem_wait(&interrupt_wake) != 0) {
+            continue;  /* EINTR */
+        }
+        while (sem_trywait(&interrupt_wake) == 0) {
         }
+        interrupt_process_deferred();
     }
+    
+    return NULL;
+}
+#endif
+
+/**
+ * @brief Start a worker thread that runs the bottom half
+ */
+int interrupt_worker_start(void) {
+#ifdef _WIN32
+    fprintf(stderr, "[Interrupt] Deferred worker not supported on this platform\n");
+    return -1;
+#else
+    if (atomic_load(&interrupt_worker_running)) {
+        return 0;
+    }
+    
+    if (sem_init(&interrupt_wake, 0, 0) != 0) {
+        return -1;
+    }
+    
+    atomic_store(&interrupt_worker_running, 1);
+    if (pthread_create(&interrupt_worker_thread, NULL, interrupt_worker_main, NULL) != 0) {
+        atomic_store(&interrupt_worker_running, 0);
+        sem_destroy(&interrupt_wake);
+        return -1;
+    }
+    
+    /* Interrupts queued before the worker existed */
+    sem_post(&interrupt_wake);
+    return 0;
+#endif
+}
+
+/**
+ * @brief Stop the deferred worker thread
+ */
+void interrupt_worker_stop(void) {
+#ifndef _WIN32
+    if (!atomic_load(&interrupt_worker_running)) {
+        return;
+    }
+    
+    atomic_store(&interrupt_worker_running, 0);
+    sem_post(&interrupt_wake);
+    pthread_join(interrupt_worker_thread, NULL);
+    
+    /* A top half that saw the worker running may still be posting */
+    while (atomic_load(&interrupt_posting) != 0) {
+        sched_yield();
+    }
+    sem_destroy(&interrupt_wake);
+    
+    interrupt_process_deferred();
+#endif
+}
+
+/**
+ * @brief Check if the deferred worker thread is running
+ */
+int interrupt_worker_is_running(void) {
+    return atomic_load(&interrupt_worker_running);
+}
+
+/**
+ * @brief Get top half / bottom half counters
+ */
+void interrupt_get_stats(interrupt_stats_t* stats) {
+    if (stats == NULL) {
+        return;
+    }
+    
+    stats->queued = atomic_load(&interrupt_head);
+    stats->processed = atomic_load(&interrupt_processed);
+    stats->dropped = atomic_load(&interrupt_dropped);
+    stats->pending = atomic_load(&interrupt_head) - atomic_load(&interrupt_tail);
+    stats->max_dwell_ns = atomic_load(&interrupt_max_dwell_ns);
 }
 
 /**
@@ -637,4 +1692,3 @@ void interrupt_set_type(int type) {
 uint32_t interrupt_get_timestamp(void) {
     return interrupt_timestamp;
 }
-
@@ -29,7 +29,8 @@
  * @param us Number of microseconds to delay
  * 
  * This function provides microsecond-level precision required for IR protocols.
- * Implementation varies by platform (x86, ARM, AVR).
+ * Implementation varies by platform (x86, ARM, AVR). The C fallback sleeps
+ * through the active timebase backend (see timebase.h).
  */
 void delay_us(uint32_t us);
 
@@ -101,6 +102,25 @@ void ir_send_rc6(uint32_t code);
  */
 void ir_send_nec(uint32_t code);
 
+/**
+ * @brief Send NEC repeat frame (9ms pulse, 2.25ms space, 560us pulse)
+ * 
+ * Tells the receiver to repeat the last full NEC frame; used while a
+ * button is held instead of retransmitting the whole 32-bit frame.
+ */
+void ir_send_nec_repeat(void);
+
+/**
+ * @brief Send Sony SIRC protocol code
+ * @param code SIRC code (MSB-first notation, e.g. 0xA90)
+ * @param bit_length Frame length: 12, 15 or 20 bits (0 = 12)
+ * 
+ * Sends complete SIRC command:
+ * - Leader pulse (2.4ms)
+ * - Command and address bits (600us space + 1200us/600us pulse each)
+ */
+void ir_send_sony(uint32_t code, uint8_t bit_length);
+
 /**
  * @brief Send NEC protocol bit
  * @param bit Bit value (0 or 1)
@@ -1,4 +1,5 @@
 #include "../include/ir_codes.h"
+#include "../include/timebase.h"
 #include "ir_asm.h"
 #include <stdint.h>
 
@@ -37,56 +38,10 @@
 
 #if !USE_ASM_IR || defined(IR_USE_C_FALLBACK)
 
-#include <time.h>
-
-#ifdef _WIN32
-    #include <windows.h>
-    #ifndef LARGE_INTEGER
-    typedef struct {
-        long long QuadPart;
-    } LARGE_INTEGER;
-    #endif
-#elif defined(__linux__) || defined(__unix__)
-    #include <unistd.h>
-    #include <sys/time.h>
-#else
-    #include <unistd.h>
-#endif
-
-/* Simple delay using platform-specific functions */
+/* Delay through the active timebase (realtime or virtual clock) */
 void delay_us(uint32_t us) {
     if (us == 0) return;
-    
-#ifdef _WIN32
-    /* Windows: Use Sleep for milliseconds, QueryPerformanceCounter for microseconds */
-    if (us >= 1000) {
-        Sleep(us / 1000);
-        us = us % 1000;
-    }
-    if (us > 0) {
-        LARGE_INTEGER frequency, start, end;
-        QueryPerformanceFrequency(&frequency);
-        QueryPerformanceCounter(&start);
-        do {
-            QueryPerformanceCounter(&end);
-        } while (frequency.QuadPart > 0 && 
-                 (end.QuadPart - start.QuadPart) * 1000000 / frequency.QuadPart < us);
-    }
-#elif defined(__linux__) || defined(__unix__)
-    /* Linux/Unix: Use usleep (deprecated but available) or nanosleep */
-    if (us >= 1000) {
-        usleep(us);
-    } else {
-        struct timespec req, rem;
-        req.tv_sec = 0;
-        req.tv_nsec = us * 1000;  /* Convert microseconds to nanoseconds */
-        nanosleep(&req, &rem);
-    }
-#else
-    /* Generic: Busy wait (not precise) */
-    volatile uint32_t count = us * 100;  /* Approximate */
-    while (count--);
-#endif
+    timebase_sleep_us(us);
 }
 
 void ir_carrier_burst(uint32_t duration_us) {
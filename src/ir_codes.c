@@ -1,9 +1,13 @@
 #include "../include/ir_codes.h"
 #include "../include/remote_buttons.h"
+#include "../include/button_table.h"
 #include "../include/platform.h"
 #include "../include/handlers.h"
 #include "../include/io_mode.h"
 #include "../include/latency.h"
+#include "../include/ir_pulse.h"
+#include "../include/trace.h"
+#include "../include/timebase.h"
 #include "ir_asm.h"
 #include <stdio.h>
 #include <stdlib.h>
@@ -28,275 +32,19 @@ static int ir_initialized = 0;
 
 /**
  * @brief Get IR code for a button code
+ * 
+ * Single lookup in the static button table (see button_table.c).
+ * Undefined and simulator-only buttons return code 0.
  */
 ir_code_t get_ir_code(unsigned char button_code) {
+    const button_info_t* info = button_table_lookup(button_code);
     ir_code_t ir;
-    ir.protocol = IR_PROTOCOL_PHILLIPS;
+    
+    ir.code = info->ir_code;
+    ir.protocol = info->protocol ? info->protocol : IR_PROTOCOL_PHILLIPS;
     ir.frequency = 38000;  /* Standard IR frequency: 38kHz */
     ir.repeat_count = 1;
-    
-    /* Map button codes to IR codes */
-    switch (button_code) {
-        /* Streaming Services */
-        case BUTTON_YOUTUBE:
-            ir.code = IR_YOUTUBE;
-            break;
-        case BUTTON_NETFLIX:
-            ir.code = IR_NETFLIX;
-            break;
-        case BUTTON_AMAZON_PRIME:
-            ir.code = IR_AMAZON_PRIME;
-            break;
-        case BUTTON_HBO_MAX:
-            ir.code = IR_HBO_MAX;
-            break;
-        
-        /* Basic Controls */
-        case BUTTON_POWER:
-            ir.code = IR_POWER;
-            break;
-        case BUTTON_VOLUME_UP:
-            ir.code = IR_VOLUME_UP;
-            break;
-        case BUTTON_VOLUME_DOWN:
-            ir.code = IR_VOLUME_DOWN;
-            break;
-        case BUTTON_MUTE:
-            ir.code = IR_MUTE;
-            break;
-        case BUTTON_CHANNEL_UP:
-            ir.code = IR_CHANNEL_UP;
-            break;
-        case BUTTON_CHANNEL_DOWN:
-            ir.code = IR_CHANNEL_DOWN;
-            break;
-        
-        /* Navigation */
-        case BUTTON_HOME:
-            ir.code = IR_HOME;
-            break;
-        case BUTTON_MENU:
-            ir.code = IR_MENU;
-            break;
-        case BUTTON_BACK:
-            ir.code = IR_BACK;
-            break;
-        case BUTTON_EXIT:
-            ir.code = IR_EXIT;
-            break;
-        case BUTTON_OPTIONS:
-            ir.code = IR_OPTIONS;
-            break;
-        case BUTTON_INPUT:
-        case BUTTON_SOURCE:
-            ir.code = IR_INPUT;
-            break;
-        
-        /* Directional Pad */
-        case BUTTON_UP:
-            ir.code = IR_UP;
-            break;
-        case BUTTON_DOWN:
-            ir.code = IR_DOWN;
-            break;
-        case BUTTON_LEFT:
-            ir.code = IR_LEFT;
-            break;
-        case BUTTON_RIGHT:
-            ir.code = IR_RIGHT;
-            break;
-        case BUTTON_OK:
-            ir.code = IR_OK;
-            break;
-        case BUTTON_ENTER:
-            ir.code = IR_ENTER;
-            break;
-        
-        /* Playback Controls */
-        case BUTTON_PLAY:
-            ir.code = IR_PLAY;
-            break;
-        case BUTTON_PAUSE:
-            ir.code = IR_PAUSE;
-            break;
-        case BUTTON_STOP:
-            ir.code = IR_STOP;
-            break;
-        case BUTTON_FAST_FORWARD:
-            ir.code = IR_FAST_FORWARD;
-            break;
-        case BUTTON_REWIND:
-            ir.code = IR_REWIND;
-            break;
-        case BUTTON_RECORD:
-            ir.code = IR_RECORD;
-            break;
-        
-        /* Number Pad */
-        case BUTTON_0:
-            ir.code = IR_0;
-            break;
-        case BUTTON_1:
-            ir.code = IR_1;
-            break;
-        case BUTTON_2:
-            ir.code = IR_2;
-            break;
-        case BUTTON_3:
-            ir.code = IR_3;
-            break;
-        case BUTTON_4:
-            ir.code = IR_4;
-            break;
-        case BUTTON_5:
-            ir.code = IR_5;
-            break;
-        case BUTTON_6:
-            ir.code = IR_6;
-            break;
-        case BUTTON_7:
-            ir.code = IR_7;
-            break;
-        case BUTTON_8:
-            ir.code = IR_8;
-            break;
-        case BUTTON_9:
-            ir.code = IR_9;
-            break;
-        case BUTTON_DASH:
-            ir.code = IR_DASH;
-            break;
-        
-        /* Color Buttons */
-        case BUTTON_RED:
-            ir.code = IR_RED;
-            break;
-        case BUTTON_GREEN:
-            ir.code = IR_GREEN;
-            break;
-        case BUTTON_YELLOW:
-            ir.code = IR_YELLOW;
-            break;
-        case BUTTON_BLUE:
-            ir.code = IR_BLUE;
-            break;
-        
-        /* Advanced TV Controls */
-        case BUTTON_INFO:
-            ir.code = IR_INFO;
-            break;
-        case BUTTON_GUIDE:
-            ir.code = IR_GUIDE;
-            break;
-        case BUTTON_SETTINGS:
-            ir.code = IR_SETTINGS;
-            break;
-        case BUTTON_CC:
-        case BUTTON_SUBTITLES:
-            ir.code = IR_CC;
-            break;
-        case BUTTON_SAP:
-        case BUTTON_AUDIO:
-            ir.code = IR_SAP;
-            break;
-        case BUTTON_SLEEP:
-            ir.code = IR_SLEEP;
-            break;
-        case BUTTON_PICTURE_MODE:
-            ir.code = IR_PICTURE_MODE;
-            break;
-        case BUTTON_ASPECT:
-        case BUTTON_ZOOM:
-        case BUTTON_P_SIZE:
-            ir.code = IR_ASPECT;
-            break;
-        
-        /* Smart TV Features */
-        case BUTTON_VOICE:
-        case BUTTON_MIC:
-            ir.code = IR_VOICE;
-            break;
-        case BUTTON_LIVE_TV:
-            ir.code = IR_LIVE_TV;
-            break;
-        case BUTTON_STREAM:
-            ir.code = IR_STREAM;
-            break;
-        
-        /* System & Diagnostic */
-        case BUTTON_DISPLAY:
-        case BUTTON_STATUS:
-            ir.code = IR_DISPLAY;
-            break;
-        case BUTTON_HELP:
-        case BUTTON_E_MANUAL:
-            ir.code = IR_HELP;
-            break;
-        
-        /* Gaming Controls */
-        case BUTTON_GAME_MODE:
-            ir.code = IR_GAME_MODE;
-            break;
-        
-        /* Picture Controls */
-        case BUTTON_MOTION:
-            ir.code = IR_MOTION;
-            break;
-        case BUTTON_BACKLIGHT:
-        case BUTTON_BRIGHTNESS:
-            ir.code = IR_BRIGHTNESS;
-            break;
-        
-        /* Audio Controls */
-        case BUTTON_SOUND_MODE:
-            ir.code = IR_SOUND_MODE;
-            break;
-        case BUTTON_SYNC:
-            ir.code = IR_SYNC;
-            break;
-        case BUTTON_SOUND_OUTPUT:
-            ir.code = IR_SOUND_OUTPUT;
-            break;
-        
-        /* Input & Connectivity */
-        case BUTTON_MULTI_VIEW:
-            ir.code = IR_MULTI_VIEW;
-            break;
-        case BUTTON_PIP:
-            ir.code = IR_PIP;
-            break;
-        case BUTTON_SCREEN_MIRROR:
-            ir.code = IR_SCREEN_MIRROR;
-            break;
-
-        /* Room / Smart Home (simulator-only; no IR) */
-        case BUTTON_ROOM_SCENE_MOVIE:
-        case BUTTON_ROOM_SCENE_RELAX:
-        case BUTTON_ROOM_SCENE_OFF:
-        case BUTTON_ROOM_LIGHTS_DIM:
-        case BUTTON_ROOM_LIGHTS_FULL:
-        case BUTTON_ROOM_SMART_PLUG1:
-        case BUTTON_ROOM_SMART_SPEAKER:
-        case BUTTON_ROOM_AMBIENT_STRIP:
-        case BUTTON_ROOM_SMART_PLUG2:
-        case BUTTON_ROOM_SMART_PLUG3:
-        case BUTTON_ROOM_KITCHEN_LIGHT:
-        case BUTTON_ROOM_FRIDGE:
-        case BUTTON_ROOM_OVEN:
-        case BUTTON_ROOM_BEDROOM_LAMP:
-        case BUTTON_ROOM_BATHROOM_LIGHT:
-        case BUTTON_ROOM_UPSTAIRS_HALL:
-        case BUTTON_ROOM_ENTRY_LIGHT:
-        case BUTTON_ROOM_UPSTAIRS_BEDROOM:
-        case BUTTON_ROOM_UPSTAIRS_BATHROOM:
-        case BUTTON_ROOM_HOOD_LIGHT:
-            ir.code = 0x00000000;
-            break;
-        
-        default:
-            ir.code = 0x00000000;  /* Unknown button */
-            break;
-    }
+    ir.bit_length = 0;     /* Protocol default */
     
     return ir;
 }
@@ -358,12 +106,16 @@ int ir_init(void) {
 }
 
 /**
- * @brief Send IR code using assembly-optimized protocol encoding
+ * @brief Transmit an IR code as a sequence of frames
+ * @param code IR code structure to send
+ * @param hold_us Time the button is held (0 = use code.repeat_count)
  * 
- * This function uses assembly routines for precise timing and protocol encoding.
- * Supports RC5 and RC6 protocols with hardware-level control.
+ * The code is encoded into a pulse train once (ir_pulse_encode) and the
+ * first frame is always the full code. Later frames replay the same train,
+ * except for NEC, which sends the short repeat frame instead. When held,
+ * frames are sent for as many frame periods as fit in hold_us.
  */
-int ir_send(ir_code_t code) {
+static int ir_transmit(ir_code_t code, uint64_t hold_us) {
     if (!ir_initialized) {
         fprintf(stderr, "[IR] Error: IR not initialized. Call ir_init() first.\n");
         handler_trigger_error(ERROR_IR_NOT_INITIALIZED, "IR system not initialized");
@@ -380,7 +132,7 @@ int ir_send(ir_code_t code) {
            code.code, code.protocol, code.frequency, code.repeat_count);
     
     /* Measure latency: IR transmission */
-    uint64_t ir_start = LATENCY_MEASURE_START();
+    uint64_t ir_start = LATENCY_MEASURE_START_NS();
     
     /* Trigger IR transmission start event */
     handler_trigger_ir_transmit_start(code);
@@ -395,56 +147,46 @@ int ir_send(ir_code_t code) {
         }
     }
     
-    /* Send IR code using appropriate protocol */
-    int i;
+    /* Encode once; every repeat replays the same pulse train */
+    ir_pulse_train_t train;
+    ir_pulse_train_t repeat_train;
+    uint32_t frames = code.repeat_count;
+    uint32_t i;
     int transmission_success = 1;
-    for (i = 0; i < code.repeat_count; i++) {
-        switch (code.protocol) {
-            case IR_PROTOCOL_RC5:
-                {
-                    uint16_t rc5_code = ir_code_to_rc5(code.code);
-                    ir_send_rc5(rc5_code);
-                }
-                break;
-            
-            case IR_PROTOCOL_RC6:
-                {
-                    uint32_t rc6_code = ir_code_to_rc6(code.code);
-                    ir_send_rc6(rc6_code);
-                }
-                break;
-            
-            case IR_PROTOCOL_PHILLIPS:
-                /* Default to RC5 for Phillips remotes */
-                {
-                    uint16_t rc5_code = ir_code_to_rc5(code.code);
-                    ir_send_rc5(rc5_code);
-                }
-                break;
-            
-            default:
-                fprintf(stderr, "[IR] Error: Unsupported protocol: %d\n", code.protocol);
-                handler_trigger_error(ERROR_PROTOCOL_ERROR, "Unsupported IR protocol");
-                transmission_success = 0;
-                break;
-        }
+    
+    if (ir_pulse_encode(code, &train) != 0) {
+        fprintf(stderr, "[IR] Error: Unsupported protocol: %d\n", code.protocol);
+        handler_trigger_error(ERROR_PROTOCOL_ERROR, "Unsupported IR protocol");
+        transmission_success = 0;
+    } else if (code.protocol == IR_PROTOCOL_NEC) {
+        /* NEC repeats use the 11.8ms repeat frame instead of the 67.5ms full frame */
+        ir_pulse_encode_nec_repeat(&repeat_train);
+    } else {
+        repeat_train = train;
+    }
+    
+    if (transmission_success && hold_us > 0) {
+        uint32_t period_us = train.duration_us + train.repeat_gap_us;
+        frames = (uint32_t)(1 + hold_us / (period_us ? period_us : 1));
+        printf("[IR] Holding for %llu us (%u frames)\n", (unsigned long long)hold_us, frames);
+    }
+    
+    for (i = 0; transmission_success && i < frames; i++) {
+        const ir_pulse_train_t* frame = (i == 0) ? &train : &repeat_train;
+        uint64_t frame_start = timebase_now_ns();
         
-        if (!transmission_success) {
-            break;
-        }
+        ir_pulse_send(frame);
         
-        /* Repeat delay between transmissions */
-        if (i < code.repeat_count - 1) {
-            if (code.protocol == IR_PROTOCOL_RC6) {
-                delay_us(RC6_REPEAT_DELAY);
-            } else {
-                delay_us(RC5_REPEAT_DELAY);
-            }
+        /* Start the next frame one frame period after this one started, so
+         * time spent sending does not stretch the repeat interval */
+        if (i < frames - 1) {
+            timebase_sleep_until_ns(frame_start +
+                                    ((uint64_t)frame->duration_us + frame->repeat_gap_us) * 1000ULL);
         }
     }
     
     /* Measure latency: IR transmission complete */
-    LATENCY_MEASURE_END(ir_start, "ir_transmit", code.code);
+    LATENCY_MEASURE_END_NS(ir_start, "ir_transmit", code.code);
     
     /* Trigger IR transmission complete event */
     handler_trigger_ir_transmit_complete(code, transmission_success);
@@ -457,6 +199,33 @@ int ir_send(ir_code_t code) {
     return 0;
 }
 
+/**
+ * @brief Send IR code using assembly-optimized protocol encoding
+ * 
+ * Sends code.repeat_count frames. Supports RC5, RC6, NEC and Sony SIRC
+ * protocols; NEC repeats are sent as repeat frames.
+ */
+int ir_send(ir_code_t code) {
+    int result;
+    
+    trace_begin("ir_send", code.code);
+    result = ir_transmit(code, 0);
+    trace_end("ir_send");
+    return result;
+}
+
+/**
+ * @brief Send IR code for as long as a button is held
+ */
+int ir_send_hold(ir_code_t code, uint32_t hold_ms) {
+    int result;
+    
+    trace_begin("ir_send_hold", code.code);
+    result = ir_transmit(code, (uint64_t)hold_ms * 1000);  /* 32-bit us would wrap after ~71 min */
+    trace_end("ir_send_hold");
+    return result;
+}
+
 /**
  * @brief Deinitialize IR transmission hardware
  */
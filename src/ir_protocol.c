@@ -1,15 +1,275 @@
 #include "../include/ir_codes.h"
+#include "../include/ir_pulse.h"
+#include "../include/trace.h"
 #include "ir_asm.h"
 #include <stdint.h>
+#include <string.h>
 
 /**
  * @file ir_protocol.c
  * @brief IR protocol implementation using assembly functions
  * 
- * This file implements RC5 and RC6 protocol encoding using
- * the assembly timing functions for precise control.
+ * This file implements RC5, RC6, NEC and Sony SIRC protocol encoding. Each protocol
+ * is encoded into a mark/space pulse train (see ir_pulse.h) which is then
+ * replayed by ir_pulse_send() using the assembly timing functions.
  */
 
+/* NEC timing (microseconds) */
+#define NEC_LEADER_PULSE    9000
+#define NEC_LEADER_SPACE    4500
+#define NEC_BIT_PULSE       560
+#define NEC_ONE_SPACE       1690
+#define NEC_ZERO_SPACE      560
+#define NEC_REPEAT_SPACE    2250    /* Repeat frame: 9ms pulse, 2.25ms space, 560us pulse */
+#define NEC_FRAME_PERIOD    108000  /* Frame-to-frame period: 108ms */
+
+/* Sony SIRC timing (microseconds) */
+#define SIRC_LEADER_PULSE   2400
+#define SIRC_ONE_PULSE      1200
+#define SIRC_ZERO_PULSE     600
+#define SIRC_SPACE          600
+#define SIRC_FRAME_PERIOD   45000   /* Frame-to-frame period: 45ms */
+#define SIRC_DEFAULT_BITS   12
+
+/**
+ * @brief Reset a pulse train before encoding
+ */
+static void pulse_begin(ir_pulse_train_t* train) {
+    memset(train, 0, sizeof(ir_pulse_train_t));
+    train->frequency = CARRIER_FREQ;
+}
+
+/**
+ * @brief Append a mark or space, merging with the previous entry if same level
+ * @return 0 on success, -1 if the train is full
+ */
+static int pulse_append(ir_pulse_train_t* train, int mark, uint16_t duration_us) {
+    uint16_t level = mark ? IR_PULSE_MARK : 0;
+    
+    if (duration_us == 0) {
+        return 0;
+    }
+    
+    train->duration_us += duration_us;
+    
+    if (train->count > 0) {
+        uint16_t* last = &train->entries[train->count - 1];
+        if ((*last & IR_PULSE_MARK) == level) {
+            *last = (uint16_t)(level | ((*last & IR_PULSE_DURATION_MASK) + duration_us));
+            return 0;
+        }
+    }
+    
+    if (train->count >= IR_PULSE_MAX_ENTRIES) {
+        return -1;
+    }
+    
+    train->entries[train->count++] = (uint16_t)(level | duration_us);
+    return 0;
+}
+
+/**
+ * @brief Append one Manchester bit (bit 0 = ON then OFF, bit 1 = OFF then ON)
+ */
+static int pulse_append_manchester(ir_pulse_train_t* train, uint8_t bit, uint16_t half_us) {
+    if (pulse_append(train, !bit, half_us) != 0) {
+        return -1;
+    }
+    return pulse_append(train, bit, half_us);
+}
+
+/**
+ * @brief Encode RC5 protocol code into a pulse train
+ */
+int ir_pulse_encode_rc5(uint16_t rc5_code, ir_pulse_train_t* train) {
+    int i;
+    
+    if (!train) {
+        return -1;
+    }
+    
+    pulse_begin(train);
+    
+    /* Send bits MSB first */
+    for (i = 13; i >= 0; i--) {
+        if (pulse_append_manchester(train, (rc5_code >> i) & 0x01, RC5_BIT_TIME) != 0) {
+            return -1;
+        }
+    }
+    
+    train->repeat_gap_us = RC5_REPEAT_DELAY;
+    return 0;
+}
+
+/**
+ * @brief Encode RC6 protocol code into a pulse train
+ */
+int ir_pulse_encode_rc6(uint32_t rc6_code, ir_pulse_train_t* train) {
+    int i;
+    
+    if (!train) {
+        return -1;
+    }
+    
+    pulse_begin(train);
+    
+    /* Leader pulse and space */
+    pulse_append(train, 1, RC6_LEADER_PULSE);
+    pulse_append(train, 0, RC6_LEADER_SPACE);
+    
+    /* Start bit (always 1) */
+    pulse_append_manchester(train, 1, RC6_BIT_TIME);
+    
+    /* Remaining bits MSB first (19 bits) */
+    for (i = 18; i >= 0; i--) {
+        if (pulse_append_manchester(train, (rc6_code >> i) & 0x01, RC6_BIT_TIME) != 0) {
+            return -1;
+        }
+    }
+    
+    train->repeat_gap_us = RC6_REPEAT_DELAY;
+    return 0;
+}
+
+/**
+ * @brief Encode NEC protocol code into a pulse train
+ */
+int ir_pulse_encode_nec(uint32_t code, ir_pulse_train_t* train) {
+    int i;
+    
+    if (!train) {
+        return -1;
+    }
+    
+    pulse_begin(train);
+    
+    /* Leader pulse (9ms) and space (4.5ms) */
+    pulse_append(train, 1, NEC_LEADER_PULSE);
+    pulse_append(train, 0, NEC_LEADER_SPACE);
+    
+    /* Address (high 16 bits) then command (low 16 bits), each LSB first */
+    for (i = 0; i < 32; i++) {
+        int shift = (i < 16) ? (16 + i) : (i - 16);
+        uint8_t bit = (code >> shift) & 0x01;
+        
+        pulse_append(train, 1, NEC_BIT_PULSE);
+        if (pulse_append(train, 0, bit ? NEC_ONE_SPACE : NEC_ZERO_SPACE) != 0) {
+            return -1;
+        }
+    }
+    
+    /* Stop bit */
+    if (pulse_append(train, 1, NEC_BIT_PULSE) != 0) {
+        return -1;
+    }
+    
+    train->repeat_gap_us = NEC_FRAME_PERIOD - train->duration_us;
+    return 0;
+}
+
+/**
+ * @brief Encode the NEC repeat frame into a pulse train
+ */
+int ir_pulse_encode_nec_repeat(ir_pulse_train_t* train) {
+    if (!train) {
+        return -1;
+    }
+    
+    pulse_begin(train);
+    
+    /* Leader pulse (9ms), short space (2.25ms), stop pulse */
+    pulse_append(train, 1, NEC_LEADER_PULSE);
+    pulse_append(train, 0, NEC_REPEAT_SPACE);
+    pulse_append(train, 1, NEC_BIT_PULSE);
+    
+    train->repeat_gap_us = NEC_FRAME_PERIOD - train->duration_us;
+    return 0;
+}
+
+/**
+ * @brief Encode Sony SIRC protocol code into a pulse train
+ */
+int ir_pulse_encode_sony(uint32_t code, uint8_t bit_length, ir_pulse_train_t* train) {
+    int i;
+    
+    if (!train) {
+        return -1;
+    }
+    
+    if (bit_length == 0) {
+        bit_length = SIRC_DEFAULT_BITS;
+    }
+    if (bit_length != 12 && bit_length != 15 && bit_length != 20) {
+        return -1;
+    }
+    
+    pulse_begin(train);
+    train->frequency = 40000;  /* SIRC uses a 40kHz carrier */
+    
+    /* Leader pulse (2.4ms) */
+    pulse_append(train, 1, SIRC_LEADER_PULSE);
+    
+    /* Bits MSB first: each bit is a space then a pulse-width coded mark */
+    for (i = bit_length - 1; i >= 0; i--) {
+        pulse_append(train, 0, SIRC_SPACE);
+        if (pulse_append(train, 1, ((code >> i) & 0x01) ? SIRC_ONE_PULSE : SIRC_ZERO_PULSE) != 0) {
+            return -1;
+        }
+    }
+    
+    /* Frames start every 45ms regardless of content */
+    train->repeat_gap_us = SIRC_FRAME_PERIOD - train->duration_us;
+    return 0;
+}
+
+/**
+ * @brief Encode an IR code into a pulse train (protocol dispatch)
+ */
+int ir_pulse_encode(ir_code_t code, ir_pulse_train_t* train) {
+    int result;
+    
+    if (!train) {
+        return -1;
+    }
+    
+    switch (code.protocol) {
+        case IR_PROTOCOL_RC5:
+        case IR_PROTOCOL_PHILLIPS:
+            /* Phillips remotes default to RC5 */
+            trace_begin("ir_pulse_encode_rc5", code.code);
+            result = ir_pulse_encode_rc5(ir_code_to_rc5(code.code), train);
+            trace_end("ir_pulse_encode_rc5");
+            break;
+        
+        case IR_PROTOCOL_RC6:
+            trace_begin("ir_pulse_encode_rc6", code.code);
+            result = ir_pulse_encode_rc6(ir_code_to_rc6(code.code), train);
+            trace_end("ir_pulse_encode_rc6");
+            break;
+        
+        case IR_PROTOCOL_NEC:
+            trace_begin("ir_pulse_encode_nec", code.code);
+            result = ir_pulse_encode_nec(code.code, train);
+            trace_end("ir_pulse_encode_nec");
+            break;
+        
+        case IR_PROTOCOL_SONY:
+            trace_begin("ir_pulse_encode_sony", code.code);
+            result = ir_pulse_encode_sony(code.code, code.bit_length, train);
+            trace_end("ir_pulse_encode_sony");
+            break;
+        
+        default:
+            return -1;
+    }
+    
+    if (result == 0 && code.frequency != 0) {
+        train->frequency = code.frequency;
+    }
+    
+    return result;
+}
+
 /**
  * @brief Send RC5 protocol code
  * 
@@ -20,14 +280,11 @@
  * - Command: 6 bits (command code)
  */
 void ir_send_rc5(uint16_t code) {
-    uint8_t bit;
-    int i;
+    ir_pulse_train_t train;
     
     /* RC5 uses Manchester encoding: bit 0 = ON then OFF, bit 1 = OFF then ON */
-    /* Send bits MSB first */
-    for (i = 13; i >= 0; i--) {
-        bit = (code >> i) & 0x01;
-        ir_send_rc5_bit(bit);
+    if (ir_pulse_encode_rc5(code, &train) == 0) {
+        ir_pulse_send(&train);
     }
 }
 
@@ -44,24 +301,10 @@ void ir_send_rc5(uint16_t code) {
  * - Command: 8 bits
  */
 void ir_send_rc6(uint32_t code) {
-    uint8_t bit;
-    int i;
-    
-    /* Send leader pulse */
-    ir_led_on();
-    delay_us(RC6_LEADER_PULSE);
+    ir_pulse_train_t train;
     
-    /* Send leader space */
-    ir_led_off();
-    delay_us(RC6_LEADER_SPACE);
-    
-    /* Send start bit (always 1) */
-    ir_send_rc6_bit(1);
-    
-    /* Send remaining bits MSB first (19 bits) */
-    for (i = 18; i >= 0; i--) {
-        bit = (code >> i) & 0x01;
-        ir_send_rc6_bit(bit);
+    if (ir_pulse_encode_rc6(code, &train) == 0) {
+        ir_pulse_send(&train);
     }
 }
 
@@ -133,35 +376,44 @@ uint32_t ir_code_to_rc6(uint32_t code) {
  * - Repeat: 9ms pulse, 2.25ms space, 560us pulse
  */
 void ir_send_nec(uint32_t code) {
-    uint8_t bit;
-    int i;
-    uint16_t address = (code >> 16) & 0xFFFF;
-    uint16_t command = code & 0xFFFF;
-    
-    /* Send leader pulse (9ms) */
-    ir_led_on();
-    delay_us(9000);
+    ir_pulse_train_t train;
     
-    /* Send leader space (4.5ms) */
-    ir_led_off();
-    delay_us(4500);
-    
-    /* Send address (16 bits, LSB first) */
-    for (i = 0; i < 16; i++) {
-        bit = (address >> i) & 0x01;
-        ir_send_nec_bit(bit);
+    if (ir_pulse_encode_nec(code, &train) == 0) {
+        ir_pulse_send(&train);
     }
+}
+
+/**
+ * @brief Send NEC repeat frame
+ * 
+ * Sent every 108ms while a button is held, after one full frame.
+ * The receiver repeats the last full code it decoded.
+ */
+void ir_send_nec_repeat(void) {
+    ir_pulse_train_t train;
     
-    /* Send command (16 bits, LSB first) */
-    for (i = 0; i < 16; i++) {
-        bit = (command >> i) & 0x01;
-        ir_send_nec_bit(bit);
+    if (ir_pulse_encode_nec_repeat(&train) == 0) {
+        ir_pulse_send(&train);
     }
+}
+
+/**
+ * @brief Send Sony SIRC protocol code
+ * 
+ * SIRC Protocol Format (12, 15 or 20 bits, 40kHz carrier):
+ * - Leader pulse: 2.4ms
+ * - Each bit: 600us space, then 1200us pulse (1) or 600us pulse (0)
+ * - Frame period: 45ms from start to start
+ * 
+ * Codes are stored in the common MSB-first notation (e.g. 0xA90 = Power),
+ * so bits are sent from bit (bit_length - 1) down to bit 0.
+ */
+void ir_send_sony(uint32_t code, uint8_t bit_length) {
+    ir_pulse_train_t train;
     
-    /* Send stop bit */
-    ir_led_on();
-    delay_us(560);
-    ir_led_off();
+    if (ir_pulse_encode_sony(code, bit_length, &train) == 0) {
+        ir_pulse_send(&train);
+    }
 }
 
 /**
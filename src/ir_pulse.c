@@ -0,0 +1,151 @@
+#include "../include/ir_pulse.h"
+#include "../include/timebase.h"
+#include "../include/trace.h"
+#include "ir_asm.h"
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * @file ir_pulse.c
+ * @brief Pulse train replay engine
+ *
+ * Plays back mark/space arrays produced by the encoders in ir_protocol.c.
+ * Adjacent half-bits with the same level are already merged by the encoder,
+ * so each entry costs exactly one LED update and one delay.
+ *
+ * Two timing modes are supported:
+ * - Relative: delay_us() per entry; per-entry error adds up over the frame
+ * - Deadline: each edge waits for an absolute CLOCK_MONOTONIC deadline
+ *   (sleep, then spin for the last TIMEBASE_SPIN_US), so errors do not
+ *   accumulate and the lateness of every edge is reported
+ */
+
+static ir_timing_mode_t timing_mode = IR_TIMING_RELATIVE;
+
+/* Per thread, so concurrent transmits do not overwrite each other's report */
+static _Thread_local ir_pulse_report_t last_report;
+static _Thread_local int last_report_valid = 0;
+
+/**
+ * @brief Replay with relative delays
+ */
+static void pulse_send_relative(const ir_pulse_train_t* train) {
+    uint16_t i;
+
+    for (i = 0; i < train->count; i++) {
+        uint16_t entry = train->entries[i];
+
+        if (entry & IR_PULSE_MARK) {
+            ir_led_on();
+        } else {
+            ir_led_off();
+        }
+        delay_us(entry & IR_PULSE_DURATION_MASK);
+    }
+
+    /* Never leave the carrier running between frames */
+    ir_led_off();
+}
+
+/**
+ * @brief Replay a pulse train against absolute deadlines
+ */
+int ir_pulse_send_deadline(const ir_pulse_train_t* train, ir_pulse_report_t* report) {
+    uint64_t frame_start;
+    uint64_t deadline;
+    uint64_t now = 0;
+    uint64_t late_sum = 0;
+    uint16_t i;
+
+    if (!train || train->count > IR_PULSE_MAX_ENTRIES) {
+        return -1;
+    }
+
+    memset(&last_report, 0, sizeof(ir_pulse_report_t));
+
+    frame_start = timebase_now_ns();
+    deadline = frame_start;
+
+    /* count entries plus the final carrier-OFF edge */
+    for (i = 0; i <= train->count; i++) {
+        uint64_t late_ns;
+
+        timebase_sleep_until_ns(deadline);
+
+        if (i < train->count && (train->entries[i] & IR_PULSE_MARK)) {
+            ir_led_on();
+        } else {
+            ir_led_off();
+        }
+        now = timebase_now_ns();
+
+        late_ns = now - deadline;
+        if (late_ns > UINT32_MAX) {
+            late_ns = UINT32_MAX;
+        }
+        last_report.edge_late_ns[i] = (uint32_t)late_ns;
+        if (late_ns > last_report.max_late_ns) {
+            last_report.max_late_ns = (uint32_t)late_ns;
+        }
+        late_sum += late_ns;
+
+        if (i < train->count) {
+            deadline += (uint64_t)(train->entries[i] & IR_PULSE_DURATION_MASK) * 1000ULL;
+        }
+    }
+
+    last_report.edge_count = (uint16_t)(train->count + 1);
+    last_report.avg_late_ns = (uint32_t)(late_sum / last_report.edge_count);
+    last_report.frame_error_ns = (int32_t)((int64_t)(now - frame_start) -
+                                           (int64_t)train->duration_us * 1000);
+    last_report_valid = 1;
+
+    if (report) {
+        *report = last_report;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Replay a pulse train on the IR LED
+ */
+void ir_pulse_send(const ir_pulse_train_t* train) {
+    if (!train) {
+        return;
+    }
+
+    trace_begin("ir_pulse_send", train->count);
+    if (timing_mode == IR_TIMING_DEADLINE) {
+        ir_pulse_send_deadline(train, NULL);
+    } else {
+        pulse_send_relative(train);
+    }
+    trace_end("ir_pulse_send");
+}
+
+/**
+ * @brief Select the timing mode used by ir_pulse_send()
+ */
+void ir_pulse_set_timing_mode(ir_timing_mode_t mode) {
+    timing_mode = mode;
+}
+
+/**
+ * @brief Get the timing mode used by ir_pulse_send()
+ */
+ir_timing_mode_t ir_pulse_get_timing_mode(void) {
+    return timing_mode;
+}
+
+/**
+ * @brief Get the edge report of the calling thread's last deadline-mode replay
+ */
+int ir_pulse_get_last_report(ir_pulse_report_t* report) {
+    if (!report || !last_report_valid) {
+        return -1;
+    }
+
+    *report = last_report;
+    return 0;
+}
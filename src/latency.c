@@ -1,55 +1,706 @@
+/* pthread keys require POSIX.1-2001 */
+#if defined(__linux__) || defined(__unix__) || defined(__APPLE__)
+#undef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200112L
+#endif
+
 #include "../include/latency.h"
+#include "../include/latency_log.h"
+#include "../include/timebase.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
+#include <stdatomic.h>
 
 #ifdef _WIN32
-    #include <windows.h>
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+/* Cycle counter support: invariant TSC (x86-64) or CNTVCT (aarch64) */
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#include <x86intrin.h>
+#include <cpuid.h>
+#define LATENCY_HAVE_CYCLES 1
+#elif (defined(__GNUC__) || defined(__clang__)) && defined(__aarch64__)
+#define LATENCY_HAVE_CYCLES 1
 #else
-    #include <time.h>
-    #include <sys/time.h>
+#define LATENCY_HAVE_CYCLES 0
+#endif
+
+/**
+ * @file latency.c
+ * @brief Per-thread latency sample rings with on-demand aggregation
+ *
+ * Every recording thread gets its own ring from a fixed pool (the last
+ * ring is shared once the pool is exhausted) and returns it when it exits.
+ * latency_init() bumps a generation counter so that rings cached by
+ * threads before a cleanup are claimed again. A writer claims a slot with
+ * one atomic fetch_add and publishes it with a per-slot sequence number,
+ * so recording never takes a lock. It is not async-signal-safe: a
+ * thread's first record registers its ring with pthread_setspecific(),
+ * and interning a new operation name waits for a concurrent claim of the
+ * same table slot. Each ring counts its records in progress so that
+ * latency_cleanup() can wait for them before freeing the slots.
+ *
+ * Counters and a log-linear histogram (see latency_histogram_t) are kept
+ * per ring and per interned operation ID, with no sample cap. Percentiles
+ * come from the merged histograms, so statistics never copy or sort
+ * samples and per-operation queries are a direct lookup by ID.
+ *
+ * All latencies are kept in nanoseconds; the microsecond fields of
+ * latency_stats_t are derived from them.
+ */
+
+/* Atomic counters and histogram (per ring and per operation) */
+typedef struct {
+    _Atomic uint64_t count;                      /* Samples recorded */
+    _Atomic uint64_t sum_ns;                     /* Sum of latencies (ns) */
+    _Atomic uint64_t min_ns;                     /* Minimum latency (ns) */
+    _Atomic uint64_t max_ns;                     /* Maximum latency (ns) */
+    _Atomic uint64_t hist[LATENCY_HIST_BUCKETS]; /* Latency histogram */
+} latency_counters_t;
+
+/* One ring slot: seq is index + 1 once published, 0 while being written */
+typedef struct {
+    _Atomic uint64_t seq;
+    latency_sample_t sample;
+} latency_slot_t;
+
+/* Per-thread sample ring (cache-line aligned to avoid false sharing) */
+typedef struct {
+    _Alignas(64) _Atomic uint64_t head;     /* Next slot index to claim */
+    _Atomic uint64_t reset_head;            /* First index after last reset */
+    _Atomic uintptr_t owner;                /* Claim ticket of the owning thread (0 = free) */
+    atomic_uint writers;                    /* Records in progress */
+    latency_slot_t* slots;                  /* ring_capacity slots */
+    latency_counters_t counters;            /* All samples of this ring */
+} latency_ring_t;
+
+/* Interned operation slot states */
+enum {
+    OP_FREE = 0,
+    OP_CLAIMED,                             /* Name being copied in */
+    OP_READY
+};
+
+/* Interned operation */
+typedef struct {
+    _Alignas(64) _Atomic int state;         /* OP_FREE, OP_CLAIMED or OP_READY */
+    uint32_t hash;                          /* Hash of name */
+    char name[LATENCY_OP_NAME_LEN];         /* Copy of the registered name */
+    latency_counters_t counters;            /* All samples of this operation */
+} latency_op_entry_t;
+
+static latency_ring_t rings[LATENCY_MAX_RINGS];
+static size_t ring_capacity = 0;            /* Power of two (0 = no samples) */
+static latency_slot_t* slot_storage = NULL;
+static _Thread_local latency_ring_t* thread_ring = NULL;
+static _Thread_local uint32_t thread_ring_generation = 0;
+
+/* Bumped by latency_init(): rings cached by threads before are stale */
+static _Atomic uint32_t ring_generation = 0;
+static _Atomic uintptr_t ring_claims = 0;
+
+#ifndef _WIN32
+static pthread_key_t ring_key;              /* Releases the ring at thread exit */
+static pthread_once_t ring_key_once = PTHREAD_ONCE_INIT;
+static int ring_key_valid = 0;
 #endif
 
-/* Global latency statistics */
-static latency_stats_t global_stats = {0};
-static int latency_initialized = 0;
+/* Operation table: open addressing on the name hash, IDs stay valid for
+ * the lifetime of the process */
+static latency_op_entry_t ops[LATENCY_MAX_OPS];
+
+_Static_assert((LATENCY_MAX_OPS & (LATENCY_MAX_OPS - 1)) == 0, "LATENCY_MAX_OPS must be a power of two");
+
+static atomic_int latency_initialized = 0;
+
+/* Cycle counter conversion: ns = base_ns + ((cycles - base_cycles) * mult) >> 32 */
+static latency_clock_t active_clock = LATENCY_CLOCK_TIMEBASE;
+static uint64_t cycle_base_cycles = 0;
+static uint64_t cycle_base_ns = 0;
+static uint64_t cycle_mult = 0;
+
+/* ============================================================================
+ * TIMESTAMP SOURCE
+ * ============================================================================ */
+
+#if LATENCY_HAVE_CYCLES
+/**
+ * @brief Read the CPU cycle counter
+ */
+static uint64_t cycles_read(void) {
+#if defined(__x86_64__)
+    _mm_lfence();  /* Keep earlier instructions from moving past the read */
+    return __rdtsc();
+#else
+    uint64_t value;
+    __asm__ __volatile__("isb\n\tmrs %0, cntvct_el0" : "=r"(value) :: "memory");
+    return value;
+#endif
+}
+
+/**
+ * @brief Get the cycle counter frequency
+ * @return Frequency in Hz, or 0 if unusable
+ */
+static uint64_t cycles_frequency(void) {
+#if defined(__x86_64__)
+    unsigned int eax, ebx, ecx, edx;
+    uint64_t t0, t1, c0, c1;
+    
+    /* Invariant TSC: CPUID 0x80000007, EDX bit 8 */
+    if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) || !(edx & (1u << 8))) {
+        return 0;
+    }
+    
+    /* Calibrate against the (realtime) timebase */
+    t0 = timebase_now_ns();
+    c0 = cycles_read();
+    timebase_sleep_us(LATENCY_CALIBRATION_US);
+    t1 = timebase_now_ns();
+    c1 = cycles_read();
+    
+    if (t1 <= t0 || c1 <= c0) {
+        return 0;
+    }
+    return (uint64_t)((unsigned __int128)(c1 - c0) * 1000000000ULL / (t1 - t0));
+#else
+    uint64_t freq;
+    __asm__ __volatile__("mrs %0, cntfrq_el0" : "=r"(freq));
+    return freq;
+#endif
+}
+#endif /* LATENCY_HAVE_CYCLES */
+
+/**
+ * @brief Select the timestamp source
+ */
+int latency_set_clock(latency_clock_t clock) {
+    if (clock == LATENCY_CLOCK_TIMEBASE) {
+        active_clock = LATENCY_CLOCK_TIMEBASE;
+        return 0;
+    }
+    
+#if LATENCY_HAVE_CYCLES
+    if (clock == LATENCY_CLOCK_CYCLES) {
+        uint64_t freq;
+        
+        /* Virtual time cannot be calibrated against */
+        if (timebase_is_virtual()) {
+            return -1;
+        }
+        
+        freq = cycles_frequency();
+        if (freq == 0) {
+            return -1;
+        }
+        
+        cycle_mult = (uint64_t)(((unsigned __int128)1000000000ULL << 32) / freq);
+        cycle_base_ns = timebase_now_ns();
+        cycle_base_cycles = cycles_read();
+        active_clock = LATENCY_CLOCK_CYCLES;
+        printf("[Latency] Cycle counter: %llu Hz\n", (unsigned long long)freq);
+        return 0;
+    }
+#endif
+    
+    return -1;
+}
+
+/**
+ * @brief Get the active timestamp source
+ */
+latency_clock_t latency_get_clock(void) {
+    return active_clock;
+}
+
+/**
+ * @brief Get high-precision timestamp in nanoseconds
+ */
+uint64_t latency_get_timestamp_ns(void) {
+#if LATENCY_HAVE_CYCLES
+    /* The virtual clock always wins so simulated delays are measured */
+    if (active_clock == LATENCY_CLOCK_CYCLES && !timebase_is_virtual()) {
+        uint64_t delta = cycles_read() - cycle_base_cycles;
+        return cycle_base_ns + (uint64_t)(((unsigned __int128)delta * cycle_mult) >> 32);
+    }
+#endif
+    /* Realtime or virtual clock, depending on the active timebase */
+    return timebase_now_ns();
+}
 
 /**
  * @brief Get high-precision timestamp in microseconds
  */
 uint64_t latency_get_timestamp_us(void) {
-#ifdef _WIN32
-    LARGE_INTEGER frequency, counter;
-    QueryPerformanceFrequency(&frequency);
-    QueryPerformanceCounter(&counter);
-    return (uint64_t)(counter.QuadPart * 1000000ULL / frequency.QuadPart);
+    return latency_get_timestamp_ns() / 1000ULL;
+}
+
+/* ============================================================================
+ * HISTOGRAM
+ * ============================================================================ */
+
+/**
+ * @brief Index of the most significant set bit (v != 0)
+ */
+static uint32_t hist_msb(uint64_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+    return 63u - (uint32_t)__builtin_clzll(v);
 #else
-    struct timespec ts;
-    clock_gettime(CLOCK_MONOTONIC, &ts);
-    return (uint64_t)(ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000);
+    uint32_t msb = 0;
+    while (v >>= 1) {
+        msb++;
+    }
+    return msb;
+#endif
+}
+
+/**
+ * @brief Map a latency to its histogram bucket
+ *
+ * Values below 2 * LATENCY_HIST_SUB_COUNT get one bucket each. Above that,
+ * every power-of-two range is split into LATENCY_HIST_SUB_COUNT linear
+ * buckets: index = e * SUB_COUNT + (v >> e), with e = msb(v) - SUB_BITS.
+ * Values beyond LATENCY_HIST_MAX_BITS land in the last bucket.
+ */
+static uint32_t hist_bucket(uint64_t value_ns) {
+    uint32_t e = 0;
+    
+    if (value_ns >> LATENCY_HIST_MAX_BITS) {
+        value_ns = (1ULL << LATENCY_HIST_MAX_BITS) - 1;
+    }
+    if (value_ns >= 2u * LATENCY_HIST_SUB_COUNT) {
+        e = hist_msb(value_ns) - LATENCY_HIST_SUB_BITS;
+    }
+    return e * LATENCY_HIST_SUB_COUNT + (uint32_t)(value_ns >> e);
+}
+
+/**
+ * @brief Highest latency that maps to a bucket
+ */
+static uint64_t hist_bucket_high(uint32_t bucket) {
+    uint32_t e = 0;
+    uint64_t m = bucket;
+    
+    if (bucket >= 2u * LATENCY_HIST_SUB_COUNT) {
+        e = bucket / LATENCY_HIST_SUB_COUNT - 1;
+        m = bucket - e * LATENCY_HIST_SUB_COUNT;
+    }
+    return ((m + 1) << e) - 1;
+}
+
+/**
+ * @brief Clear a histogram
+ */
+void latency_histogram_reset(latency_histogram_t* hist) {
+    if (!hist) {
+        return;
+    }
+    
+    memset(hist, 0, sizeof(latency_histogram_t));
+    hist->min_ns = UINT64_MAX;
+}
+
+/**
+ * @brief Add one latency value to a histogram
+ */
+void latency_histogram_record(latency_histogram_t* hist, uint64_t value_ns) {
+    if (!hist) {
+        return;
+    }
+    
+    hist->counts[hist_bucket(value_ns)]++;
+    hist->total++;
+    if (value_ns < hist->min_ns) {
+        hist->min_ns = value_ns;
+    }
+    if (value_ns > hist->max_ns) {
+        hist->max_ns = value_ns;
+    }
+}
+
+/**
+ * @brief Add all counts of one histogram to another
+ */
+void latency_histogram_merge(latency_histogram_t* dst, const latency_histogram_t* src) {
+    uint32_t i;
+    
+    if (!dst || !src) {
+        return;
+    }
+    
+    for (i = 0; i < LATENCY_HIST_BUCKETS; i++) {
+        dst->counts[i] += src->counts[i];
+    }
+    dst->total += src->total;
+    if (src->min_ns < dst->min_ns) {
+        dst->min_ns = src->min_ns;
+    }
+    if (src->max_ns > dst->max_ns) {
+        dst->max_ns = src->max_ns;
+    }
+}
+
+/**
+ * @brief Latency at a percentile, walking the buckets once
+ */
+uint64_t latency_histogram_percentile(const latency_histogram_t* hist, double percentile) {
+    uint64_t target;
+    uint64_t seen = 0;
+    uint32_t i;
+    
+    if (!hist || hist->total == 0) {
+        return 0;
+    }
+    
+    if (percentile < 0.0) {
+        percentile = 0.0;
+    }
+    if (percentile > 100.0) {
+        percentile = 100.0;
+    }
+    
+    /* Rank of the requested sample (1-based, at least the first one) */
+    target = (uint64_t)(percentile / 100.0 * (double)hist->total + 0.5);
+    if (target == 0) {
+        target = 1;
+    }
+    
+    for (i = 0; i < LATENCY_HIST_BUCKETS; i++) {
+        seen += hist->counts[i];
+        if (seen >= target) {
+            uint64_t high = hist_bucket_high(i);
+            return high < hist->max_ns ? high : hist->max_ns;
+        }
+    }
+    
+    return hist->max_ns;
+}
+
+/* ============================================================================
+ * COUNTERS
+ * ============================================================================ */
+
+/**
+ * @brief Clear a counter set
+ */
+static void counters_reset(latency_counters_t* counters) {
+    uint32_t i;
+    
+    for (i = 0; i < LATENCY_HIST_BUCKETS; i++) {
+        atomic_store_explicit(&counters->hist[i], 0, memory_order_relaxed);
+    }
+    atomic_store(&counters->count, 0);
+    atomic_store(&counters->sum_ns, 0);
+    atomic_store(&counters->min_ns, UINT64_MAX);
+    atomic_store(&counters->max_ns, 0);
+}
+
+/**
+ * @brief Add one sample to a counter set (wait-free adds, lock-free min/max)
+ */
+static void counters_record(latency_counters_t* counters, uint64_t latency_ns) {
+    uint64_t current;
+    
+    atomic_fetch_add_explicit(&counters->count, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&counters->sum_ns, latency_ns, memory_order_relaxed);
+    atomic_fetch_add_explicit(&counters->hist[hist_bucket(latency_ns)], 1, memory_order_relaxed);
+    
+    current = atomic_load_explicit(&counters->min_ns, memory_order_relaxed);
+    while (latency_ns < current &&
+           !atomic_compare_exchange_weak_explicit(&counters->min_ns, &current, latency_ns,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+        /* retry with refreshed minimum */
+    }
+    current = atomic_load_explicit(&counters->max_ns, memory_order_relaxed);
+    while (latency_ns > current &&
+           !atomic_compare_exchange_weak_explicit(&counters->max_ns, &current, latency_ns,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+        /* retry with refreshed maximum */
+    }
+}
+
+/**
+ * @brief Add a counter set to a statistics structure and histogram
+ * @param stats Statistics to accumulate into (may be NULL)
+ * @param hist Histogram to accumulate into (may be NULL)
+ */
+static void counters_merge(const latency_counters_t* counters,
+                           latency_stats_t* stats, latency_histogram_t* hist) {
+    uint64_t min_ns = atomic_load_explicit(&counters->min_ns, memory_order_relaxed);
+    uint64_t max_ns = atomic_load_explicit(&counters->max_ns, memory_order_relaxed);
+    uint32_t i;
+    
+    if (stats) {
+        stats->count += (uint32_t)atomic_load_explicit(&counters->count, memory_order_relaxed);
+        stats->sum_ns += atomic_load_explicit(&counters->sum_ns, memory_order_relaxed);
+        if (min_ns < stats->min_ns) {
+            stats->min_ns = min_ns;
+        }
+        if (max_ns > stats->max_ns) {
+            stats->max_ns = max_ns;
+        }
+    }
+    
+    if (hist) {
+        for (i = 0; i < LATENCY_HIST_BUCKETS; i++) {
+            uint64_t count = atomic_load_explicit(&counters->hist[i], memory_order_relaxed);
+            hist->counts[i] += count;
+            hist->total += count;
+        }
+        if (min_ns < hist->min_ns) {
+            hist->min_ns = min_ns;
+        }
+        if (max_ns > hist->max_ns) {
+            hist->max_ns = max_ns;
+        }
+    }
+}
+
+/**
+ * @brief Convert nanoseconds to a saturated microsecond field
+ */
+static uint32_t ns_to_us(uint64_t ns) {
+    uint64_t us = ns / 1000ULL;
+    return us > UINT32_MAX ? UINT32_MAX : (uint32_t)us;
+}
+
+/**
+ * @brief Fill averages, percentiles and microsecond fields once merged
+ */
+static void stats_finish(latency_stats_t* stats, const latency_histogram_t* hist) {
+    if (stats->count > 0) {
+        stats->avg_ns = stats->sum_ns / stats->count;
+        if (hist) {
+            stats->p50_ns = latency_histogram_percentile(hist, 50.0);
+            stats->p95_ns = latency_histogram_percentile(hist, 95.0);
+            stats->p99_ns = latency_histogram_percentile(hist, 99.0);
+        }
+    }
+    
+    stats->min_us = stats->min_ns == UINT64_MAX ? UINT32_MAX : ns_to_us(stats->min_ns);
+    stats->max_us = ns_to_us(stats->max_ns);
+    stats->sum_us = stats->sum_ns / 1000ULL;
+    stats->avg_us = ns_to_us(stats->avg_ns);
+    stats->p50_us = ns_to_us(stats->p50_ns);
+    stats->p95_us = ns_to_us(stats->p95_ns);
+    stats->p99_us = ns_to_us(stats->p99_ns);
+}
+
+/**
+ * @brief Start an empty statistics structure
+ */
+static void stats_begin(latency_stats_t* stats, latency_histogram_t* hist) {
+    memset(stats, 0, sizeof(latency_stats_t));
+    stats->min_us = UINT32_MAX;
+    stats->min_ns = UINT64_MAX;
+    latency_histogram_reset(hist);
+}
+
+/* ============================================================================
+ * OPERATION IDS
+ * ============================================================================ */
+
+/**
+ * @brief Hash the significant part of an operation name (FNV-1a)
+ */
+static uint32_t op_hash(const char* name) {
+    uint32_t hash = 2166136261u;
+    size_t i;
+    
+    for (i = 0; i < LATENCY_OP_NAME_LEN - 1 && name[i]; i++) {
+        hash = (hash ^ (uint8_t)name[i]) * 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @brief Look up an operation name, optionally claiming a slot for it
+ *
+ * Lock-free: the probe starts at the name's hash, and a free slot is
+ * claimed with a CAS on its state before the name is copied in. A thread
+ * that meets a slot still being filled waits for the copy, so the same
+ * name never gets two IDs. Only a slot with a matching hash is compared
+ * by string.
+ */
+static latency_op_t op_lookup(const char* name, int claim) {
+    uint32_t hash = op_hash(name);
+    uint32_t i;
+    
+    for (i = 0; i < LATENCY_MAX_OPS; i++) {
+        latency_op_t id = (latency_op_t)((hash + i) & (LATENCY_MAX_OPS - 1));
+        latency_op_entry_t* entry = &ops[id];
+        int state = atomic_load_explicit(&entry->state, memory_order_acquire);
+        
+        if (state == OP_FREE) {
+            if (!claim) {
+                return LATENCY_OP_INVALID;
+            }
+            if (atomic_compare_exchange_strong(&entry->state, &state, OP_CLAIMED)) {
+                strncpy(entry->name, name, LATENCY_OP_NAME_LEN - 1);
+                entry->name[LATENCY_OP_NAME_LEN - 1] = '\0';
+                entry->hash = hash;
+                atomic_store_explicit(&entry->state, OP_READY, memory_order_release);
+                return id;
+            }
+            /* Lost the race: state now holds the winner's state */
+        }
+        while (state == OP_CLAIMED) {
+            state = atomic_load_explicit(&entry->state, memory_order_acquire);
+        }
+        if (entry->hash == hash && strncmp(entry->name, name, LATENCY_OP_NAME_LEN - 1) == 0) {
+            return id;
+        }
+    }
+    
+    return LATENCY_OP_INVALID;  /* Table full, or not registered */
+}
+
+/**
+ * @brief Register (intern) an operation name
+ */
+latency_op_t latency_register_op(const char* name) {
+    if (!name) {
+        return LATENCY_OP_INVALID;
+    }
+    return op_lookup(name, 1);
+}
+
+/**
+ * @brief Find the ID of a registered operation
+ */
+latency_op_t latency_find_op(const char* name) {
+    if (!name) {
+        return LATENCY_OP_INVALID;
+    }
+    return op_lookup(name, 0);
+}
+
+/**
+ * @brief Get the name of a registered operation
+ */
+const char* latency_op_name(latency_op_t op) {
+    if (op >= LATENCY_MAX_OPS ||
+        atomic_load_explicit(&ops[op].state, memory_order_acquire) != OP_READY) {
+        return NULL;
+    }
+    return ops[op].name;
+}
+
+/* ============================================================================
+ * SAMPLE RINGS
+ * ============================================================================ */
+
+/**
+ * @brief Reset one ring's counters and hide its current samples
+ */
+static void ring_reset(latency_ring_t* ring) {
+    counters_reset(&ring->counters);
+    atomic_store(&ring->reset_head, atomic_load(&ring->head));
+}
+
+#ifndef _WIN32
+/**
+ * @brief Thread exit: return the ring to the pool
+ *
+ * The key holds the claim ticket, so a ring that latency_init() freed and
+ * another thread claimed since is left alone.
+ */
+static void ring_release(void* value) {
+    uintptr_t ticket = (uintptr_t)value;
+    
+    atomic_compare_exchange_strong(&rings[ticket % LATENCY_MAX_RINGS].owner, &ticket, 0);
+}
+
+static void ring_key_create(void) {
+    ring_key_valid = pthread_key_create(&ring_key, ring_release) == 0;
+}
+#endif
+
+/**
+ * @brief Get (claim on first use) the calling thread's ring
+ */
+static latency_ring_t* latency_thread_ring(void) {
+    uint32_t generation = atomic_load_explicit(&ring_generation, memory_order_acquire);
+    int i;
+    
+    if (thread_ring && thread_ring_generation == generation) {
+        return thread_ring;
+    }
+    
+    thread_ring_generation = generation;
+    for (i = 0; i < LATENCY_MAX_RINGS - 1; i++) {
+        /* Ticket: unique per claim, ring index in the low bits */
+        uintptr_t ticket = (atomic_fetch_add(&ring_claims, 1) + 1) * LATENCY_MAX_RINGS + (uintptr_t)i;
+        uintptr_t expected = 0;
+        
+        if (atomic_compare_exchange_strong(&rings[i].owner, &expected, ticket)) {
+#ifndef _WIN32
+            pthread_once(&ring_key_once, ring_key_create);
+            if (ring_key_valid) {
+                pthread_setspecific(ring_key, (void*)ticket);
+            }
 #endif
+            thread_ring = &rings[i];
+            return thread_ring;
+        }
+    }
+    
+    /* Pool exhausted: share the last ring (slot claims are still atomic) */
+    thread_ring = &rings[LATENCY_MAX_RINGS - 1];
+    return thread_ring;
 }
 
 /**
  * @brief Initialize latency measurement system
  */
 int latency_init(size_t max_samples) {
+    int i;
+    
     if (latency_initialized) {
         return 0;
     }
     
-    memset(&global_stats, 0, sizeof(latency_stats_t));
-    
+    /* Round per-ring capacity up to a power of two for index masking */
+    ring_capacity = 0;
     if (max_samples > 0) {
-        global_stats.samples = (latency_sample_t*)calloc(max_samples, sizeof(latency_sample_t));
-        if (!global_stats.samples) {
+        ring_capacity = 1;
+        while (ring_capacity < max_samples) {
+            ring_capacity <<= 1;
+        }
+        
+        slot_storage = (latency_slot_t*)calloc(ring_capacity * LATENCY_MAX_RINGS, sizeof(latency_slot_t));
+        if (!slot_storage) {
+            ring_capacity = 0;
             return -1;
         }
-        global_stats.sample_capacity = max_samples;
     }
     
-    global_stats.min_us = UINT32_MAX;
+    for (i = 0; i < LATENCY_MAX_RINGS; i++) {
+        atomic_store(&rings[i].head, 0);
+        atomic_store(&rings[i].owner, 0);
+        rings[i].slots = slot_storage ? &slot_storage[(size_t)i * ring_capacity] : NULL;
+        ring_reset(&rings[i]);
+    }
+    
+    for (i = 0; i < LATENCY_MAX_OPS; i++) {
+        counters_reset(&ops[i].counters);
+    }
+    
+    /* Threads that recorded before must claim a ring again */
+    atomic_fetch_add_explicit(&ring_generation, 1, memory_order_release);
+    
+#ifdef LATENCY_CYCLE_CLOCK
+    if (latency_set_clock(LATENCY_CLOCK_CYCLES) != 0) {
+        fprintf(stderr, "[Latency] Cycle counter unavailable, using timebase\n");
+    }
+#endif
+    
     latency_initialized = 1;
     
     return 0;
@@ -59,17 +710,31 @@ int latency_init(size_t max_samples) {
  * @brief Cleanup latency measurement system
  */
 void latency_cleanup(void) {
-    if (!latency_initialized) {
+    int i;
+    
+    if (!atomic_exchange(&latency_initialized, 0)) {
         return;
     }
     
-    if (global_stats.samples) {
-        free(global_stats.samples);
-        global_stats.samples = NULL;
+    /* Let records that saw the system initialized finish with the slots */
+    for (i = 0; i < LATENCY_MAX_RINGS; i++) {
+        while (atomic_load(&rings[i].writers) != 0) {
+#ifdef _WIN32
+            SwitchToThread();
+#else
+            sched_yield();
+#endif
+        }
+    }
+    latency_log_close();
+    
+    for (i = 0; i < LATENCY_MAX_RINGS; i++) {
+        rings[i].slots = NULL;
     }
     
-    memset(&global_stats, 0, sizeof(latency_stats_t));
-    latency_initialized = 0;
+    free(slot_storage);
+    slot_storage = NULL;
+    ring_capacity = 0;
 }
 
 /**
@@ -80,9 +745,11 @@ int latency_probe_start(latency_probe_t* probe, const char* name) {
         return -1;
     }
     
-    probe->start_time_us = latency_get_timestamp_us();
+    probe->start_time_ns = latency_get_timestamp_ns();
+    probe->start_time_us = probe->start_time_ns / 1000ULL;
     probe->probe_name = name;
     probe->active = 1;
+    probe->end_time_ns = 0;
     probe->end_time_us = 0;
     
     return 0;
@@ -96,13 +763,16 @@ uint32_t latency_probe_stop(latency_probe_t* probe, const char* operation, uint3
         return 0;
     }
     
-    probe->end_time_us = latency_get_timestamp_us();
-    uint32_t latency = latency_measure(probe->start_time_us, probe->end_time_us);
+    probe->end_time_ns = latency_get_timestamp_ns();
+    probe->end_time_us = probe->end_time_ns / 1000ULL;
+    uint64_t latency_ns = probe->end_time_ns > probe->start_time_ns ?
+                          probe->end_time_ns - probe->start_time_ns : 0;
     
-    latency_record(latency, operation ? operation : probe->probe_name, code);
+    latency_record_op_ns(latency_register_op(operation ? operation : probe->probe_name),
+                         latency_ns, code, probe->end_time_ns);
     
     probe->active = 0;
-    return latency;
+    return ns_to_us(latency_ns);
 }
 
 /**
@@ -119,143 +789,211 @@ uint32_t latency_measure(uint64_t start_us, uint64_t end_us) {
  * @brief Record a latency sample
  */
 int latency_record(uint32_t latency_us, const char* operation, uint32_t code) {
-    if (!latency_initialized) {
+    return latency_record_op_ns(latency_register_op(operation), (uint64_t)latency_us * 1000ULL,
+                                code, latency_get_timestamp_ns());
+}
+
+/**
+ * @brief Record a latency sample with a known completion timestamp
+ */
+int latency_record_at(uint32_t latency_us, const char* operation, uint32_t code,
+                      uint64_t timestamp_us) {
+    return latency_record_op(latency_register_op(operation), latency_us, code, timestamp_us);
+}
+
+/**
+ * @brief Record a latency sample for an interned operation
+ */
+int latency_record_op(latency_op_t op, uint32_t latency_us, uint32_t code, uint64_t timestamp_us) {
+    return latency_record_op_ns(op, (uint64_t)latency_us * 1000ULL, code, timestamp_us * 1000ULL);
+}
+
+/**
+ * @brief Record a nanosecond latency sample for an interned operation
+ */
+int latency_record_op_ns(latency_op_t op, uint64_t latency_ns, uint32_t code, uint64_t timestamp_ns) {
+    latency_ring_t* ring = latency_thread_ring();
+    
+    /* Announce the record before checking the flag, so that
+     * latency_cleanup() waits for it before freeing the slots */
+    atomic_fetch_add(&ring->writers, 1);
+    if (!atomic_load(&latency_initialized)) {
+        atomic_fetch_sub(&ring->writers, 1);
         return -1;
     }
     
-    /* Update global statistics */
-    global_stats.count++;
-    global_stats.sum_us += latency_us;
-    
-    if (latency_us < global_stats.min_us) {
-        global_stats.min_us = latency_us;
-    }
-    if (latency_us > global_stats.max_us) {
-        global_stats.max_us = latency_us;
+    counters_record(&ring->counters, latency_ns);
+    if (op < LATENCY_MAX_OPS) {
+        counters_record(&ops[op].counters, latency_ns);
     }
     
-    global_stats.avg_us = (uint32_t)(global_stats.sum_us / global_stats.count);
+    /* Persist to the binary log when one is open */
+    latency_log_append(op, latency_ns, code, timestamp_ns);
     
-    /* Store sample if buffer available */
-    if (global_stats.samples && global_stats.sample_count < global_stats.sample_capacity) {
-        latency_sample_t* sample = &global_stats.samples[global_stats.sample_count];
-        sample->timestamp_us = latency_get_timestamp_us();
-        sample->latency_us = latency_us;
-        sample->operation = operation;
-        sample->code = code;
-        global_stats.sample_count++;
+    /* Store sample: claim a slot, write it, then publish its sequence number */
+    if (ring->slots) {
+        uint64_t idx = atomic_fetch_add_explicit(&ring->head, 1, memory_order_relaxed);
+        latency_slot_t* slot = &ring->slots[idx & (ring_capacity - 1)];
+        
+        atomic_store_explicit(&slot->seq, 0, memory_order_relaxed);
+        atomic_thread_fence(memory_order_release);
+        slot->sample.timestamp_ns = timestamp_ns;
+        slot->sample.latency_ns = latency_ns;
+        slot->sample.operation = latency_op_name(op);
+        slot->sample.code = code;
+        slot->sample.op = op;
+        atomic_store_explicit(&slot->seq, idx + 1, memory_order_release);
     }
     
+    atomic_fetch_sub(&ring->writers, 1);
     return 0;
 }
 
 /**
- * @brief Compare function for qsort (sort by latency)
+ * @brief Copy the published samples of every ring
+ *
+ * Slots that are being written (or were overwritten) during the copy are
+ * skipped, so a sample is either copied whole or not at all.
  */
-static int compare_latency(const void* a, const void* b) {
-    const latency_sample_t* sa = (const latency_sample_t*)a;
-    const latency_sample_t* sb = (const latency_sample_t*)b;
-    if (sa->latency_us < sb->latency_us) return -1;
-    if (sa->latency_us > sb->latency_us) return 1;
-    return 0;
+size_t latency_get_samples(latency_sample_t* samples, size_t max_samples) {
+    size_t copied = 0;
+    int i;
+    
+    if (!samples || !latency_initialized || ring_capacity == 0) {
+        return 0;
+    }
+    
+    for (i = 0; i < LATENCY_MAX_RINGS && copied < max_samples; i++) {
+        latency_ring_t* ring = &rings[i];
+        uint64_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+        uint64_t start = atomic_load_explicit(&ring->reset_head, memory_order_relaxed);
+        uint64_t idx;
+        
+        if (head - start > ring_capacity) {
+            start = head - ring_capacity;  /* Ring wrapped: keep the newest samples */
+        }
+        
+        for (idx = start; idx < head && copied < max_samples; idx++) {
+            latency_slot_t* slot = &ring->slots[idx & (ring_capacity - 1)];
+            uint64_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+            latency_sample_t copy;
+            
+            if (seq != idx + 1) {
+                continue;  /* Not published yet, or already reused */
+            }
+            copy = slot->sample;
+            atomic_thread_fence(memory_order_acquire);
+            if (atomic_load_explicit(&slot->seq, memory_order_relaxed) != seq) {
+                continue;  /* Overwritten while copying */
+            }
+            samples[copied++] = copy;
+        }
+    }
+    
+    return copied;
 }
 
 /**
- * @brief Calculate percentiles
+ * @brief Get the merged latency histogram of all threads
  */
-static void calculate_percentiles(latency_stats_t* stats) {
-    if (!stats->samples || stats->sample_count == 0) {
-        return;
-    }
+int latency_get_histogram(latency_histogram_t* hist) {
+    int i;
     
-    /* Sort samples by latency */
-    qsort(stats->samples, stats->sample_count, sizeof(latency_sample_t), compare_latency);
-    
-    /* Calculate percentiles */
-    if (stats->sample_count > 0) {
-        stats->p50_us = stats->samples[stats->sample_count / 2].latency_us;
+    if (!hist || !latency_initialized) {
+        return -1;
     }
-    if (stats->sample_count > 0) {
-        size_t p95_idx = (size_t)(stats->sample_count * 0.95);
-        if (p95_idx >= stats->sample_count) p95_idx = stats->sample_count - 1;
-        stats->p95_us = stats->samples[p95_idx].latency_us;
+    
+    latency_histogram_reset(hist);
+    for (i = 0; i < LATENCY_MAX_RINGS; i++) {
+        counters_merge(&rings[i].counters, NULL, hist);
     }
-    if (stats->sample_count > 0) {
-        size_t p99_idx = (size_t)(stats->sample_count * 0.99);
-        if (p99_idx >= stats->sample_count) p99_idx = stats->sample_count - 1;
-        stats->p99_us = stats->samples[p99_idx].latency_us;
+    return 0;
+}
+
+/**
+ * @brief Get the latency histogram of one operation
+ */
+int latency_get_op_histogram(latency_op_t op, latency_histogram_t* hist) {
+    if (!hist || !latency_initialized || op >= LATENCY_MAX_OPS) {
+        return -1;
     }
+    
+    latency_histogram_reset(hist);
+    counters_merge(&ops[op].counters, NULL, hist);
+    return 0;
 }
 
 /**
  * @brief Get latency statistics
  */
 int latency_get_stats(latency_stats_t* stats) {
+    latency_histogram_t hist;
+    int i;
+    
     if (!stats || !latency_initialized) {
         return -1;
     }
     
-    *stats = global_stats;
-    calculate_percentiles(stats);
+    stats_begin(stats, &hist);
+    for (i = 0; i < LATENCY_MAX_RINGS; i++) {
+        counters_merge(&rings[i].counters, stats, &hist);
+    }
+    stats_finish(stats, &hist);
     
     return 0;
 }
 
 /**
- * @brief Get latency statistics for a specific operation
+ * @brief Get latency statistics for an interned operation
  */
-int latency_get_stats_for_operation(const char* operation, latency_stats_t* stats) {
-    if (!operation || !stats || !latency_initialized) {
+int latency_get_stats_for_op(latency_op_t op, latency_stats_t* stats) {
+    latency_histogram_t hist;
+    
+    if (!stats || !latency_initialized || op >= LATENCY_MAX_OPS) {
         return -1;
     }
     
-    memset(stats, 0, sizeof(latency_stats_t));
-    stats->min_us = UINT32_MAX;
+    stats_begin(stats, &hist);
+    counters_merge(&ops[op].counters, stats, &hist);
+    stats_finish(stats, &hist);
     
-    if (!global_stats.samples) {
-        return -1;
-    }
+    return 0;
+}
+
+/**
+ * @brief Get latency statistics for a specific operation
+ */
+int latency_get_stats_for_operation(const char* operation, latency_stats_t* stats) {
+    latency_op_t op = latency_find_op(operation);
     
-    /* Filter samples by operation */
-    for (size_t i = 0; i < global_stats.sample_count; i++) {
-        const latency_sample_t* sample = &global_stats.samples[i];
-        if (sample->operation && strcmp(sample->operation, operation) == 0) {
-            stats->count++;
-            stats->sum_us += sample->latency_us;
-            
-            if (sample->latency_us < stats->min_us) {
-                stats->min_us = sample->latency_us;
-            }
-            if (sample->latency_us > stats->max_us) {
-                stats->max_us = sample->latency_us;
-            }
+    if (op == LATENCY_OP_INVALID) {
+        if (stats) {
+            memset(stats, 0, sizeof(latency_stats_t));
+            stats->min_us = UINT32_MAX;
+            stats->min_ns = UINT64_MAX;
         }
+        return latency_initialized && operation && stats ? 0 : -1;
     }
     
-    if (stats->count > 0) {
-        stats->avg_us = (uint32_t)(stats->sum_us / stats->count);
-    }
-    
-    return 0;
+    return latency_get_stats_for_op(op, stats);
 }
 
 /**
  * @brief Reset all latency statistics
  */
 void latency_reset_stats(void) {
+    int i;
+    
     if (!latency_initialized) {
         return;
     }
     
-    global_stats.count = 0;
-    global_stats.min_us = UINT32_MAX;
-    global_stats.max_us = 0;
-    global_stats.sum_us = 0;
-    global_stats.avg_us = 0;
-    global_stats.p50_us = 0;
-    global_stats.p95_us = 0;
-    global_stats.p99_us = 0;
-    global_stats.sample_count = 0;
+    for (i = 0; i < LATENCY_MAX_RINGS; i++) {
+        ring_reset(&rings[i]);
+    }
+    for (i = 0; i < LATENCY_MAX_OPS; i++) {
+        counters_reset(&ops[i].counters);
+    }
 }
 
 /**
@@ -270,15 +1008,13 @@ void latency_print_stats(const latency_stats_t* stats) {
     printf("Samples: %u\n", stats->count);
     
     if (stats->count > 0) {
-        printf("Min:     %u us (%.3f ms)\n", stats->min_us, stats->min_us / 1000.0);
-        printf("Max:     %u us (%.3f ms)\n", stats->max_us, stats->max_us / 1000.0);
-        printf("Avg:     %u us (%.3f ms)\n", stats->avg_us, stats->avg_us / 1000.0);
+        printf("Min:     %.3f us (%.3f ms)\n", stats->min_ns / 1000.0, stats->min_ns / 1000000.0);
+        printf("Max:     %.3f us (%.3f ms)\n", stats->max_ns / 1000.0, stats->max_ns / 1000000.0);
+        printf("Avg:     %.3f us (%.3f ms)\n", stats->avg_ns / 1000.0, stats->avg_ns / 1000000.0);
         
-        if (stats->sample_count > 0) {
-            printf("P50:     %u us (%.3f ms)\n", stats->p50_us, stats->p50_us / 1000.0);
-            printf("P95:     %u us (%.3f ms)\n", stats->p95_us, stats->p95_us / 1000.0);
-            printf("P99:     %u us (%.3f ms)\n", stats->p99_us, stats->p99_us / 1000.0);
-        }
+        printf("P50:     %.3f us (%.3f ms)\n", stats->p50_ns / 1000.0, stats->p50_ns / 1000000.0);
+        printf("P95:     %.3f us (%.3f ms)\n", stats->p95_ns / 1000.0, stats->p95_ns / 1000000.0);
+        printf("P99:     %.3f us (%.3f ms)\n", stats->p99_ns / 1000.0, stats->p99_ns / 1000000.0);
     } else {
         printf("No samples recorded\n");
     }
@@ -295,24 +1031,43 @@ void latency_print_all_stats(void) {
     }
 }
 
+/**
+ * @brief Merge ring counters only (no histogram walk)
+ */
+static void merge_ring_counters(latency_stats_t* stats) {
+    int i;
+    
+    memset(stats, 0, sizeof(latency_stats_t));
+    stats->min_ns = UINT64_MAX;
+    for (i = 0; i < LATENCY_MAX_RINGS; i++) {
+        counters_merge(&rings[i].counters, stats, NULL);
+    }
+    stats_finish(stats, NULL);
+}
+
 /**
  * @brief Get current average latency
  */
 uint32_t latency_get_avg(void) {
-    return global_stats.avg_us;
+    latency_stats_t stats;
+    merge_ring_counters(&stats);
+    return stats.avg_us;
 }
 
 /**
  * @brief Get current maximum latency
  */
 uint32_t latency_get_max(void) {
-    return global_stats.max_us;
+    latency_stats_t stats;
+    merge_ring_counters(&stats);
+    return stats.max_us;
 }
 
 /**
  * @brief Get current minimum latency
  */
 uint32_t latency_get_min(void) {
-    return global_stats.min_us == UINT32_MAX ? 0 : global_stats.min_us;
+    latency_stats_t stats;
+    merge_ring_counters(&stats);
+    return stats.min_us == UINT32_MAX ? 0 : stats.min_us;
 }
-
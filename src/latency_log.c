@@ -0,0 +1,397 @@
+/* mmap(), ftruncate() and msync() require POSIX.1-2001 */
+#if defined(__linux__) || defined(__unix__)
+#undef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include "../include/latency_log.h"
+#include "../include/latency.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sched.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+/**
+ * @file latency_log.c
+ * @brief Memory-mapped binary latency log
+ *
+ * Writers claim a record with fetch_add on the mapped head counter, clear
+ * the slot's seq, fill the record and then publish seq = index + 1. A
+ * reader (or a post-crash analysis) accepts a slot only if its seq matches
+ * the index it expects, so torn and overwritten records are skipped.
+ *
+ * Operation IDs are assigned per process (by name hash), so the records
+ * use the log's own IDs: each process operation is mapped by name
+ * to a slot of the file's op_names table (reused across runs, new names
+ * take the next free slot).
+ */
+
+_Static_assert(sizeof(latency_log_header_t) <= LATENCY_LOG_HEADER_SIZE,
+               "latency log header does not fit in LATENCY_LOG_HEADER_SIZE");
+_Static_assert(sizeof(latency_log_record_t) == 32, "latency log record must be 32 bytes");
+
+#define LOG_OP_UNMAPPED 0xFFFFu
+
+static latency_log_header_t* _Atomic log_header = NULL;
+static latency_log_record_t* log_records = NULL;
+static size_t log_map_size = 0;
+
+#ifndef _WIN32
+static _Atomic uint16_t log_op_map[LATENCY_MAX_OPS];   /* Process op ID -> log op ID */
+static atomic_uint log_writers = 0;                     /* Appends in progress */
+static pthread_mutex_t log_names_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief Map a process operation to the log's ID for the same name
+ * @return Log operation ID, or LOG_OP_UNMAPPED if unnamed or the table is full
+ */
+static uint16_t map_op(latency_log_header_t* header, latency_op_t op) {
+    const char* name = latency_op_name(op);
+    uint16_t mapped = LOG_OP_UNMAPPED;
+    int free_slot = -1;
+    int i;
+
+    if (!name || op >= LATENCY_MAX_OPS) {
+        return LOG_OP_UNMAPPED;
+    }
+
+    pthread_mutex_lock(&log_names_mutex);
+    for (i = 0; i < LATENCY_MAX_OPS; i++) {
+        if (header->op_names[i][0] == '\0') {
+            if (free_slot < 0) {
+                free_slot = i;
+            }
+        } else if (strncmp(header->op_names[i], name, LATENCY_LOG_NAME_LEN - 1) == 0) {
+            mapped = (uint16_t)i;
+            break;
+        }
+    }
+    if (mapped == LOG_OP_UNMAPPED && free_slot >= 0) {
+        strncpy(header->op_names[free_slot], name, LATENCY_LOG_NAME_LEN - 1);
+        mapped = (uint16_t)free_slot;
+    }
+    atomic_store(&log_op_map[op], mapped);
+    pthread_mutex_unlock(&log_names_mutex);
+
+    return mapped;
+}
+
+/**
+ * @brief Check that a mapped header describes a usable log
+ */
+static int header_valid(const latency_log_header_t* header, size_t file_size) {
+    return header->magic == LATENCY_LOG_MAGIC &&
+           header->version == LATENCY_LOG_VERSION &&
+           header->record_size == sizeof(latency_log_record_t) &&
+           header->capacity > 0 &&
+           file_size >= LATENCY_LOG_HEADER_SIZE + header->capacity * sizeof(latency_log_record_t);
+}
+#endif
+
+/**
+ * @brief Open (or create) the binary log and start appending to it
+ */
+int latency_log_open(const char* path, size_t max_records) {
+#ifdef _WIN32
+    (void)path;
+    (void)max_records;
+    fprintf(stderr, "[LatencyLog] Memory-mapped log not supported on this platform\n");
+    return -1;
+#else
+    latency_log_header_t* header;
+    struct stat st;
+    size_t map_size;
+    void* map;
+    int fd;
+    int i;
+
+    if (!path || atomic_load(&log_header)) {
+        return -1;
+    }
+
+    if (max_records == 0) {
+        max_records = LATENCY_LOG_DEFAULT_RECORDS;
+    }
+    map_size = LATENCY_LOG_HEADER_SIZE + max_records * sizeof(latency_log_record_t);
+
+    fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        fprintf(stderr, "[LatencyLog] Failed to open %s\n", path);
+        return -1;
+    }
+
+    if (fstat(fd, &st) != 0) {
+        fprintf(stderr, "[LatencyLog] Failed to stat %s\n", path);
+        close(fd);
+        return -1;
+    }
+    if (st.st_size == 0) {
+        /* New file */
+        if (ftruncate(fd, (off_t)map_size) != 0) {
+            fprintf(stderr, "[LatencyLog] Failed to size %s\n", path);
+            close(fd);
+            return -1;
+        }
+    } else if ((size_t)st.st_size != map_size) {
+        /* Never truncate a log written with another capacity */
+        fprintf(stderr, "[LatencyLog] %s holds %lld bytes, not a log of %zu records\n",
+                path, (long long)st.st_size, max_records);
+        close(fd);
+        return -1;
+    }
+
+    map = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);  /* The mapping keeps the file open */
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "[LatencyLog] Failed to map %s\n", path);
+        return -1;
+    }
+
+    header = (latency_log_header_t*)map;
+    if (header_valid(header, map_size) && header->capacity == max_records) {
+        printf("[LatencyLog] Continuing %s at record %llu\n", path,
+               (unsigned long long)atomic_load(&header->head));
+    } else if (header->magic != 0) {
+        /* Same size, but not a log this build can continue */
+        fprintf(stderr, "[LatencyLog] %s is not a compatible latency log\n", path);
+        munmap(map, map_size);
+        return -1;
+    } else {
+        /* New file, or sized before a crash and never initialized */
+        memset(map, 0, map_size);
+        header->magic = LATENCY_LOG_MAGIC;
+        header->version = LATENCY_LOG_VERSION;
+        header->record_size = sizeof(latency_log_record_t);
+        header->capacity = max_records;
+        header->created_ns = latency_get_timestamp_ns();
+        atomic_store(&header->head, 0);
+        printf("[LatencyLog] Created %s (%zu records, %zu bytes)\n", path, max_records, map_size);
+    }
+
+    /* Operations registered before the log was opened; later ones are
+     * mapped by their first append */
+    for (i = 0; i < LATENCY_MAX_OPS; i++) {
+        atomic_store(&log_op_map[i], LOG_OP_UNMAPPED);
+    }
+    for (i = 0; i < LATENCY_MAX_OPS; i++) {
+        map_op(header, (latency_op_t)i);
+    }
+
+    log_records = (latency_log_record_t*)((char*)map + LATENCY_LOG_HEADER_SIZE);
+    log_map_size = map_size;
+    atomic_store(&log_header, header);
+    return 0;
+#endif
+}
+
+/**
+ * @brief Flush and unmap the binary log
+ */
+void latency_log_close(void) {
+#ifndef _WIN32
+    latency_log_header_t* header = atomic_exchange(&log_header, NULL);
+
+    if (!header) {
+        return;
+    }
+
+    /* Let appends that loaded the header before the exchange finish */
+    while (atomic_load(&log_writers) != 0) {
+        sched_yield();
+    }
+
+    msync(header, log_map_size, MS_SYNC);
+    munmap(header, log_map_size);
+    log_records = NULL;
+    log_map_size = 0;
+#endif
+}
+
+/**
+ * @brief Check if a binary log is open
+ */
+int latency_log_is_open(void) {
+    return atomic_load(&log_header) != NULL;
+}
+
+/**
+ * @brief Flush mapped records to disk (msync)
+ */
+int latency_log_sync(void) {
+#ifdef _WIN32
+    return -1;
+#else
+    latency_log_header_t* header = atomic_load(&log_header);
+
+    if (!header) {
+        return -1;
+    }
+    return msync(header, log_map_size, MS_SYNC) == 0 ? 0 : -1;
+#endif
+}
+
+/**
+ * @brief Append one record
+ */
+void latency_log_append(latency_op_t op, uint64_t latency_ns, uint32_t code, uint64_t timestamp_ns) {
+#ifndef _WIN32
+    latency_log_header_t* header;
+    latency_log_record_t* record;
+    uint16_t log_op = LOG_OP_UNMAPPED;
+    uint64_t idx;
+
+    /* Announce the append before looking at the header, so that
+     * latency_log_close() waits for it before unmapping */
+    atomic_fetch_add(&log_writers, 1);
+    header = atomic_load(&log_header);
+    if (!header) {
+        atomic_fetch_sub(&log_writers, 1);
+        return;
+    }
+
+    if (op < LATENCY_MAX_OPS) {
+        log_op = atomic_load_explicit(&log_op_map[op], memory_order_relaxed);
+        if (log_op == LOG_OP_UNMAPPED) {
+            /* First record of a newly registered operation */
+            log_op = map_op(header, op);
+        }
+    }
+
+    idx = atomic_fetch_add_explicit(&header->head, 1, memory_order_relaxed);
+    record = &log_records[idx % header->capacity];
+
+    atomic_store_explicit(&record->seq, 0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    record->timestamp_ns = timestamp_ns;
+    record->latency_ns = latency_ns;
+    record->code = code;
+    record->op = log_op;
+    record->reserved = 0;
+    atomic_store_explicit(&record->seq, idx + 1, memory_order_release);
+
+    atomic_fetch_sub(&log_writers, 1);
+#else
+    (void)op;
+    (void)latency_ns;
+    (void)code;
+    (void)timestamp_ns;
+#endif
+}
+
+/**
+ * @brief Map an existing log read-only
+ */
+int latency_log_view_open(const char* path, latency_log_view_t* view) {
+#ifdef _WIN32
+    (void)path;
+    (void)view;
+    return -1;
+#else
+    struct stat st;
+    void* map;
+    int fd;
+
+    if (!path || !view) {
+        return -1;
+    }
+    memset(view, 0, sizeof(latency_log_view_t));
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < LATENCY_LOG_HEADER_SIZE) {
+        close(fd);
+        return -1;
+    }
+
+    map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return -1;
+    }
+
+    if (!header_valid((const latency_log_header_t*)map, (size_t)st.st_size)) {
+        munmap(map, (size_t)st.st_size);
+        return -1;
+    }
+
+    view->header = (const latency_log_header_t*)map;
+    view->records = (const latency_log_record_t*)((const char*)map + LATENCY_LOG_HEADER_SIZE);
+    view->map_size = (size_t)st.st_size;
+    return 0;
+#endif
+}
+
+/**
+ * @brief Unmap a log opened with latency_log_view_open
+ */
+void latency_log_view_close(latency_log_view_t* view) {
+#ifndef _WIN32
+    if (view && view->header) {
+        munmap((void*)view->header, view->map_size);
+    }
+#endif
+    if (view) {
+        memset(view, 0, sizeof(latency_log_view_t));
+    }
+}
+
+/**
+ * @brief Get the range of records still held by the ring
+ */
+uint64_t latency_log_view_range(const latency_log_view_t* view, uint64_t* first) {
+    uint64_t head;
+
+    if (!view || !view->header) {
+        if (first) {
+            *first = 0;
+        }
+        return 0;
+    }
+
+    head = atomic_load_explicit((_Atomic uint64_t*)&view->header->head, memory_order_acquire);
+    if (first) {
+        *first = head > view->header->capacity ? head - view->header->capacity : 0;
+    }
+    return head;
+}
+
+/**
+ * @brief Read one record as a latency sample
+ */
+int latency_log_view_get(const latency_log_view_t* view, uint64_t index, latency_sample_t* sample) {
+    const latency_log_record_t* record;
+
+    if (!view || !view->header || !sample) {
+        return -1;
+    }
+
+    record = &view->records[index % view->header->capacity];
+    if (atomic_load_explicit((_Atomic uint64_t*)&record->seq, memory_order_acquire) != index + 1) {
+        return -1;  /* Torn by a crash, still being written, or overwritten */
+    }
+
+    sample->timestamp_ns = record->timestamp_ns;
+    sample->latency_ns = record->latency_ns;
+    sample->code = record->code;
+    sample->op = record->op;
+    sample->operation = (record->op < LATENCY_MAX_OPS && view->header->op_names[record->op][0]) ?
+                        view->header->op_names[record->op] : "unknown";
+
+    /* Recheck: a live writer may have reused the slot during the copy */
+    atomic_thread_fence(memory_order_acquire);
+    if (atomic_load_explicit((_Atomic uint64_t*)&record->seq, memory_order_relaxed) != index + 1) {
+        return -1;
+    }
+    return 0;
+}
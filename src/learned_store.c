@@ -0,0 +1,441 @@
+/* fsync(), ftruncate() and pthread mutexes require POSIX.1-2001 */
+#if defined(__linux__) || defined(__unix__) || defined(__APPLE__)
+#undef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include "../include/learned_store.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <errno.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#endif
+
+/**
+ * @file learned_store.c
+ * @brief Append-only learned code log with an in-memory direct-indexed table
+ */
+
+_Static_assert(sizeof(learned_record_t) == 20, "learned record must be 20 bytes");
+
+/* Store State */
+static learned_code_t learned_table[LEARNED_MAX_DEVICES][256];    /* protocol 0 = empty */
+static learned_store_stats_t store_stats;
+static char store_path[1024];
+static int store_open = 0;
+static uint32_t next_sequence = 1;
+
+#ifndef _WIN32
+static int store_fd = -1;           /* -1 until the file exists */
+static pthread_mutex_t store_mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+/**
+ * @brief CRC-32 (IEEE 802.3, reflected)
+ */
+static uint32_t crc32(const void* data, size_t length) {
+    const uint8_t* bytes = (const uint8_t*)data;
+    uint32_t crc = 0xFFFFFFFFu;
+    size_t i;
+    int bit;
+
+    for (i = 0; i < length; i++) {
+        crc ^= bytes[i];
+        for (bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+        }
+    }
+    return ~crc;
+}
+
+/**
+ * @brief Check a record read from the log
+ */
+static int record_valid(const learned_record_t* record) {
+    return record->magic == LEARNED_RECORD_MAGIC &&
+           record->device < LEARNED_MAX_DEVICES &&
+           record->crc == crc32(record, offsetof(learned_record_t, crc));
+}
+
+/**
+ * @brief Fill a record for a key
+ */
+static void record_fill(learned_record_t* record, uint8_t device, unsigned char button_code,
+                        const learned_code_t* code) {
+    memset(record, 0, sizeof(*record));
+    record->magic = LEARNED_RECORD_MAGIC;
+    record->sequence = next_sequence++;
+    record->device = device;
+    record->button_code = button_code;
+    if (code) {
+        record->code = code->code;
+        record->protocol = code->protocol;
+        record->bit_length = code->bit_length;
+    }
+    record->crc = crc32(record, offsetof(learned_record_t, crc));
+}
+
+#ifndef _WIN32
+/**
+ * @brief Write a whole buffer
+ */
+static int write_all(int fd, const void* data, size_t length) {
+    const char* bytes = (const char*)data;
+
+    while (length > 0) {
+        ssize_t written = write(fd, bytes, length);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        bytes += written;
+        length -= (size_t)written;
+    }
+    return 0;
+}
+
+/**
+ * @brief Sync the directory holding the log, so a new or renamed entry
+ *        survives a crash
+ */
+static void sync_directory(void) {
+    char dir[sizeof(store_path)];
+    char* slash;
+    int fd;
+
+    strcpy(dir, store_path);
+    slash = strrchr(dir, '/');
+    if (!slash) {
+        strcpy(dir, ".");
+    } else if (slash == dir) {
+        dir[1] = '\0';
+    } else {
+        *slash = '\0';
+    }
+
+    fd = open(dir, O_RDONLY);
+    if (fd < 0 || fsync(fd) != 0) {
+        fprintf(stderr, "[LearnedStore] Failed to sync directory %s\n", dir);
+    }
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+/**
+ * @brief Append one record and sync it (lock held)
+ */
+static int append_record(const learned_record_t* record) {
+    struct stat st;
+    int created = 0;
+
+    if (store_fd < 0) {
+        store_fd = open(store_path, O_RDWR | O_CREAT | O_APPEND, 0644);
+        if (store_fd < 0) {
+            fprintf(stderr, "[LearnedStore] Failed to create %s\n", store_path);
+            return -1;
+        }
+        created = 1;
+    }
+
+    if (fstat(store_fd, &st) != 0) {
+        return -1;
+    }
+    if (write_all(store_fd, record, sizeof(*record)) != 0 || fsync(store_fd) != 0) {
+        /* Drop a partial record so the next append starts on a boundary */
+        if (ftruncate(store_fd, st.st_size) != 0) {
+            fprintf(stderr, "[LearnedStore] Failed to roll back %s\n", store_path);
+        }
+        fprintf(stderr, "[LearnedStore] Failed to write %s\n", store_path);
+        return -1;
+    }
+    if (created) {
+        sync_directory();
+    }
+
+    store_stats.records++;
+    return 0;
+}
+
+/**
+ * @brief Rewrite the log with the live records (lock held)
+ */
+static int compact_locked(void) {
+    char tmp_path[sizeof(store_path) + 8];
+    learned_record_t record;
+    uint32_t records = 0;
+    int fd;
+    int device, button;
+
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", store_path);
+    fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return -1;
+    }
+
+    for (device = 0; device < LEARNED_MAX_DEVICES; device++) {
+        for (button = 0; button < 256; button++) {
+            if (learned_table[device][button].protocol == 0) {
+                continue;
+            }
+            record_fill(&record, (uint8_t)device, (unsigned char)button, &learned_table[device][button]);
+            if (write_all(fd, &record, sizeof(record)) != 0) {
+                close(fd);
+                unlink(tmp_path);
+                return -1;
+            }
+            records++;
+        }
+    }
+
+    /* The new log must be on disk before it replaces the old one */
+    if (fsync(fd) != 0 || close(fd) != 0 || rename(tmp_path, store_path) != 0) {
+        unlink(tmp_path);
+        return -1;
+    }
+    sync_directory();
+
+    if (store_fd >= 0) {
+        close(store_fd);
+    }
+    store_fd = open(store_path, O_RDWR | O_APPEND);
+    store_stats.records = records;
+    store_stats.compactions++;
+    return store_fd >= 0 ? 0 : -1;
+}
+
+/**
+ * @brief Compact once superseded records dominate the log (lock held)
+ */
+static void maybe_compact(void) {
+    if (store_stats.records > 2 * store_stats.live + LEARNED_COMPACT_SLACK) {
+        if (compact_locked() != 0) {
+            fprintf(stderr, "[LearnedStore] Compaction of %s failed, keeping the log\n", store_path);
+        }
+    }
+}
+#endif
+
+/**
+ * @brief Apply a record to the in-memory table
+ */
+static void table_apply(const learned_record_t* record) {
+    learned_code_t* slot = &learned_table[record->device][record->button_code];
+
+    if (slot->protocol == 0 && record->protocol != 0) {
+        store_stats.live++;
+    } else if (slot->protocol != 0 && record->protocol == 0) {
+        store_stats.live--;
+    }
+    slot->code = record->code;
+    slot->protocol = record->protocol;
+    slot->bit_length = record->bit_length;
+}
+
+int learned_store_open(const char* path) {
+#ifdef _WIN32
+    (void)path;
+    fprintf(stderr, "[LearnedStore] Learned code store not supported on this platform\n");
+    return -1;
+#else
+    learned_record_t record;
+    off_t size = 0;
+    ssize_t got;
+
+    if (!path) {
+        path = getenv(LEARNED_STORE_PATH_ENV);
+        if (!path) {
+            path = LEARNED_STORE_DEFAULT_PATH;
+        }
+    }
+    if (strlen(path) >= sizeof(store_path)) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&store_mutex);
+    if (store_open) {
+        pthread_mutex_unlock(&store_mutex);
+        return 0;
+    }
+
+    memset(learned_table, 0, sizeof(learned_table));
+    memset(&store_stats, 0, sizeof(store_stats));
+    strcpy(store_path, path);
+    next_sequence = 1;
+
+    store_fd = open(store_path, O_RDWR | O_APPEND);
+    if (store_fd < 0 && errno != ENOENT) {
+        pthread_mutex_unlock(&store_mutex);
+        fprintf(stderr, "[LearnedStore] Failed to open %s\n", store_path);
+        return -1;
+    }
+
+    if (store_fd >= 0) {
+        /* Replay the log. Records are fixed-size, so a corrupt one is
+         * skipped and the records after it still apply; compaction later
+         * drops it from the file. */
+        while ((got = read(store_fd, &record, sizeof(record))) == (ssize_t)sizeof(record)) {
+            size += (off_t)sizeof(record);
+            store_stats.records++;
+            if (!record_valid(&record)) {
+                store_stats.dropped++;
+                continue;
+            }
+            table_apply(&record);
+            if (record.sequence >= next_sequence) {
+                next_sequence = record.sequence + 1;
+            }
+        }
+        if (store_stats.dropped > 0) {
+            fprintf(stderr, "[LearnedStore] Skipped %u corrupt records in %s\n",
+                    store_stats.dropped, store_path);
+        }
+
+        /* Only a record torn by a crash during its write is cut off, so the
+         * next append starts on a record boundary */
+        if (got > 0) {
+            store_stats.dropped++;
+            fprintf(stderr, "[LearnedStore] Dropping %lld torn bytes at the end of %s\n",
+                    (long long)got, store_path);
+            if (ftruncate(store_fd, size) != 0 || fsync(store_fd) != 0) {
+                fprintf(stderr, "[LearnedStore] Failed to truncate %s\n", store_path);
+            }
+        }
+    }
+
+    store_open = 1;
+    maybe_compact();
+    pthread_mutex_unlock(&store_mutex);
+
+    printf("[LearnedStore] Loaded %u learned codes from %s\n", store_stats.live, store_path);
+    return 0;
+#endif
+}
+
+void learned_store_close(void) {
+#ifndef _WIN32
+    pthread_mutex_lock(&store_mutex);
+    if (store_fd >= 0) {
+        close(store_fd);
+        store_fd = -1;
+    }
+    store_open = 0;
+    memset(learned_table, 0, sizeof(learned_table));
+    pthread_mutex_unlock(&store_mutex);
+#endif
+}
+
+int learned_store_is_open(void) {
+    return store_open;
+}
+
+int learned_store_put(uint8_t device, unsigned char button_code, const learned_code_t* code) {
+#ifdef _WIN32
+    (void)device;
+    (void)button_code;
+    (void)code;
+    return -1;
+#else
+    learned_record_t record;
+    int result = -1;
+
+    if (device >= LEARNED_MAX_DEVICES || !code || code->protocol == 0) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&store_mutex);
+    if (store_open) {
+        record_fill(&record, device, button_code, code);
+        if (append_record(&record) == 0) {
+            table_apply(&record);
+            maybe_compact();
+            result = 0;
+        }
+    }
+    pthread_mutex_unlock(&store_mutex);
+    return result;
+#endif
+}
+
+int learned_store_get(uint8_t device, unsigned char button_code, learned_code_t* code) {
+    int result = -1;
+
+    if (device >= LEARNED_MAX_DEVICES) {
+        return -1;
+    }
+
+#ifndef _WIN32
+    pthread_mutex_lock(&store_mutex);
+#endif
+    if (store_open && learned_table[device][button_code].protocol != 0) {
+        if (code) {
+            *code = learned_table[device][button_code];
+        }
+        result = 0;
+    }
+#ifndef _WIN32
+    pthread_mutex_unlock(&store_mutex);
+#endif
+    return result;
+}
+
+int learned_store_erase(uint8_t device, unsigned char button_code) {
+#ifdef _WIN32
+    (void)device;
+    (void)button_code;
+    return -1;
+#else
+    learned_record_t record;
+    int result = -1;
+
+    if (device >= LEARNED_MAX_DEVICES) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&store_mutex);
+    if (store_open) {
+        if (learned_table[device][button_code].protocol == 0) {
+            result = 0;
+        } else {
+            record_fill(&record, device, button_code, NULL);
+            if (append_record(&record) == 0) {
+                table_apply(&record);
+                maybe_compact();
+                result = 0;
+            }
+        }
+    }
+    pthread_mutex_unlock(&store_mutex);
+    return result;
+#endif
+}
+
+int learned_store_compact(void) {
+#ifdef _WIN32
+    return -1;
+#else
+    int result = -1;
+
+    pthread_mutex_lock(&store_mutex);
+    if (store_open) {
+        result = compact_locked();
+    }
+    pthread_mutex_unlock(&store_mutex);
+    return result;
+#endif
+}
+
+void learned_store_get_stats(learned_store_stats_t* stats) {
+    if (stats) {
+        *stats = store_stats;
+    }
+}
@@ -1,30 +1,16 @@
 #include "../include/remote_control.h"
 #include "../include/remote_buttons.h"
+#include "../include/button_table.h"
 #include "../include/handlers.h"
 #include "../include/connection.h"
 #include "../include/system_handler.h"
 #include "../include/latency.h"
+#include "../include/trace.h"
 #ifdef SIMULATOR
 #include "../include/tv_simulator.h"
 #endif
 #include <stdio.h>
 #include <stdlib.h>
-#include <string.h>
-
-/* External handler registration (from handlers.c) */
-extern handlers_t registered_handlers;
-
-/* External connection config (from connection.c) */
-extern connection_config_t connection_config;
-
-/* Delay function for retries */
-static void delay_ms(uint32_t ms) {
-#ifdef _WIN32
-    Sleep(ms);
-#else
-    usleep(ms * 1000);
-#endif
-}
 
 /* Remote Control State */
 static remote_state_t remote_state = {
@@ -41,145 +27,9 @@ static int universal_mode_enabled = 0;
  * @brief Get button name from button code
  */
 const char* get_button_name(unsigned char button_code) {
-    switch (button_code) {
-        /* Streaming Services */
-        case BUTTON_YOUTUBE: return "YouTube";
-        case BUTTON_NETFLIX: return "Netflix";
-        case BUTTON_AMAZON_PRIME: return "Amazon Prime";
-        case BUTTON_HBO_MAX: return "HBO Max";
-        
-        /* Basic Controls */
-        case BUTTON_POWER: return "Power";
-        case BUTTON_VOLUME_UP: return "Volume Up";
-        case BUTTON_VOLUME_DOWN: return "Volume Down";
-        case BUTTON_MUTE: return "Mute";
-        case BUTTON_CHANNEL_UP: return "Channel Up";
-        case BUTTON_CHANNEL_DOWN: return "Channel Down";
-        
-        /* Navigation */
-        case BUTTON_HOME: return "Home";
-        case BUTTON_MENU: return "Menu";
-        case BUTTON_BACK: return "Back";
-        case BUTTON_EXIT: return "Exit";
-        case BUTTON_OPTIONS: return "Options";
-        case BUTTON_INPUT: return "Input";
-        case BUTTON_SOURCE: return "Source";
-        
-        /* Directional Pad */
-        case BUTTON_UP: return "Up";
-        case BUTTON_DOWN: return "Down";
-        case BUTTON_LEFT: return "Left";
-        case BUTTON_RIGHT: return "Right";
-        case BUTTON_OK: return "OK";
-        case BUTTON_ENTER: return "Enter";
-        
-        /* Playback Controls */
-        case BUTTON_PLAY: return "Play";
-        case BUTTON_PAUSE: return "Pause";
-        case BUTTON_STOP: return "Stop";
-        case BUTTON_FAST_FORWARD: return "Fast Forward";
-        case BUTTON_REWIND: return "Rewind";
-        case BUTTON_RECORD: return "Record";
-        
-        /* Number Pad */
-        case BUTTON_0: return "0";
-        case BUTTON_1: return "1";
-        case BUTTON_2: return "2";
-        case BUTTON_3: return "3";
-        case BUTTON_4: return "4";
-        case BUTTON_5: return "5";
-        case BUTTON_6: return "6";
-        case BUTTON_7: return "7";
-        case BUTTON_8: return "8";
-        case BUTTON_9: return "9";
-        case BUTTON_DASH: return "Dash (-)";
-        
-        /* Color Buttons */
-        case BUTTON_RED: return "Red";
-        case BUTTON_GREEN: return "Green";
-        case BUTTON_YELLOW: return "Yellow";
-        case BUTTON_BLUE: return "Blue";
-        
-        /* Advanced TV Controls */
-        case BUTTON_INFO: return "Info";
-        case BUTTON_GUIDE: return "Guide";
-        case BUTTON_SETTINGS: return "Settings";
-        case BUTTON_CC: return "Closed Captions";
-        case BUTTON_SUBTITLES: return "Subtitles";
-        case BUTTON_SAP: return "SAP";
-        case BUTTON_AUDIO: return "Audio";
-        case BUTTON_SLEEP: return "Sleep";
-        case BUTTON_PICTURE_MODE: return "Picture Mode";
-        case BUTTON_ASPECT: return "Aspect";
-        case BUTTON_ZOOM: return "Zoom";
-        case BUTTON_P_SIZE: return "Picture Size";
-        
-        /* Smart TV Features */
-        case BUTTON_VOICE: return "Voice";
-        case BUTTON_MIC: return "Microphone";
-        case BUTTON_LIVE_TV: return "Live TV";
-        case BUTTON_STREAM: return "Stream";
-        
-        /* System & Diagnostic */
-        case BUTTON_DISPLAY: return "Display";
-        case BUTTON_STATUS: return "Status";
-        case BUTTON_HELP: return "Help";
-        case BUTTON_E_MANUAL: return "E-Manual";
-        
-        /* Gaming Controls */
-        case BUTTON_GAME_MODE: return "Game Mode";
-        
-        /* Picture Controls */
-        case BUTTON_MOTION: return "Motion";
-        case BUTTON_BACKLIGHT: return "Backlight";
-        case BUTTON_BRIGHTNESS: return "Brightness";
-        
-        /* Audio Controls */
-        case BUTTON_SOUND_MODE: return "Sound Mode";
-        case BUTTON_SYNC: return "Sync";
-        case BUTTON_SOUND_OUTPUT: return "Sound Output";
-        
-        /* Input & Connectivity */
-        case BUTTON_MULTI_VIEW: return "Multi View";
-        case BUTTON_PIP: return "Picture in Picture";
-        case BUTTON_SCREEN_MIRROR: return "Screen Mirror";
-
-        /* Room / Smart Home Automation */
-        case BUTTON_ROOM_SCENE_MOVIE: return "Room: Movie";
-        case BUTTON_ROOM_SCENE_RELAX: return "Room: Relax";
-        case BUTTON_ROOM_SCENE_OFF: return "Room: Off";
-        case BUTTON_ROOM_LIGHTS_DIM: return "Room: Lights Dim";
-        case BUTTON_ROOM_LIGHTS_FULL: return "Room: Lights Full";
-        case BUTTON_ROOM_SMART_PLUG1: return "Room: Plug 1";
-        case BUTTON_ROOM_SMART_SPEAKER: return "Room: Speaker";
-        case BUTTON_ROOM_AMBIENT_STRIP: return "Room: Ambient";
-        case BUTTON_ROOM_SMART_PLUG2: return "Room: Plug 2";
-        case BUTTON_ROOM_SMART_PLUG3: return "Room: Plug 3";
-        case BUTTON_ROOM_KITCHEN_LIGHT: return "Room: Kitchen Light";
-        case BUTTON_ROOM_FRIDGE: return "Room: Fridge";
-        case BUTTON_ROOM_OVEN: return "Room: Oven";
-        case BUTTON_ROOM_BEDROOM_LAMP: return "Room: Bedroom Lamp";
-        case BUTTON_ROOM_BATHROOM_LIGHT: return "Room: Bathroom Light";
-        case BUTTON_ROOM_UPSTAIRS_HALL: return "Room: Upstairs Hall";
-        case BUTTON_ROOM_ENTRY_LIGHT: return "Room: Entry Light";
-        case BUTTON_ROOM_UPSTAIRS_BEDROOM: return "Room: Upstairs Bedroom";
-        case BUTTON_ROOM_UPSTAIRS_BATHROOM: return "Room: Upstairs Bathroom";
-        case BUTTON_ROOM_HOOD_LIGHT: return "Room: Hood Light";
-        case BUTTON_ROOM_THERMOSTAT_UP: return "Room: Thermostat Up";
-        case BUTTON_ROOM_THERMOSTAT_DOWN: return "Room: Thermostat Down";
-        case BUTTON_ROOM_AC_ON: return "Room: AC On";
-        case BUTTON_ROOM_HEATING_ON: return "Room: Heating On";
-        case BUTTON_ROOM_GARAGE_DOOR: return "Room: Garage Door";
-        case BUTTON_ROOM_DOOR_LOCK: return "Room: Door Lock";
-        case BUTTON_ROOM_SECURITY_ARM: return "Room: Security Arm";
-        case BUTTON_ROOM_BLINDS_OPEN: return "Room: Blinds Open";
-        case BUTTON_ROOM_BLINDS_CLOSE: return "Room: Blinds Close";
-        case BUTTON_ROOM_CEILING_FAN: return "Room: Ceiling Fan";
-        case BUTTON_ROOM_LIVING_ROOM_LIGHT: return "Room: Living Room Light";
-        case BUTTON_ROOM_DINING_ROOM_LIGHT: return "Room: Dining Room Light";
-        
-        default: return "UNKNOWN";
-    }
+    const button_info_t* info = button_table_lookup(button_code);
+    
+    return (info->flags & BUTTON_FLAG_VALID) ? info->name : "UNKNOWN";
 }
 
 /**
@@ -210,37 +60,59 @@ int remote_init(void) {
     }
 #endif
     
+    /* Bring up handlers, connection management and the IR transmitter */
+    handler_init();
+    connection_init();
+    if (ir_init() != 0) {
+        fprintf(stderr, "[Remote] Failed to initialize IR transmitter\n");
+        return -1;
+    }
+    
     /* Use system handler for initialization */
-    return system_init();
+    if (system_init() != 0) {
+        return -1;
+    }
+    
+    remote_initialized = 1;
+    return 0;
 }
 
 /**
- * @brief Press a button on the remote
+ * @brief Press (and optionally hold) a button on the remote
+ * @param hold_ms Hold time in ms (0 = single press)
  */
-int remote_press_button(unsigned char button_code) {
+static int remote_press_internal(unsigned char button_code, uint32_t hold_ms) {
     if (!remote_initialized) {
         fprintf(stderr, "[Remote] Error: Remote not initialized. Call remote_init() first.\n");
         return -1;
     }
     
-    const char* button_name = get_button_name(button_code);
-    if (strcmp(button_name, "UNKNOWN") == 0) {
+    const button_info_t* button = button_table_lookup(button_code);
+    if (!(button->flags & BUTTON_FLAG_VALID)) {
         fprintf(stderr, "[Remote] Error: Unknown button code: 0x%02X\n", button_code);
         handler_trigger_error(ERROR_INVALID_BUTTON, "Unknown button code");
         return -1;
     }
     
-    printf("[Remote] Pressing button: %s (0x%02X)\n", button_name, button_code);
+    if (hold_ms > 0) {
+        printf("[Remote] Holding button: %s (0x%02X) for %u ms\n", button->name, button_code, hold_ms);
+    } else {
+        printf("[Remote] Pressing button: %s (0x%02X)\n", button->name, button_code);
+    }
     
     /* Measure latency: Button press to IR transmission */
-    uint64_t button_start = LATENCY_MEASURE_START();
+    uint64_t button_start = LATENCY_MEASURE_START_NS();
     
 #ifdef SIMULATOR
     /* Route through assembly ISR so the real interrupt path is exercised:
      * interrupt_set_button -> ir_gpio_interrupt_handler (assembly) -> interrupt_callback
-     * -> tv_simulator_send_button + handler_trigger_button_pressed */
+     * (top half), then interrupt_process_deferred -> tv_simulator_send_button
+     * + handler_trigger_button_pressed (bottom half) */
     interrupt_set_button(button_code);
     ir_gpio_interrupt_handler();
+    if (!interrupt_worker_is_running()) {
+        interrupt_process_deferred();
+    }
 #else
     /* Trigger button press event (non-simulator path) */
     handler_trigger_button_pressed(button_code);
@@ -290,48 +162,72 @@ int remote_press_button(unsigned char button_code) {
         case BUTTON_8:
         case BUTTON_9:
             /* Channel number entry would be handled by a state machine */
-            printf("[Remote] Number pad: %s\n", button_name);
+            printf("[Remote] Number pad: %s\n", button->name);
             break;
     }
     
+    /* Room buttons are handled by the simulator and have no IR code */
+    if (button->flags & BUTTON_FLAG_NO_IR) {
+        printf("[Remote] %s has no IR code, nothing to transmit\n", button->name);
+        LATENCY_MEASURE_END_NS(button_start, "button_press", button_code);
+        return 0;
+    }
+    
     /* Ensure connection before sending - always verify and establish if needed */
     unsigned char current_connected = connection_get_connected_device();
     if (!remote_is_connected() || remote_state.current_device != current_connected) {
         printf("[Remote] Ensuring connection to device %d...\n", remote_state.current_device);
+        /* connection_establish() already retries with the configured budget */
         if (remote_ensure_connection(remote_state.current_device) != 0) {
             fprintf(stderr, "[Remote] Failed to establish connection to device %d\n", remote_state.current_device);
             handler_trigger_error(ERROR_TRANSMISSION_FAILED, "Connection not established");
-            
-            /* Try one more time with a delay */
-            printf("[Remote] Retrying connection establishment...\n");
-            delay_ms(connection_config.retry_delay_ms);
-            if (remote_ensure_connection(remote_state.current_device) != 0) {
-                fprintf(stderr, "[Remote] Connection establishment failed after retry\n");
-                return -1;
-            }
-            printf("[Remote] Connection established on retry\n");
+            return -1;
         }
     }
     
     /* Get IR code and send it with connection retry */
     ir_code_t ir_code = get_ir_code(button_code);
-    if (connection_send_with_retry(ir_code) != 0) {
+    int send_result = (hold_ms > 0) ? connection_send_hold_with_retry(ir_code, hold_ms)
+                                    : connection_send_with_retry(ir_code);
+    if (send_result != 0) {
         fprintf(stderr, "[Remote] Failed to send IR code\n");
         handler_trigger_error(ERROR_TRANSMISSION_FAILED, "Failed to send IR code");
         return -1;
     }
     
     /* Trigger state change if applicable */
-    if (registered_handlers.state_changed != NULL) {
-        registered_handlers.state_changed();
-    }
+    handler_trigger_state_changed();
     
     /* Measure latency: Complete button press */
-    LATENCY_MEASURE_END(button_start, "button_press", button_code);
+    LATENCY_MEASURE_END_NS(button_start, "button_press", button_code);
     
     return 0;
 }
 
+/**
+ * @brief Press a button on the remote
+ */
+int remote_press_button(unsigned char button_code) {
+    int result;
+    
+    trace_begin("remote_press_button", button_code);
+    result = remote_press_internal(button_code, 0);
+    trace_end("remote_press_button");
+    return result;
+}
+
+/**
+ * @brief Hold a button on the remote
+ */
+int remote_hold_button(unsigned char button_code, uint32_t hold_ms) {
+    int result;
+    
+    trace_begin("remote_hold_button", button_code);
+    result = remote_press_internal(button_code, hold_ms);
+    trace_end("remote_hold_button");
+    return result;
+}
+
 /**
  * @brief Get current remote state
  */
@@ -362,9 +258,7 @@ int remote_set_device(unsigned char device_type) {
     printf("[Remote] Device set to: %s\n", device_name);
     
     /* Trigger state change event */
-    if (registered_handlers.state_changed != NULL) {
-        registered_handlers.state_changed();
-    }
+    handler_trigger_state_changed();
     
     return 0;
 }
@@ -415,6 +309,7 @@ static void remote_cleanup_internal(void) {
  * @brief Cleanup remote control system
  */
 void remote_cleanup(void) {
+    remote_cleanup_internal();
     system_cleanup();
     system_handler_cleanup();
 }
@@ -141,7 +141,9 @@ int system_handler_register_health_check(system_health_check_handler_t handler)
  * @brief Initialize entire system
  */
 int system_init(void) {
+    /* system_handler_init() leaves the state at INITIALIZING */
     if (system_state != SYSTEM_STATE_UNINITIALIZED && 
+        system_state != SYSTEM_STATE_INITIALIZING &&
         system_state != SYSTEM_STATE_SHUTDOWN) {
         fprintf(stderr, "[System] Error: System already initialized or in invalid state\n");
         return -1;
@@ -0,0 +1,205 @@
+/* clock_nanosleep() requires POSIX.1-2001 */
+#if defined(__linux__) || defined(__unix__)
+#undef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include "../include/timebase.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+/**
+ * @file timebase.c
+ * @brief Realtime and virtual clock backends
+ */
+
+/* ============================================================================
+ * REALTIME BACKEND
+ * ============================================================================ */
+
+static uint64_t realtime_now_ns(void) {
+#ifdef _WIN32
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (uint64_t)(counter.QuadPart / frequency.QuadPart) * 1000000000ULL +
+           (uint64_t)(counter.QuadPart % frequency.QuadPart) * 1000000000ULL / frequency.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+static void realtime_sleep_us(uint32_t us) {
+    if (us == 0) return;
+
+#ifdef _WIN32
+    /* Windows: Use Sleep for milliseconds, QueryPerformanceCounter for microseconds */
+    if (us >= 1000) {
+        Sleep(us / 1000);
+        us = us % 1000;
+    }
+    if (us > 0) {
+        LARGE_INTEGER frequency, start, end;
+        QueryPerformanceFrequency(&frequency);
+        QueryPerformanceCounter(&start);
+        do {
+            QueryPerformanceCounter(&end);
+        } while (frequency.QuadPart > 0 &&
+                 (end.QuadPart - start.QuadPart) * 1000000 / frequency.QuadPart < us);
+    }
+#elif defined(__linux__) || defined(__unix__)
+    struct timespec req;
+    req.tv_sec = us / 1000000;
+    req.tv_nsec = (long)(us % 1000000) * 1000;  /* Convert microseconds to nanoseconds */
+    nanosleep(&req, NULL);
+#else
+    /* Generic: Busy wait (not precise) */
+    volatile uint32_t count = us * 100;  /* Approximate */
+    while (count--);
+#endif
+}
+
+static void realtime_sleep_until_ns(uint64_t deadline_ns) {
+    uint64_t spin_window = (uint64_t)TIMEBASE_SPIN_US * 1000ULL;
+    uint64_t now = realtime_now_ns();
+
+    if (now >= deadline_ns) {
+        return;  /* Already late */
+    }
+
+    /* Coarse phase: sleep until shortly before the deadline */
+    if (deadline_ns - now > spin_window) {
+        uint64_t wake_ns = deadline_ns - spin_window;
+#ifdef _WIN32
+        DWORD ms = (DWORD)((wake_ns - now) / 1000000ULL);
+        if (ms > 0) {
+            Sleep(ms);
+        }
+#elif defined(__linux__)
+        struct timespec ts;
+        ts.tv_sec = (time_t)(wake_ns / 1000000000ULL);
+        ts.tv_nsec = (long)(wake_ns % 1000000000ULL);
+        /* Absolute sleep: restarting after a signal keeps the same target */
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) != 0) {
+            if (realtime_now_ns() >= wake_ns) {
+                break;
+            }
+        }
+#else
+        struct timespec req;
+        uint64_t rel_ns = wake_ns - now;
+        req.tv_sec = (time_t)(rel_ns / 1000000000ULL);
+        req.tv_nsec = (long)(rel_ns % 1000000000ULL);
+        nanosleep(&req, NULL);
+#endif
+    }
+
+    /* Fine phase: spin for the final microseconds */
+    while (realtime_now_ns() < deadline_ns) {
+        /* busy wait */
+    }
+}
+
+static const timebase_backend_t realtime_backend = {
+    .name = "realtime",
+    .now_ns = realtime_now_ns,
+    .sleep_us = realtime_sleep_us,
+    .sleep_until_ns = realtime_sleep_until_ns
+};
+
+/* ============================================================================
+ * VIRTUAL BACKEND
+ * ============================================================================ */
+
+static _Atomic uint64_t virtual_now = 0;
+
+static uint64_t virtual_now_ns(void) {
+    return atomic_load(&virtual_now);
+}
+
+static void virtual_sleep_us(uint32_t us) {
+    atomic_fetch_add(&virtual_now, (uint64_t)us * 1000ULL);
+}
+
+static void virtual_sleep_until_ns(uint64_t deadline_ns) {
+    uint64_t now = atomic_load(&virtual_now);
+
+    /* Move forward only; concurrent sleepers keep the latest deadline */
+    while (now < deadline_ns &&
+           !atomic_compare_exchange_weak(&virtual_now, &now, deadline_ns)) {
+        /* retry with refreshed now */
+    }
+}
+
+static const timebase_backend_t virtual_backend = {
+    .name = "virtual",
+    .now_ns = virtual_now_ns,
+    .sleep_us = virtual_sleep_us,
+    .sleep_until_ns = virtual_sleep_until_ns
+};
+
+/* ============================================================================
+ * PUBLIC FUNCTIONS
+ * ============================================================================ */
+
+#ifdef TIMEBASE_VIRTUAL
+static const timebase_backend_t* _Atomic active_backend = &virtual_backend;
+#else
+static const timebase_backend_t* _Atomic active_backend = &realtime_backend;
+#endif
+
+int timebase_set_backend(const timebase_backend_t* backend) {
+    if (backend == NULL) {
+        backend = &realtime_backend;
+    }
+
+    if (!backend->now_ns || !backend->sleep_us || !backend->sleep_until_ns) {
+        return -1;
+    }
+
+    atomic_store(&active_backend, backend);
+    return 0;
+}
+
+const timebase_backend_t* timebase_get_backend(void) {
+    return atomic_load(&active_backend);
+}
+
+void timebase_use_realtime(void) {
+    timebase_set_backend(&realtime_backend);
+}
+
+void timebase_use_virtual(uint64_t start_ns) {
+    atomic_store(&virtual_now, start_ns);
+    timebase_set_backend(&virtual_backend);
+}
+
+int timebase_is_virtual(void) {
+    return atomic_load(&active_backend) == &virtual_backend;
+}
+
+void timebase_advance_ns(uint64_t ns) {
+    if (timebase_is_virtual()) {
+        atomic_fetch_add(&virtual_now, ns);
+    }
+}
+
+uint64_t timebase_now_ns(void) {
+    return atomic_load(&active_backend)->now_ns();
+}
+
+void timebase_sleep_us(uint32_t us) {
+    atomic_load(&active_backend)->sleep_us(us);
+}
+
+void timebase_sleep_until_ns(uint64_t deadline_ns) {
+    atomic_load(&active_backend)->sleep_until_ns(deadline_ns);
+}
@@ -0,0 +1,717 @@
+/* pthreads and clock_gettime() require POSIX.1-2001 */
+#if defined(__linux__) || defined(__unix__)
+#undef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include "../include/timer_wheel.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#endif
+
+/**
+ * @file timer_wheel.c
+ * @brief Hierarchical timer wheel driven by timerfd + epoll
+ *
+ * A timer in level L sits in slot (expires >> 6L) & 63. Whenever the low
+ * 6L bits of the current tick wrap to zero, the level-L slot for the new
+ * block is emptied and its timers are relinked one level down (cascade).
+ * A 64-bit occupancy mask per level finds the next non-empty slot with a
+ * single count-trailing-zeros, which is how the wheel skips idle ticks.
+ */
+
+/* Timer States */
+enum {
+    TIMER_FREE = 0,             /* On the free list */
+    TIMER_PENDING,              /* Linked into a wheel slot */
+    TIMER_RUNNING,              /* Callback in progress */
+    TIMER_CANCELLED             /* Cancelled while its callback was running */
+};
+
+/* Timer Node (pool entry) */
+typedef struct timer_node {
+    struct timer_node* next;
+    struct timer_node* prev;
+    uint64_t expires;               /* Expiration tick */
+    uint32_t period;                /* Repeat interval in ticks (0 = one-shot) */
+    timer_wheel_callback_t callback;
+    void* context;
+    timer_id_t id;                  /* Generation << 16 | (index + 1) */
+    uint8_t state;
+    uint8_t level;
+    uint8_t slot;
+} timer_node_t;
+
+#define SLOT_MASK   (TIMER_WHEEL_SLOTS - 1)
+#define NO_TICK     UINT64_MAX
+
+static timer_node_t* pool = NULL;
+static timer_node_t* free_list = NULL;
+static size_t pool_size = 0;
+static uint16_t next_generation = 1;
+
+static timer_node_t* wheel[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+static uint64_t occupied[TIMER_WHEEL_LEVELS];   /* Bit per non-empty slot */
+static uint64_t wheel_tick = 0;                 /* Last tick processed */
+static uint64_t epoch_ns = 0;                   /* Tick 0 */
+static timer_wheel_stats_t wheel_stats;
+
+static int wheel_users = 0;                     /* Unbalanced timer_wheel_init() calls */
+
+#ifdef _WIN32
+static SRWLOCK wheel_mutex = SRWLOCK_INIT;
+static SRWLOCK lifecycle_mutex = SRWLOCK_INIT;  /* init/start/cleanup */
+#else
+static pthread_mutex_t wheel_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t lifecycle_mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+#ifdef __linux__
+static int timer_fd = -1;
+static int wake_fd = -1;
+static int epoll_fd = -1;
+static uint64_t armed_tick = NO_TICK;
+static _Atomic int wheel_running = 0;
+static pthread_t wheel_thread;
+#endif
+
+static void wheel_lock(void) {
+#ifdef _WIN32
+    AcquireSRWLockExclusive(&wheel_mutex);
+#else
+    pthread_mutex_lock(&wheel_mutex);
+#endif
+}
+
+static void wheel_unlock(void) {
+#ifdef _WIN32
+    ReleaseSRWLockExclusive(&wheel_mutex);
+#else
+    pthread_mutex_unlock(&wheel_mutex);
+#endif
+}
+
+static void lifecycle_lock(void) {
+#ifdef _WIN32
+    AcquireSRWLockExclusive(&lifecycle_mutex);
+#else
+    pthread_mutex_lock(&lifecycle_mutex);
+#endif
+}
+
+static void lifecycle_unlock(void) {
+#ifdef _WIN32
+    ReleaseSRWLockExclusive(&lifecycle_mutex);
+#else
+    pthread_mutex_unlock(&lifecycle_mutex);
+#endif
+}
+
+/**
+ * @brief Monotonic time in nanoseconds (independent of the timebase backend)
+ */
+static uint64_t monotonic_ns(void) {
+#ifdef _WIN32
+    return (uint64_t)GetTickCount64() * 1000000ULL;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+/* ============================================================================
+ * WHEEL
+ * ============================================================================ */
+
+/**
+ * @brief Link a timer into the slot for its expiration tick
+ */
+static void slot_link(timer_node_t* node) {
+    uint64_t expires = node->expires;
+    uint64_t delta;
+    int level = 0;
+    int slot;
+
+    /* Far timers wait in the last level and are relinked when it comes up */
+    if (expires - wheel_tick > TIMER_WHEEL_MAX_DELAY_MS) {
+        expires = wheel_tick + TIMER_WHEEL_MAX_DELAY_MS;
+    }
+    delta = expires - wheel_tick;
+
+    while (level < TIMER_WHEEL_LEVELS - 1 &&
+           delta >= (1ULL << ((level + 1) * TIMER_WHEEL_SLOT_BITS))) {
+        level++;
+    }
+    slot = (int)((expires >> (level * TIMER_WHEEL_SLOT_BITS)) & SLOT_MASK);
+
+    node->level = (uint8_t)level;
+    node->slot = (uint8_t)slot;
+    node->prev = NULL;
+    node->next = wheel[level][slot];
+    if (node->next) {
+        node->next->prev = node;
+    }
+    wheel[level][slot] = node;
+    occupied[level] |= 1ULL << slot;
+}
+
+/**
+ * @brief Unlink a timer from its slot
+ */
+static void slot_unlink(timer_node_t* node) {
+    if (node->prev) {
+        node->prev->next = node->next;
+    } else {
+        wheel[node->level][node->slot] = node->next;
+    }
+    if (node->next) {
+        node->next->prev = node->prev;
+    }
+    if (!wheel[node->level][node->slot]) {
+        occupied[node->level] &= ~(1ULL << node->slot);
+    }
+    node->next = NULL;
+    node->prev = NULL;
+}
+
+/**
+ * @brief Detach a whole slot list
+ */
+static timer_node_t* slot_take(int level, int slot) {
+    timer_node_t* list = wheel[level][slot];
+
+    wheel[level][slot] = NULL;
+    occupied[level] &= ~(1ULL << slot);
+    return list;
+}
+
+/**
+ * @brief Distance (1..64) from a slot index to the next occupied slot
+ */
+static uint64_t next_occupied(uint64_t mask, uint64_t index) {
+    unsigned int shift = (unsigned int)((index + 1) & SLOT_MASK);
+    uint64_t rotated = shift ? (mask >> shift) | (mask << (64 - shift)) : mask;
+
+    return (uint64_t)__builtin_ctzll(rotated) + 1;
+}
+
+/**
+ * @brief Earliest tick at which the wheel has work (expiry or cascade)
+ */
+static uint64_t next_tick(void) {
+    uint64_t best = NO_TICK;
+    int level;
+
+    for (level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+        uint64_t block;
+        uint64_t tick;
+        int bits = level * TIMER_WHEEL_SLOT_BITS;
+
+        if (!occupied[level]) {
+            continue;
+        }
+        block = wheel_tick >> bits;
+        tick = (block + next_occupied(occupied[level], block & SLOT_MASK)) << bits;
+        if (tick < best) {
+            best = tick;
+        }
+    }
+
+    return best;
+}
+
+/**
+ * @brief Process one tick: cascade upper levels, collect expired timers
+ * @return List of expired timers (linked through next, state RUNNING)
+ */
+static timer_node_t* process_tick(uint64_t tick) {
+    timer_node_t* fired = NULL;
+    timer_node_t* node;
+    int level;
+
+    wheel_tick = tick;
+
+    for (level = TIMER_WHEEL_LEVELS - 1; level > 0; level--) {
+        int bits = level * TIMER_WHEEL_SLOT_BITS;
+
+        if ((tick & ((1ULL << bits) - 1)) != 0) {
+            continue;
+        }
+        node = slot_take(level, (int)((tick >> bits) & SLOT_MASK));
+        while (node) {
+            timer_node_t* next = node->next;
+            slot_link(node);
+            node = next;
+        }
+    }
+
+    node = slot_take(0, (int)(tick & SLOT_MASK));
+    while (node) {
+        timer_node_t* next = node->next;
+
+        if (node->expires > tick) {
+            slot_link(node);  /* Clamped far timer, not due yet */
+        } else {
+            node->state = TIMER_RUNNING;
+            node->prev = NULL;
+            node->next = fired;
+            fired = node;
+        }
+        node = next;
+    }
+
+    return fired;
+}
+
+/**
+ * @brief Return a timer to the free list
+ */
+static void node_free(timer_node_t* node) {
+    node->state = TIMER_FREE;
+    node->callback = NULL;
+    node->context = NULL;
+    node->prev = NULL;
+    node->next = free_list;
+    free_list = node;
+    wheel_stats.active--;
+}
+
+/**
+ * @brief Arm the timerfd for the next tick with work (lock held)
+ */
+static void arm_timerfd(void) {
+#ifdef __linux__
+    struct itimerspec spec;
+    uint64_t tick;
+    uint64_t deadline;
+
+    if (timer_fd < 0) {
+        return;
+    }
+
+    tick = next_tick();
+    if (tick == armed_tick) {
+        return;
+    }
+    armed_tick = tick;
+
+    memset(&spec, 0, sizeof(spec));
+    if (tick != NO_TICK) {
+        deadline = epoch_ns + tick * 1000000ULL;
+        spec.it_value.tv_sec = (time_t)(deadline / 1000000000ULL);
+        spec.it_value.tv_nsec = (long)(deadline % 1000000000ULL);
+    }
+    timerfd_settime(timer_fd, TFD_TIMER_ABSTIME, &spec, NULL);
+#endif
+}
+
+/**
+ * @brief Look up a live timer by ID (lock held)
+ */
+static timer_node_t* node_lookup(timer_id_t id) {
+    size_t index = (size_t)(id & 0xFFFFu);
+    timer_node_t* node;
+
+    if (index == 0 || index > pool_size) {
+        return NULL;
+    }
+    node = &pool[index - 1];
+    return (node->id == id && node->state != TIMER_FREE) ? node : NULL;
+}
+
+/* ============================================================================
+ * PUBLIC API
+ * ============================================================================ */
+
+/**
+ * @brief Allocate the timer pool and reset the wheel
+ */
+int timer_wheel_init(size_t max_timers) {
+    size_t i;
+
+    lifecycle_lock();
+    if (pool) {
+        wheel_users++;
+        lifecycle_unlock();
+        return 0;
+    }
+
+    if (max_timers == 0) {
+        max_timers = TIMER_WHEEL_DEFAULT_TIMERS;
+    }
+    if (max_timers > 0xFFFFu) {
+        lifecycle_unlock();
+        fprintf(stderr, "[TimerWheel] Pool size %zu exceeds 65535\n", max_timers);
+        return -1;
+    }
+
+    pool = (timer_node_t*)calloc(max_timers, sizeof(timer_node_t));
+    if (!pool) {
+        lifecycle_unlock();
+        fprintf(stderr, "[TimerWheel] Failed to allocate %zu timers\n", max_timers);
+        return -1;
+    }
+    wheel_users = 1;
+
+    wheel_lock();
+    pool_size = max_timers;
+    free_list = NULL;
+    for (i = max_timers; i > 0; i--) {
+        pool[i - 1].next = free_list;
+        free_list = &pool[i - 1];
+    }
+    memset(wheel, 0, sizeof(wheel));
+    memset(occupied, 0, sizeof(occupied));
+    memset(&wheel_stats, 0, sizeof(wheel_stats));
+    wheel_stats.capacity = (uint32_t)max_timers;
+    wheel_tick = 0;
+    epoch_ns = monotonic_ns();
+    wheel_unlock();
+    lifecycle_unlock();
+
+    printf("[TimerWheel] Initialized (%zu timers)\n", max_timers);
+    return 0;
+}
+
+/**
+ * @brief Drop one user; the last one stops the wheel thread and frees the pool
+ */
+void timer_wheel_cleanup(void) {
+    lifecycle_lock();
+    if (wheel_users > 1) {
+        wheel_users--;
+        lifecycle_unlock();
+        return;
+    }
+    wheel_users = 0;
+
+    timer_wheel_stop();
+
+    wheel_lock();
+    free(pool);
+    pool = NULL;
+    free_list = NULL;
+    pool_size = 0;
+    memset(wheel, 0, sizeof(wheel));
+    memset(occupied, 0, sizeof(occupied));
+    wheel_unlock();
+    lifecycle_unlock();
+}
+
+#ifdef __linux__
+/**
+ * @brief Wheel thread: wait for the timerfd (or a stop request) and advance
+ */
+static void* wheel_thread_main(void* arg) {
+    struct epoll_event events[2];
+    uint64_t value;
+    (void)arg;
+
+    while (wheel_running) {
+        int count = epoll_wait(epoll_fd, events, 2, -1);
+        int i;
+
+        for (i = 0; i < count; i++) {
+            if (read(events[i].data.fd, &value, sizeof(value)) != sizeof(value)) {
+                continue;
+            }
+            if (events[i].data.fd == timer_fd) {
+                wheel_lock();
+                wheel_stats.wakeups++;
+                armed_tick = NO_TICK;  /* Expired; arm again after advancing */
+                wheel_unlock();
+            }
+        }
+
+        if (wheel_running) {
+            timer_wheel_advance(timer_wheel_now_ms());
+        }
+    }
+
+    return NULL;
+}
+#endif
+
+/**
+ * @brief Start the wheel thread (lifecycle lock held)
+ */
+static int wheel_start_locked(void) {
+#ifdef __linux__
+    struct epoll_event event;
+
+    if (!pool || wheel_running) {
+        return pool ? 0 : -1;
+    }
+
+    timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (timer_fd < 0 || wake_fd < 0 || epoll_fd < 0) {
+        fprintf(stderr, "[TimerWheel] Failed to create timerfd/epoll\n");
+        timer_wheel_stop();
+        return -1;
+    }
+
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.fd = timer_fd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, timer_fd, &event);
+    event.data.fd = wake_fd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wake_fd, &event);
+
+    wheel_lock();
+    armed_tick = 0;  /* Nothing armed yet (tick 0 is never scheduled) */
+    arm_timerfd();
+    wheel_unlock();
+
+    wheel_running = 1;
+    if (pthread_create(&wheel_thread, NULL, wheel_thread_main, NULL) != 0) {
+        wheel_running = 0;
+        timer_wheel_stop();
+        return -1;
+    }
+
+    return 0;
+#else
+    fprintf(stderr, "[TimerWheel] timerfd not available; drive the wheel with timer_wheel_advance()\n");
+    return -1;
+#endif
+}
+
+/**
+ * @brief Start the wheel thread (timerfd + epoll)
+ */
+int timer_wheel_start(void) {
+    int result;
+
+    lifecycle_lock();
+    result = wheel_start_locked();
+    lifecycle_unlock();
+    return result;
+}
+
+/**
+ * @brief Stop the wheel thread
+ */
+void timer_wheel_stop(void) {
+#ifdef __linux__
+    uint64_t one = 1;
+
+    if (wheel_running) {
+        wheel_running = 0;
+        if (write(wake_fd, &one, sizeof(one)) == sizeof(one)) {
+            pthread_join(wheel_thread, NULL);
+        }
+    }
+
+    wheel_lock();
+    if (epoll_fd >= 0) {
+        close(epoll_fd);
+    }
+    if (wake_fd >= 0) {
+        close(wake_fd);
+    }
+    if (timer_fd >= 0) {
+        close(timer_fd);
+    }
+    epoll_fd = wake_fd = timer_fd = -1;
+    armed_tick = NO_TICK;
+    wheel_unlock();
+#endif
+}
+
+/**
+ * @brief Check if the wheel thread is running
+ */
+int timer_wheel_is_running(void) {
+#ifdef __linux__
+    return wheel_running;
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief Schedule a timer
+ */
+timer_id_t timer_wheel_add(uint32_t delay_ms, uint32_t period_ms,
+                           timer_wheel_callback_t callback, void* context) {
+    timer_node_t* node;
+    uint64_t now;
+
+    if (!callback) {
+        return TIMER_ID_INVALID;
+    }
+
+    wheel_lock();
+    if (!free_list) {
+        wheel_unlock();
+        return TIMER_ID_INVALID;
+    }
+
+    node = free_list;
+    free_list = node->next;
+
+    /* Count from the real current time, not the last processed tick */
+    now = (monotonic_ns() - epoch_ns) / 1000000ULL;
+    if (now < wheel_tick) {
+        now = wheel_tick;
+    }
+
+    node->expires = now + (delay_ms ? delay_ms : 1);
+    if (node->expires <= wheel_tick) {
+        node->expires = wheel_tick + 1;
+    }
+    node->period = period_ms;
+    node->callback = callback;
+    node->context = context;
+    node->id = ((timer_id_t)next_generation << 16) | (timer_id_t)(node - pool + 1);
+    node->state = TIMER_PENDING;
+    if (++next_generation == 0) {
+        next_generation = 1;
+    }
+
+    slot_link(node);
+    wheel_stats.active++;
+    arm_timerfd();
+    wheel_unlock();
+
+    return node->id;
+}
+
+/**
+ * @brief Cancel a timer
+ */
+int timer_wheel_cancel(timer_id_t id) {
+    timer_node_t* node;
+    int result = -1;
+
+    wheel_lock();
+    node = node_lookup(id);
+    if (node && node->state == TIMER_PENDING) {
+        slot_unlink(node);
+        node_free(node);
+        result = 0;
+    } else if (node && node->state == TIMER_RUNNING) {
+        node->state = TIMER_CANCELLED;  /* Freed when the callback returns */
+        result = 0;
+    }
+    wheel_unlock();
+
+    return result;
+}
+
+/**
+ * @brief Get the wheel's current time
+ */
+uint64_t timer_wheel_now_ms(void) {
+    return (monotonic_ns() - epoch_ns) / 1000000ULL;
+}
+
+/**
+ * @brief Run every timer due up to a point in time
+ */
+size_t timer_wheel_advance(uint64_t now_ms) {
+    size_t ran = 0;
+
+    wheel_lock();
+    while (pool && wheel_tick < now_ms) {
+        uint64_t tick = now_ms;
+        uint64_t boundary = (wheel_tick | SLOT_MASK) + 1;
+        timer_node_t* fired;
+        int level;
+
+        /* Jump to the next occupied level-0 slot or cascade boundary */
+        if (occupied[0]) {
+            uint64_t due = wheel_tick + next_occupied(occupied[0], wheel_tick & SLOT_MASK);
+            if (due < tick) {
+                tick = due;
+            }
+        }
+        for (level = 1; level < TIMER_WHEEL_LEVELS; level++) {
+            if (occupied[level] && boundary < tick) {
+                tick = boundary;
+                break;
+            }
+        }
+
+        fired = process_tick(tick);
+
+        while (fired) {
+            timer_node_t* node = fired;
+            int result;
+
+            fired = node->next;
+            node->next = NULL;
+
+            wheel_unlock();
+            result = node->callback(node->id, node->context);
+            wheel_lock();
+
+            wheel_stats.fired++;
+            ran++;
+
+            if (node->state == TIMER_RUNNING && node->period > 0 && result == 0) {
+                node->expires += node->period;
+                if (node->expires <= wheel_tick) {
+                    node->expires = wheel_tick + node->period;  /* Skip missed periods */
+                }
+                node->state = TIMER_PENDING;
+                slot_link(node);
+            } else {
+                node_free(node);
+            }
+        }
+    }
+
+    arm_timerfd();
+    wheel_unlock();
+    return ran;
+}
+
+/**
+ * @brief Get the time until the next timer may be due
+ */
+int64_t timer_wheel_next_delay_ms(void) {
+    uint64_t tick;
+    uint64_t now = timer_wheel_now_ms();
+
+    wheel_lock();
+    tick = next_tick();
+    wheel_unlock();
+
+    if (tick == NO_TICK) {
+        return -1;
+    }
+    return tick > now ? (int64_t)(tick - now) : 0;
+}
+
+/**
+ * @brief Get wheel statistics
+ */
+void timer_wheel_get_stats(timer_wheel_stats_t* stats) {
+    if (!stats) {
+        return;
+    }
+
+    wheel_lock();
+    *stats = wheel_stats;
+    wheel_unlock();
+}
@@ -0,0 +1,295 @@
+#include "../include/trace.h"
+#include "../include/latency.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sched.h>
+#endif
+
+/**
+ * @file trace.c
+ * @brief Span tracing with Chrome Trace Event export
+ *
+ * Events go into one preallocated array. A writer claims the next index
+ * with fetch_add, fills the slot and then publishes it by setting the
+ * slot's ready flag, so the exporter skips slots that are still being
+ * written. Once the array is full, further events are counted as dropped.
+ * Writers also count themselves in `writers`, so trace_reset() and
+ * trace_cleanup() can wait for events in progress before touching slots.
+ */
+
+/* Buffer slot: event plus publish flag */
+typedef struct {
+    _Atomic uint32_t ready;     /* Set once the event is fully written */
+    trace_event_t event;
+} trace_slot_t;
+
+static trace_slot_t* _Atomic slots = NULL;
+static size_t capacity = 0;
+static _Atomic size_t next_slot = 0;
+static _Atomic uint64_t dropped = 0;
+static _Atomic int enabled = 0;
+static atomic_uint writers = 0;             /* Events in progress */
+
+/* Thread IDs are handed out on a thread's first event */
+static _Atomic uint16_t next_tid = 1;
+static _Thread_local uint16_t thread_tid = 0;
+
+/**
+ * @brief Append one event (wait-free)
+ */
+static void trace_record(const char* name, char phase, uint32_t arg) {
+    trace_slot_t* buffer;
+    trace_slot_t* slot;
+    size_t index;
+
+    if (!atomic_load_explicit(&enabled, memory_order_relaxed)) {
+        return;
+    }
+
+    /* Announce the event before looking at the buffer, so that
+     * trace_reset() and trace_cleanup() wait for it */
+    atomic_fetch_add(&writers, 1);
+    buffer = atomic_load(&slots);
+    if (!buffer || !atomic_load(&enabled)) {
+        atomic_fetch_sub(&writers, 1);
+        return;
+    }
+
+    index = atomic_fetch_add_explicit(&next_slot, 1, memory_order_relaxed);
+    if (index >= capacity) {
+        atomic_fetch_add_explicit(&dropped, 1, memory_order_relaxed);
+        atomic_fetch_sub(&writers, 1);
+        return;
+    }
+
+    if (thread_tid == 0) {
+        thread_tid = atomic_fetch_add_explicit(&next_tid, 1, memory_order_relaxed);
+    }
+
+    slot = &buffer[index];
+    slot->event.name = name;
+    slot->event.timestamp_ns = latency_get_timestamp_ns();
+    slot->event.arg = arg;
+    slot->event.tid = thread_tid;
+    slot->event.phase = phase;
+    atomic_store_explicit(&slot->ready, 1, memory_order_release);
+
+    atomic_fetch_sub(&writers, 1);
+}
+
+/**
+ * @brief Wait until no event is being written
+ */
+static void wait_for_writers(void) {
+    while (atomic_load(&writers) != 0) {
+#ifdef _WIN32
+        SwitchToThread();
+#else
+        sched_yield();
+#endif
+    }
+}
+
+/**
+ * @brief Allocate the trace buffer
+ */
+int trace_init(size_t max_events) {
+    trace_slot_t* buffer;
+
+    if (atomic_load(&slots)) {
+        return 0;
+    }
+
+    if (max_events == 0) {
+        max_events = TRACE_DEFAULT_EVENTS;
+    }
+
+    buffer = (trace_slot_t*)calloc(max_events, sizeof(trace_slot_t));
+    if (!buffer) {
+        fprintf(stderr, "[Trace] Failed to allocate %zu events\n", max_events);
+        return -1;
+    }
+
+    capacity = max_events;
+    atomic_store(&next_slot, 0);
+    atomic_store(&dropped, 0);
+    atomic_store(&slots, buffer);
+
+    printf("[Trace] Initialized (%zu events)\n", max_events);
+    return 0;
+}
+
+/**
+ * @brief Free the trace buffer and disable tracing
+ */
+void trace_cleanup(void) {
+    trace_slot_t* buffer;
+
+    atomic_store(&enabled, 0);
+    buffer = atomic_exchange(&slots, NULL);
+    wait_for_writers();
+
+    free(buffer);
+    capacity = 0;
+    atomic_store(&next_slot, 0);
+}
+
+/**
+ * @brief Enable or disable recording
+ */
+void trace_enable(int on) {
+    atomic_store(&enabled, on ? 1 : 0);
+}
+
+/**
+ * @brief Check if recording is enabled
+ */
+int trace_is_enabled(void) {
+    return atomic_load(&enabled);
+}
+
+/**
+ * @brief Open a span on the calling thread
+ */
+void trace_begin(const char* name, uint32_t arg) {
+    trace_record(name, TRACE_PHASE_BEGIN, arg);
+}
+
+/**
+ * @brief Close the innermost open span on the calling thread
+ */
+void trace_end(const char* name) {
+    trace_record(name, TRACE_PHASE_END, 0);
+}
+
+/**
+ * @brief Record a point event on the calling thread
+ */
+void trace_instant(const char* name, uint32_t arg) {
+    trace_record(name, TRACE_PHASE_INSTANT, arg);
+}
+
+/**
+ * @brief Get the number of events recorded
+ */
+size_t trace_event_count(void) {
+    size_t count = atomic_load(&next_slot);
+    return count < capacity ? count : capacity;
+}
+
+/**
+ * @brief Get the number of events dropped because the buffer was full
+ */
+uint64_t trace_dropped_count(void) {
+    return atomic_load(&dropped);
+}
+
+/**
+ * @brief Discard all recorded events
+ */
+void trace_reset(void) {
+    trace_slot_t* buffer = atomic_load(&slots);
+    int was_enabled = atomic_exchange(&enabled, 0);
+
+    /* Events that saw tracing enabled finish before the slots are cleared */
+    wait_for_writers();
+    if (buffer) {
+        memset(buffer, 0, capacity * sizeof(trace_slot_t));
+    }
+    atomic_store(&next_slot, 0);
+    atomic_store(&dropped, 0);
+    atomic_store(&enabled, was_enabled);
+}
+
+/**
+ * @brief Write a JSON string (names are plain identifiers, quotes escaped anyway)
+ */
+static void write_json_string(FILE* file, const char* str) {
+    fputc('"', file);
+    for (; str && *str; str++) {
+        if (*str == '"' || *str == '\\') {
+            fputc('\\', file);
+        }
+        if ((unsigned char)*str >= 0x20) {
+            fputc(*str, file);
+        }
+    }
+    fputc('"', file);
+}
+
+/**
+ * @brief Write the recorded events as Chrome Trace Event JSON
+ */
+int trace_write_json(const char* path) {
+    const trace_slot_t* buffer = atomic_load(&slots);
+    FILE* file;
+    size_t count = trace_event_count();
+    uint64_t epoch_ns = UINT64_MAX;
+    size_t written = 0;
+    size_t i;
+
+    if (!path || !buffer) {
+        return -1;
+    }
+
+    file = fopen(path, "w");
+    if (!file) {
+        fprintf(stderr, "[Trace] Failed to open %s\n", path);
+        return -1;
+    }
+
+    for (i = 0; i < count; i++) {
+        if (atomic_load_explicit(&buffer[i].ready, memory_order_acquire) &&
+            buffer[i].event.timestamp_ns < epoch_ns) {
+            epoch_ns = buffer[i].event.timestamp_ns;
+        }
+    }
+
+    fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,"
+                  "\"args\":{\"name\":\"remote_control\"}}");
+
+    for (i = 0; i < count; i++) {
+        const trace_event_t* event = &buffer[i].event;
+        uint64_t ts_ns;
+
+        if (!atomic_load_explicit(&buffer[i].ready, memory_order_acquire)) {
+            continue;  /* Still being written */
+        }
+
+        ts_ns = event->timestamp_ns - epoch_ns;
+        fprintf(file, ",\n{\"name\":");
+        write_json_string(file, event->name);
+        fprintf(file, ",\"cat\":\"remote\",\"ph\":\"%c\",\"ts\":%llu.%03u,\"pid\":1,\"tid\":%u",
+                event->phase, (unsigned long long)(ts_ns / 1000ULL),
+                (unsigned int)(ts_ns % 1000ULL), (unsigned int)event->tid);
+        if (event->phase == TRACE_PHASE_INSTANT) {
+            fprintf(file, ",\"s\":\"t\"");
+        }
+        if (event->phase != TRACE_PHASE_END) {
+            fprintf(file, ",\"args\":{\"code\":%u}", (unsigned int)event->arg);
+        }
+        fputc('}', file);
+        written++;
+    }
+
+    fprintf(file, "\n]}\n");
+
+    if (fclose(file) != 0) {
+        fprintf(stderr, "[Trace] Failed to write %s\n", path);
+        return -1;
+    }
+
+    printf("[Trace] Wrote %zu events to %s", written, path);
+    if (trace_dropped_count() > 0) {
+        printf(" (%llu dropped)", (unsigned long long)trace_dropped_count());
+    }
+    printf("\n");
+    return 0;
+}
@@ -0,0 +1,861 @@
+/* pthread mutexes and mmap() require POSIX.1-2001 */
+#if defined(__linux__) || defined(__unix__) || defined(__APPLE__)
+#undef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include "../include/universal_db.h"
+#include "../include/remote_buttons.h"
+#include "../include/ir_codes.h"
+#include "../include/button_table.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <stdatomic.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+/**
+ * @file universal_db.c
+ * @brief Universal TV code database
+ *
+ * universal_code_list is data/universal_codes.csv, which lists every
+ * (button, brand, code) as it is documented, duplicates included.
+ * universal_db_init() parses and compiles it into one allocation laid out
+ * as described in universal_db.h, unless a codebook file with the same
+ * layout can be mapped instead.
+ */
+
+/* Forward declarations from ir_protocol.c */
+extern uint16_t ir_code_to_rc5(uint32_t code);
+extern uint32_t ir_code_to_rc6(uint32_t code);
+
+_Static_assert(TV_BRAND_COUNT <= UNIVERSAL_DB_MAX_BRANDS, "brand mask too narrow for tv_brand_t");
+
+/* ============================================================================
+ * UNIVERSAL TV CODE LIST
+ * ============================================================================
+ * Real-world codes that work with many TV models, generated at build time
+ * from data/universal_codes.csv (one string per CSV line). The same file is
+ * compiled into the codebook, so the two never disagree.
+ */
+static const char universal_code_list[] =
+#include "universal_codes.inc"
+    ;
+
+/* Compiled or mapped database (NULL until universal_db_init) */
+static universal_db_header_t* _Atomic db = NULL;
+static size_t db_map_size = 0;      /* Size of the mapping, 0 if compiled */
+
+#ifndef _WIN32
+static pthread_mutex_t db_mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+/* ============================================================================
+ * BUILD
+ * ============================================================================ */
+
+/**
+ * @brief Reduce a code to the frame actually put on the wire
+ *
+ * RC5/RC6 keep only the bits the encoder uses and Sony keeps bit_length
+ * bits, so codes that differ only in ignored bits compare equal.
+ */
+static uint32_t wire_frame(const universal_tv_code_t* code) {
+    switch (code->protocol) {
+        case IR_PROTOCOL_RC5:
+            return ir_code_to_rc5(code->code);
+        case IR_PROTOCOL_RC6:
+            return ir_code_to_rc6(code->code);
+        case IR_PROTOCOL_SONY:
+            return code->bit_length < 32 ? code->code & ((1u << code->bit_length) - 1) : code->code;
+        default:
+            return code->code;
+    }
+}
+
+/**
+ * @brief Mix a 64-bit key into a hash index
+ */
+static uint32_t hash_key(uint64_t key) {
+    key ^= key >> 33;
+    key *= 0xFF51AFD7ED558CCDULL;
+    key ^= key >> 33;
+    return (uint32_t)key;
+}
+
+/**
+ * @brief Smallest power of two >= 2 * n (at least 16)
+ */
+static uint32_t table_size(uint32_t n) {
+    uint32_t size = 16;
+    while (size < 2 * n) {
+        size <<= 1;
+    }
+    return size;
+}
+
+/**
+ * @brief Round a byte offset up to 8-byte alignment
+ */
+static uint32_t align8(uint32_t offset) {
+    return (offset + 7u) & ~7u;
+}
+
+/**
+ * @brief Lookup key for a (button, brand, protocol) triple (never 0)
+ */
+static uint32_t slot_key(unsigned char button_code, uint32_t brand, uint8_t protocol) {
+    return (((uint32_t)button_code << 16) | (brand << 8) | protocol) + 1;
+}
+
+/**
+ * @brief Insert a key into the lookup table, keeping the first entry
+ */
+static void slot_insert(universal_db_slot_t* slots, uint32_t slot_count, uint32_t key, uint32_t entry) {
+    uint32_t i = hash_key(key) & (slot_count - 1);
+
+    while (slots[i].key != 0) {
+        if (slots[i].key == key) {
+            return;
+        }
+        i = (i + 1) & (slot_count - 1);
+    }
+    slots[i].key = key;
+    slots[i].entry = entry;
+}
+
+/**
+ * @brief Find or add a value in a temporary index table
+ * @return Existing index, or `next` if the value was added
+ */
+static uint32_t index_intern(uint64_t* keys, uint32_t* values, uint32_t size, uint64_t key, uint32_t next) {
+    uint32_t i = hash_key(key) & (size - 1);
+
+    while (keys[i] != 0) {
+        if (keys[i] == key) {
+            return values[i];
+        }
+        i = (i + 1) & (size - 1);
+    }
+    keys[i] = key;
+    values[i] = next;
+    return next;
+}
+
+/**
+ * @brief Compile the source list into one allocation
+ */
+static universal_db_header_t* db_build(const universal_db_source_t* source, uint32_t count) {
+    universal_db_header_t* header = NULL;
+    universal_frame_t* frames;          /* Distinct frames in source order */
+    universal_db_entry_t* pending;      /* Entries in source order */
+    universal_db_entry_t* entries;
+    uint32_t* brand_entries;
+    universal_db_slot_t* slots;
+    char* strings;
+    uint32_t* row_index;                /* Source row -> frame, then -> pending entry */
+    uint32_t* entry_row;                /* Pending entry -> first source row */
+    uint64_t* keys;
+    uint32_t* values;
+    uint32_t hash_size = table_size(count);
+    uint32_t frame_count = 0, entry_count = 0, brand_entry_count = 0, string_size = 0;
+    uint32_t slot_count, offset, i, b;
+    uint32_t fill[UNIVERSAL_DB_BUTTONS];
+    uint32_t brand_fill[UNIVERSAL_DB_MAX_BRANDS];
+    universal_db_range_t buttons[UNIVERSAL_DB_BUTTONS];
+    universal_db_range_t brands[UNIVERSAL_DB_MAX_BRANDS];
+
+    frames = (universal_frame_t*)calloc(count ? count : 1, sizeof(universal_frame_t));
+    pending = (universal_db_entry_t*)calloc(count ? count : 1, sizeof(universal_db_entry_t));
+    row_index = (uint32_t*)calloc(count ? count : 1, sizeof(uint32_t));
+    entry_row = (uint32_t*)calloc(count ? count : 1, sizeof(uint32_t));
+    keys = (uint64_t*)calloc(hash_size, sizeof(uint64_t));
+    values = (uint32_t*)calloc(hash_size, sizeof(uint32_t));
+    if (!frames || !pending || !row_index || !entry_row || !keys || !values) {
+        goto done;
+    }
+
+    /* Pass 1: distinct frames (global), then distinct frames per button */
+    for (i = 0; i < count; i++) {
+        const universal_tv_code_t* code = &source[i].code;
+        uint64_t key = ((uint64_t)wire_frame(code) << 16) | ((uint64_t)code->protocol << 8) | code->bit_length;
+        uint32_t f = index_intern(keys, values, hash_size, key | (1ULL << 63), frame_count);
+
+        if (f == frame_count) {
+            frames[f].code = code->code;
+            frames[f].protocol = code->protocol;
+            frames[f].bit_length = code->bit_length;
+            frame_count++;
+        }
+        frames[f].brand_mask |= UNIVERSAL_BRAND_BIT(code->brand);
+        row_index[i] = f;
+    }
+
+    memset(keys, 0, hash_size * sizeof(uint64_t));
+    for (i = 0; i < count; i++) {
+        const universal_tv_code_t* code = &source[i].code;
+        uint64_t key = ((uint64_t)source[i].button_code << 32) | row_index[i] | (1ULL << 63);
+        uint32_t e = index_intern(keys, values, hash_size, key, entry_count);
+
+        if (e == entry_count) {
+            entry_row[e] = i;
+            pending[e].frame = row_index[i];
+            pending[e].brand = (uint8_t)code->brand;
+            pending[e].button_code = source[i].button_code;
+            pending[e].description = string_size;
+            string_size += (uint32_t)strlen(code->description ? code->description : "") + 1;
+            entry_count++;
+        }
+        pending[e].brand_mask |= UNIVERSAL_BRAND_BIT(code->brand);
+    }
+
+    /* Ranges: entries grouped by button, brand lists grouped by brand */
+    memset(buttons, 0, sizeof(buttons));
+    memset(brands, 0, sizeof(brands));
+    for (i = 0; i < entry_count; i++) {
+        buttons[pending[i].button_code].count++;
+        for (b = 0; b < TV_BRAND_COUNT; b++) {
+            if (pending[i].brand_mask & UNIVERSAL_BRAND_BIT(b)) {
+                brands[b].count++;
+                brand_entry_count++;
+            }
+        }
+    }
+    for (i = 0, offset = 0; i < UNIVERSAL_DB_BUTTONS; i++) {
+        buttons[i].first = offset;
+        fill[i] = offset;
+        offset += buttons[i].count;
+    }
+    for (b = 0, offset = 0; b < UNIVERSAL_DB_MAX_BRANDS; b++) {
+        brands[b].first = offset;
+        brand_fill[b] = offset;
+        offset += brands[b].count;
+    }
+
+    /* Layout */
+    slot_count = table_size(brand_entry_count * 2);     /* Exact and any-protocol keys */
+    offset = align8(sizeof(universal_db_header_t));
+    header = (universal_db_header_t*)calloc(1, offset);     /* Sized below */
+    if (!header) {
+        goto done;
+    }
+    header->frames_offset = offset;
+    offset = align8(offset + frame_count * (uint32_t)sizeof(universal_frame_t));
+    header->entries_offset = offset;
+    offset = align8(offset + entry_count * (uint32_t)sizeof(universal_db_entry_t));
+    header->brand_entries_offset = offset;
+    offset = align8(offset + brand_entry_count * (uint32_t)sizeof(uint32_t));
+    header->slots_offset = offset;
+    offset = align8(offset + slot_count * (uint32_t)sizeof(universal_db_slot_t));
+    header->strings_offset = offset;
+    offset = align8(offset + string_size);
+
+    {
+        universal_db_header_t* full = (universal_db_header_t*)realloc(header, offset);
+        if (!full) {
+            free(header);
+            header = NULL;
+            goto done;
+        }
+        header = full;
+        memset((char*)header + sizeof(universal_db_header_t), 0, offset - sizeof(universal_db_header_t));
+    }
+
+    header->magic = UNIVERSAL_DB_MAGIC;
+    header->version = UNIVERSAL_DB_VERSION;
+    header->brand_count = TV_BRAND_COUNT;
+    header->source_count = count;
+    header->frame_count = frame_count;
+    header->entry_count = entry_count;
+    header->brand_entry_count = brand_entry_count;
+    header->slot_count = slot_count;
+    header->string_size = string_size;
+    header->total_size = offset;
+    memcpy(header->buttons, buttons, sizeof(buttons));
+    memcpy(header->brands, brands, sizeof(brands));
+
+    memcpy((char*)header + header->frames_offset, frames, frame_count * sizeof(universal_frame_t));
+    entries = (universal_db_entry_t*)((char*)header + header->entries_offset);
+    brand_entries = (uint32_t*)((char*)header + header->brand_entries_offset);
+    slots = (universal_db_slot_t*)((char*)header + header->slots_offset);
+    strings = (char*)header + header->strings_offset;
+
+    /* Pass 2: place entries (stable within a button) with their descriptions */
+    for (i = 0; i < entry_count; i++) {
+        const char* description = source[entry_row[i]].code.description;
+
+        entries[fill[pending[i].button_code]++] = pending[i];
+        if (description) {
+            memcpy(strings + pending[i].description, description, strlen(description) + 1);
+        }
+    }
+
+    /* Brand lists and (button, brand, protocol) lookup, first entry wins */
+    for (i = 0; i < entry_count; i++) {
+        for (b = 0; b < TV_BRAND_COUNT; b++) {
+            if (entries[i].brand_mask & UNIVERSAL_BRAND_BIT(b)) {
+                brand_entries[brand_fill[b]++] = i;
+                slot_insert(slots, slot_count, slot_key(entries[i].button_code, b, frames[entries[i].frame].protocol), i);
+                slot_insert(slots, slot_count, slot_key(entries[i].button_code, b, 0), i);
+            }
+        }
+    }
+
+done:
+    free(frames);
+    free(pending);
+    free(row_index);
+    free(entry_row);
+    free(keys);
+    free(values);
+    return header;
+}
+
+/* ============================================================================
+ * CODEBOOK FILE
+ * ============================================================================ */
+
+#ifndef _WIN32
+/**
+ * @brief Check that a table lies inside the file
+ */
+static int table_fits(uint32_t offset, uint64_t count, uint64_t size, uint64_t file_size) {
+    return offset >= sizeof(universal_db_header_t) && (offset & 7u) == 0 &&
+           offset + count * size <= file_size;
+}
+
+/**
+ * @brief Check that a mapped header describes a usable codebook
+ *
+ * Only the header is checked (O(buttons)); lookups bounds-check the
+ * indices they read from the tables.
+ */
+static int header_valid(const universal_db_header_t* header, size_t file_size) {
+    uint32_t i;
+
+    if (file_size < sizeof(universal_db_header_t) ||
+        header->magic != UNIVERSAL_DB_MAGIC ||
+        header->version != UNIVERSAL_DB_VERSION ||
+        header->total_size != file_size ||
+        header->brand_count > UNIVERSAL_DB_MAX_BRANDS ||
+        header->slot_count == 0 || (header->slot_count & (header->slot_count - 1)) != 0 ||
+        !table_fits(header->frames_offset, header->frame_count, sizeof(universal_frame_t), file_size) ||
+        !table_fits(header->entries_offset, header->entry_count, sizeof(universal_db_entry_t), file_size) ||
+        !table_fits(header->brand_entries_offset, header->brand_entry_count, sizeof(uint32_t), file_size) ||
+        !table_fits(header->slots_offset, header->slot_count, sizeof(universal_db_slot_t), file_size) ||
+        !table_fits(header->strings_offset, header->string_size, 1, file_size)) {
+        return 0;
+    }
+
+    /* Descriptions must be terminated inside the string table */
+    if (header->string_size > 0 &&
+        ((const char*)header)[header->strings_offset + header->string_size - 1] != '\0') {
+        return 0;
+    }
+
+    for (i = 0; i < UNIVERSAL_DB_BUTTONS; i++) {
+        if ((uint64_t)header->buttons[i].first + header->buttons[i].count > header->entry_count) {
+            return 0;
+        }
+    }
+    for (i = 0; i < header->brand_count; i++) {
+        if ((uint64_t)header->brands[i].first + header->brands[i].count > header->brand_entry_count) {
+            return 0;
+        }
+    }
+    return 1;
+}
+#endif
+
+int universal_db_open(const char* path) {
+#ifdef _WIN32
+    (void)path;
+    return -1;
+#else
+    struct stat st;
+    void* map;
+    int fd;
+    int result = -1;
+
+    if (!path) {
+        return -1;
+    }
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(universal_db_header_t)) {
+        close(fd);
+        fprintf(stderr, "[UniversalDB] Not a codebook: %s\n", path);
+        return -1;
+    }
+
+    map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);  /* The mapping keeps the file open */
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "[UniversalDB] Failed to map %s\n", path);
+        return -1;
+    }
+
+    if (!header_valid((const universal_db_header_t*)map, (size_t)st.st_size)) {
+        munmap(map, (size_t)st.st_size);
+        fprintf(stderr, "[UniversalDB] Invalid or incompatible codebook: %s\n", path);
+        return -1;
+    }
+
+    pthread_mutex_lock(&db_mutex);
+    if (!atomic_load_explicit(&db, memory_order_relaxed)) {
+        db_map_size = (size_t)st.st_size;
+        atomic_store_explicit(&db, (universal_db_header_t*)map, memory_order_release);
+        result = 0;
+    }
+    pthread_mutex_unlock(&db_mutex);
+
+    if (result != 0) {
+        munmap(map, (size_t)st.st_size);
+        return -1;
+    }
+
+    printf("[UniversalDB] Mapped %s: %u codes -> %u frames in %u button sweeps (%zu bytes)\n", path,
+           ((const universal_db_header_t*)map)->source_count, ((const universal_db_header_t*)map)->frame_count,
+           ((const universal_db_header_t*)map)->entry_count, (size_t)st.st_size);
+    return 0;
+#endif
+}
+
+int universal_db_save(const char* path, const universal_db_source_t* source, size_t count) {
+    universal_db_header_t* header;
+    char tmp_path[1024];
+    FILE* file;
+    int ok;
+
+    if (!path || (!source && count > 0) || count > UINT32_MAX / 2) {
+        return -1;
+    }
+    if (snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path) >= (int)sizeof(tmp_path)) {
+        return -1;
+    }
+
+    header = db_build(source, (uint32_t)count);
+    if (!header) {
+        return -1;
+    }
+
+    /* Write a temporary file and rename it over the old codebook, so
+     * processes mapping the old file keep a consistent copy */
+    file = fopen(tmp_path, "wb");
+    if (!file) {
+        free(header);
+        fprintf(stderr, "[UniversalDB] Failed to create %s\n", tmp_path);
+        return -1;
+    }
+    ok = fwrite(header, 1, header->total_size, file) == header->total_size;
+    ok = (fclose(file) == 0) && ok;
+    if (ok) {
+        ok = rename(tmp_path, path) == 0;
+    }
+    if (!ok) {
+        remove(tmp_path);
+        fprintf(stderr, "[UniversalDB] Failed to write %s\n", path);
+    } else {
+        printf("[UniversalDB] Wrote %s: %u codes -> %u frames in %u button sweeps (%u bytes)\n", path,
+               header->source_count, header->frame_count, header->entry_count, header->total_size);
+    }
+
+    free(header);
+    return ok ? 0 : -1;
+}
+
+/* ============================================================================
+ * CODE LIST PARSING
+ * ============================================================================ */
+
+#define CODE_LIST_FIELDS 6
+
+/* Protocol names accepted in the protocol column */
+static const struct {
+    const char* name;
+    uint8_t protocol;
+} protocol_names[] = {
+    { "NEC", IR_PROTOCOL_NEC },
+    { "RC5", IR_PROTOCOL_RC5 },
+    { "RC6", IR_PROTOCOL_RC6 },
+    { "SONY", IR_PROTOCOL_SONY },
+    { "SIRC", IR_PROTOCOL_SONY },
+    { "PHILLIPS", IR_PROTOCOL_PHILLIPS },
+};
+
+/**
+ * @brief Compare two strings ignoring case
+ */
+static int name_equal(const char* a, const char* b) {
+    while (*a && *b) {
+        if (tolower((unsigned char)*a) != tolower((unsigned char)*b)) {
+            return 0;
+        }
+        a++;
+        b++;
+    }
+    return *a == *b;
+}
+
+/**
+ * @brief Strip leading and trailing whitespace in place
+ */
+static char* trim(char* text) {
+    char* end;
+
+    while (isspace((unsigned char)*text)) {
+        text++;
+    }
+    end = text + strlen(text);
+    while (end > text && isspace((unsigned char)end[-1])) {
+        *--end = '\0';
+    }
+    return text;
+}
+
+/**
+ * @brief Parse an unsigned number (decimal or 0x hex)
+ */
+static int parse_number(const char* text, uint32_t max, uint32_t* value) {
+    char* end;
+    unsigned long parsed;
+
+    if (!isdigit((unsigned char)*text)) {
+        return -1;
+    }
+    parsed = strtoul(text, &end, 0);
+    if (*end != '\0' || parsed > max) {
+        return -1;
+    }
+    *value = (uint32_t)parsed;
+    return 0;
+}
+
+/**
+ * @brief Parse a button name from the button table, or a numeric code
+ */
+static int parse_button(const char* text, unsigned char* button_code) {
+    uint32_t value;
+    int i;
+
+    if (parse_number(text, 0xFF, &value) == 0) {
+        *button_code = (unsigned char)value;
+        return 0;
+    }
+    for (i = 0; i < UNIVERSAL_DB_BUTTONS; i++) {
+        const button_info_t* info = button_table_lookup((unsigned char)i);
+        if (info->name && name_equal(text, info->name)) {
+            *button_code = (unsigned char)i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Parse a brand name (as returned by universal_tv_brand_name)
+ */
+static int parse_brand(const char* text, tv_brand_t* brand) {
+    int i;
+
+    for (i = 0; i < TV_BRAND_COUNT; i++) {
+        if (name_equal(text, universal_tv_brand_name((tv_brand_t)i))) {
+            *brand = (tv_brand_t)i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Parse a protocol name or IR_PROTOCOL_* value
+ */
+static int parse_protocol(const char* text, uint8_t* protocol) {
+    uint32_t value;
+    size_t i;
+
+    if (parse_number(text, 0xFF, &value) == 0 && value != 0) {
+        *protocol = (uint8_t)value;
+        return 0;
+    }
+    for (i = 0; i < sizeof(protocol_names) / sizeof(protocol_names[0]); i++) {
+        if (name_equal(text, protocol_names[i].name)) {
+            *protocol = protocol_names[i].protocol;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Parse the built-in code list and compile it
+ * @return Compiled database, or NULL on failure
+ */
+static universal_db_header_t* build_code_list(void) {
+    universal_db_header_t* header = NULL;
+    universal_db_source_t* rows;
+    char* text;
+    char* line;
+    uint32_t count = 0;
+    unsigned line_number = 0;
+
+    text = (char*)malloc(sizeof(universal_code_list));
+    rows = (universal_db_source_t*)malloc((sizeof(universal_code_list) / CODE_LIST_FIELDS + 1) * sizeof(*rows));
+    if (!text || !rows) {
+        free(text);
+        free(rows);
+        return NULL;
+    }
+    memcpy(text, universal_code_list, sizeof(universal_code_list));
+
+    /* A parsed row spans five commas and a terminator, so rows is large
+     * enough; descriptions point into text until db_build() copies them */
+    for (line = text; *line; ) {
+        char* newline = strchr(line, '\n');
+        char* row = line;
+        const char* error;
+
+        if (newline) {
+            *newline = '\0';
+            line = newline + 1;
+        } else {
+            line += strlen(line);
+        }
+        line_number++;
+
+        row = trim(row);
+        if (*row == '\0' || *row == '#') {
+            continue;
+        }
+        error = universal_db_parse_row(row, &rows[count]);
+        if (error) {
+            fprintf(stderr, "[UniversalDB] Built-in code list line %u: %s\n", line_number, error);
+            count = 0;
+            break;
+        }
+        count++;
+    }
+
+    if (count > 0) {
+        header = db_build(rows, count);
+    }
+    free(rows);
+    free(text);
+    return header;
+}
+
+/* ============================================================================
+ * PUBLIC FUNCTIONS
+ * ============================================================================ */
+
+const char* universal_db_parse_row(char* line, universal_db_source_t* row) {
+    char* fields[CODE_LIST_FIELDS];
+    uint32_t value;
+    int i;
+
+    /* The last field (description) keeps any further commas */
+    for (i = 0; i < CODE_LIST_FIELDS - 1; i++) {
+        char* comma = strchr(line, ',');
+        if (!comma) {
+            return "expected button,brand,protocol,bits,code,description";
+        }
+        *comma = '\0';
+        fields[i] = trim(line);
+        line = comma + 1;
+    }
+    fields[CODE_LIST_FIELDS - 1] = trim(line);
+
+    memset(row, 0, sizeof(*row));
+    if (parse_button(fields[0], &row->button_code) != 0) {
+        return "unknown button";
+    }
+    if (parse_brand(fields[1], &row->code.brand) != 0) {
+        return "unknown brand";
+    }
+    if (parse_protocol(fields[2], &row->code.protocol) != 0) {
+        return "unknown protocol";
+    }
+    if (parse_number(fields[3], 32, &value) != 0 || value == 0) {
+        return "bits must be 1-32";
+    }
+    /* The Sony encoder only sends 12, 15 and 20-bit frames */
+    if (row->code.protocol == IR_PROTOCOL_SONY && value != 12 && value != 15 && value != 20) {
+        return "Sony codes must be 12, 15 or 20 bits";
+    }
+    row->code.bit_length = (uint8_t)value;
+    if (parse_number(fields[4], UINT32_MAX, &row->code.code) != 0) {
+        return "invalid code";
+    }
+    row->code.description = fields[5];
+    return NULL;
+}
+
+int universal_db_init(void) {
+    universal_db_header_t* header;
+    const char* path;
+
+    if (atomic_load_explicit(&db, memory_order_acquire)) {
+        return 0;
+    }
+
+    /* Codebook file first; a missing default file is not an error */
+    path = getenv(UNIVERSAL_DB_PATH_ENV);
+    if (universal_db_open(path ? path : UNIVERSAL_DB_DEFAULT_PATH) == 0) {
+        return 0;
+    }
+
+#ifndef _WIN32
+    pthread_mutex_lock(&db_mutex);
+#endif
+    header = atomic_load_explicit(&db, memory_order_relaxed);
+    if (!header) {
+        header = build_code_list();
+        if (header) {
+            db_map_size = 0;
+            atomic_store_explicit(&db, header, memory_order_release);
+            printf("[UniversalDB] %u codes -> %u frames in %u button sweeps (%u bytes)\n",
+                   header->source_count, header->frame_count, header->entry_count, header->total_size);
+        } else {
+            fprintf(stderr, "[UniversalDB] Failed to build code database\n");
+        }
+    }
+#ifndef _WIN32
+    pthread_mutex_unlock(&db_mutex);
+#endif
+
+    return header ? 0 : -1;
+}
+
+void universal_db_cleanup(void) {
+    universal_db_header_t* header = atomic_exchange(&db, NULL);
+
+#ifndef _WIN32
+    if (header && db_map_size > 0) {
+        munmap(header, db_map_size);
+        db_map_size = 0;
+        return;
+    }
+#endif
+    free(header);
+}
+
+const universal_db_entry_t* universal_db_button_codes(unsigned char button_code, uint32_t* count) {
+    const universal_db_header_t* header = atomic_load_explicit(&db, memory_order_acquire);
+    const universal_db_range_t* range;
+
+    if (count) {
+        *count = 0;
+    }
+    if (!header) {
+        return NULL;
+    }
+
+    range = &header->buttons[button_code];
+    if (range->count == 0) {
+        return NULL;
+    }
+    if (count) {
+        *count = range->count;
+    }
+    return (const universal_db_entry_t*)((const char*)header + header->entries_offset) + range->first;
+}
+
+const universal_db_entry_t* universal_db_find(unsigned char button_code, tv_brand_t brand, uint8_t protocol) {
+    const universal_db_header_t* header = atomic_load_explicit(&db, memory_order_acquire);
+    const universal_db_slot_t* slots;
+    uint32_t key, i, probes;
+
+    if (!header || (uint32_t)brand >= header->brand_count) {
+        return NULL;
+    }
+
+    slots = (const universal_db_slot_t*)((const char*)header + header->slots_offset);
+    key = slot_key(button_code, (uint32_t)brand, protocol);
+    i = hash_key(key) & (header->slot_count - 1);
+
+    /* A mapped file is not trusted to keep an empty slot: stop after one lap */
+    for (probes = 0; probes < header->slot_count && slots[i].key != 0; probes++) {
+        if (slots[i].key == key) {
+            return universal_db_entry(slots[i].entry);
+        }
+        i = (i + 1) & (header->slot_count - 1);
+    }
+    return NULL;
+}
+
+const uint32_t* universal_db_brand_codes(tv_brand_t brand, uint32_t* count) {
+    const universal_db_header_t* header = atomic_load_explicit(&db, memory_order_acquire);
+
+    if (count) {
+        *count = 0;
+    }
+    if (!header || (uint32_t)brand >= header->brand_count) {
+        return NULL;
+    }
+    if (count) {
+        *count = header->brands[brand].count;
+    }
+    return (const uint32_t*)((const char*)header + header->brand_entries_offset) + header->brands[brand].first;
+}
+
+const universal_db_entry_t* universal_db_entry(uint32_t index) {
+    const universal_db_header_t* header = atomic_load_explicit(&db, memory_order_acquire);
+
+    if (!header || index >= header->entry_count) {
+        return NULL;
+    }
+    return (const universal_db_entry_t*)((const char*)header + header->entries_offset) + index;
+}
+
+const universal_frame_t* universal_db_frame(const universal_db_entry_t* entry) {
+    const universal_db_header_t* header = atomic_load_explicit(&db, memory_order_acquire);
+
+    if (!header || !entry || entry->frame >= header->frame_count) {
+        return NULL;
+    }
+    return (const universal_frame_t*)((const char*)header + header->frames_offset) + entry->frame;
+}
+
+const char* universal_db_description(const universal_db_entry_t* entry) {
+    const universal_db_header_t* header = atomic_load_explicit(&db, memory_order_acquire);
+
+    if (!header || !entry || entry->description >= header->string_size) {
+        return "";
+    }
+    return (const char*)header + header->strings_offset + entry->description;
+}
+
+void universal_db_get_stats(universal_db_stats_t* stats) {
+    const universal_db_header_t* header = atomic_load_explicit(&db, memory_order_acquire);
+    uint32_t i;
+
+    if (!stats) {
+        return;
+    }
+    memset(stats, 0, sizeof(universal_db_stats_t));
+    if (!header) {
+        return;
+    }
+
+    stats->source_codes = header->source_count;
+    stats->frames = header->frame_count;
+    stats->entries = header->entry_count;
+    stats->size_bytes = header->total_size;
+    stats->mapped = (db_map_size > 0);
+    for (i = 0; i < UNIVERSAL_DB_BUTTONS; i++) {
+        if (header->buttons[i].count > 0) {
+            stats->buttons++;
+        }
+    }
+}
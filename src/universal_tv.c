@@ -1,4 +1,14 @@
+/* pthread mutexes require POSIX.1-2001 */
+#if defined(__linux__) || defined(__unix__) || defined(__APPLE__)
+#undef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200112L
+#endif
+
 #include "../include/universal_tv.h"
+#include "../include/universal_db.h"
+#include "../include/learned_store.h"
+#include "../include/brand_detect.h"
+#include "../include/remote_control.h"
 #include "../include/ir_codes.h"
 #include "../include/remote_buttons.h"
 #include "../include/platform.h"
@@ -8,191 +18,182 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdatomic.h>
+
+#ifndef _WIN32
+#include <pthread.h>
+#endif
 
 /* Forward declarations from ir_protocol.c */
 extern void ir_send_rc5(uint16_t code);
 extern void ir_send_rc6(uint32_t code);
 extern void ir_send_nec(uint32_t code);
 extern void ir_send_nec_bit(uint8_t bit);
+extern void ir_send_sony(uint32_t code, uint8_t bit_length);
 extern uint16_t ir_code_to_rc5(uint32_t code);
 extern uint32_t ir_code_to_rc6(uint32_t code);
 
 /* Universal TV State */
 static universal_mode_t current_mode = UNIVERSAL_MODE_MULTI_PROTOCOL;
 static tv_brand_t current_brand = TV_BRAND_UNKNOWN;
-static int scan_active = 0;
-static unsigned char scan_button = 0;
-static uint16_t scan_index = 0;
-static universal_button_codes_t* scan_codes = NULL;
 
 /* Protocol delay between attempts (milliseconds) */
 #define PROTOCOL_DELAY_MS 40
 
-/* ============================================================================
- * UNIVERSAL TV CODE DATABASE
- * ============================================================================
- * Common IR codes for POWER button across multiple brands/protocols
- * These are real-world codes that work with many TV models
- */
-
-/* POWER Button Codes - Multi-Protocol */
-static universal_tv_code_t power_codes[] = {
-    /* NEC Protocol (Samsung, LG, many others) */
-    {0x20DF10EF, IR_PROTOCOL_NEC, 32, TV_BRAND_SAMSUNG, "Samsung/LG NEC Power"},
-    {0x20DF8877, IR_PROTOCOL_NEC, 32, TV_BRAND_LG, "LG NEC Power"},
-    {0x20DF40BF, IR_PROTOCOL_NEC, 32, TV_BRAND_UNKNOWN, "Generic NEC Power"},
-    
-    /* RC5 Protocol (Philips) */
-    {0x0C, IR_PROTOCOL_RC5, 14, TV_BRAND_PHILIPS, "Philips RC5 Power"},
-    {0x100C, IR_PROTOCOL_RC5, 14, TV_BRAND_PHILIPS, "Philips RC5 Power (Alt)"},
-    
-    /* RC6 Protocol (Philips) */
-    {0x800F040C, IR_PROTOCOL_RC6, 20, TV_BRAND_PHILIPS, "Philips RC6 Power"},
-    
-    /* Sony SIRC Protocol */
-    {0xA90, IR_PROTOCOL_SONY, 12, TV_BRAND_SONY, "Sony SIRC Power"},
-    {0x1A90, IR_PROTOCOL_SONY, 15, TV_BRAND_SONY, "Sony SIRC Power (15-bit)"},
-    {0x1A90, IR_PROTOCOL_SONY, 20, TV_BRAND_SONY, "Sony SIRC Power (20-bit)"},
-    
-    /* Samsung Protocol */
-    {0xE0E040BF, IR_PROTOCOL_NEC, 32, TV_BRAND_SAMSUNG, "Samsung Power"},
-    {0xE0E019E6, IR_PROTOCOL_NEC, 32, TV_BRAND_SAMSUNG, "Samsung Power (Alt)"},
-    
-    /* LG Protocol */
-    {0x20DF10EF, IR_PROTOCOL_NEC, 32, TV_BRAND_LG, "LG Power"},
-    {0x20DF8877, IR_PROTOCOL_NEC, 32, TV_BRAND_LG, "LG Power (Alt)"},
-    
-    /* Panasonic */
-    {0x4004, IR_PROTOCOL_NEC, 16, TV_BRAND_PANASONIC, "Panasonic Power"},
-    
-    /* TCL */
-    {0x20DF10EF, IR_PROTOCOL_NEC, 32, TV_BRAND_TCL, "TCL Power"},
-    
-    /* Vizio */
-    {0x20DF10EF, IR_PROTOCOL_NEC, 32, TV_BRAND_VIZIO, "Vizio Power"},
-};
-
-#define POWER_CODE_COUNT (sizeof(power_codes) / sizeof(power_codes[0]))
+/* A scan confirmation counts as this many feedback reports */
+#define CONFIRM_WEIGHT 2
 
-/* VOLUME_UP Button Codes */
-static universal_tv_code_t volume_up_codes[] = {
-    {0x20DF40BF, IR_PROTOCOL_NEC, 32, TV_BRAND_SAMSUNG, "Samsung/LG NEC Volume Up"},
-    {0x10, IR_PROTOCOL_RC5, 14, TV_BRAND_PHILIPS, "Philips RC5 Volume Up"},
-    {0x800F0410, IR_PROTOCOL_RC6, 20, TV_BRAND_PHILIPS, "Philips RC6 Volume Up"},
-    {0x490, IR_PROTOCOL_SONY, 12, TV_BRAND_SONY, "Sony SIRC Volume Up"},
-    {0xE0E0E01F, IR_PROTOCOL_NEC, 32, TV_BRAND_SAMSUNG, "Samsung Volume Up"},
-    {0x20DF40BF, IR_PROTOCOL_NEC, 32, TV_BRAND_LG, "LG Volume Up"},
-};
+/* Feedback attribution: a report is credited to the newest frame for the
+ * button sent at least the reaction latency earlier, if not too old */
+#define DEFAULT_REACTION_MS 100
+#define FEEDBACK_MAX_AGE_MS 2000
+#define SENT_HISTORY_SIZE   64      /* Power of two */
 
-#define VOLUME_UP_CODE_COUNT (sizeof(volume_up_codes) / sizeof(volume_up_codes[0]))
+/* Per-frame hit counters, indexed like the database entries */
+typedef struct {
+    _Atomic uint32_t attempts;
+    _Atomic uint32_t successes;
+    _Atomic uint32_t confirmations;
+} code_counters_t;
 
-/* VOLUME_DOWN Button Codes */
-static universal_tv_code_t volume_down_codes[] = {
-    {0x20DFC03F, IR_PROTOCOL_NEC, 32, TV_BRAND_SAMSUNG, "Samsung/LG NEC Volume Down"},
-    {0x11, IR_PROTOCOL_RC5, 14, TV_BRAND_PHILIPS, "Philips RC5 Volume Down"},
-    {0x800F0411, IR_PROTOCOL_RC6, 20, TV_BRAND_PHILIPS, "Philips RC6 Volume Down"},
-    {0x490, IR_PROTOCOL_SONY, 12, TV_BRAND_SONY, "Sony SIRC Volume Down"},
-    {0xE0E0D02F, IR_PROTOCOL_NEC, 32, TV_BRAND_SAMSUNG, "Samsung Volume Down"},
-    {0x20DFC03F, IR_PROTOCOL_NEC, 32, TV_BRAND_LG, "LG Volume Down"},
-};
+/* One transmitted database frame */
+typedef struct {
+    uint64_t sent_ns;               /* 0 = unused */
+    uint32_t entry;                 /* Database entry index */
+    unsigned char button_code;
+    uint8_t credited;               /* Feedback already counted */
+} sent_frame_t;
 
-#define VOLUME_DOWN_CODE_COUNT (sizeof(volume_down_codes) / sizeof(volume_down_codes[0]))
+/* Sweep position of one frame */
+typedef struct {
+    const universal_db_entry_t* entry;
+    uint32_t score;         /* Estimated success probability (16.16 fixed point) */
+    uint16_t position;      /* Source order, breaks ties */
+    uint8_t brand_match;    /* Listed for the current brand */
+} sweep_slot_t;
 
-/* MUTE Button Codes */
-static universal_tv_code_t mute_codes[] = {
-    {0x20DF906F, IR_PROTOCOL_NEC, 32, TV_BRAND_SAMSUNG, "Samsung/LG NEC Mute"},
-    {0x0D, IR_PROTOCOL_RC5, 14, TV_BRAND_PHILIPS, "Philips RC5 Mute"},
-    {0x800F040D, IR_PROTOCOL_RC6, 20, TV_BRAND_PHILIPS, "Philips RC6 Mute"},
-    {0x290, IR_PROTOCOL_SONY, 12, TV_BRAND_SONY, "Sony SIRC Mute"},
-    {0xE0E0F00F, IR_PROTOCOL_NEC, 32, TV_BRAND_SAMSUNG, "Samsung Mute"},
-    {0x20DF906F, IR_PROTOCOL_NEC, 32, TV_BRAND_LG, "LG Mute"},
+/* Scan Session */
+struct universal_scan {
+    universal_scan_send_t send;     /* NULL = IR transmitter */
+    void* context;
+    unsigned char button_code;
+    uint16_t index;                 /* Next position to send */
+    uint16_t count;
+    int32_t last;                   /* Position last sent (-1 = none) */
+    sweep_slot_t order[];           /* Scan order */
 };
 
-#define MUTE_CODE_COUNT (sizeof(mute_codes) / sizeof(mute_codes[0]))
-
-/* CHANNEL_UP Button Codes */
-static universal_tv_code_t channel_up_codes[] = {
-    {0x20DF00FF, IR_PROTOCOL_NEC, 32, TV_BRAND_SAMSUNG, "Samsung/LG NEC Channel Up"},
-    {0x20, IR_PROTOCOL_RC5, 14, TV_BRAND_PHILIPS, "Philips RC5 Channel Up"},
-    {0x800F0420, IR_PROTOCOL_RC6, 20, TV_BRAND_PHILIPS, "Philips RC6 Channel Up"},
-    {0x090, IR_PROTOCOL_SONY, 12, TV_BRAND_SONY, "Sony SIRC Channel Up"},
-    {0xE0E048B7, IR_PROTOCOL_NEC, 32, TV_BRAND_SAMSUNG, "Samsung Channel Up"},
-    {0x20DF00FF, IR_PROTOCOL_NEC, 32, TV_BRAND_LG, "LG Channel Up"},
-};
+static code_counters_t* code_stats = NULL;
+static uint32_t code_stats_count = 0;
+static sent_frame_t sent_history[SENT_HISTORY_SIZE];    /* Frames feedback may refer to */
+static uint32_t sent_head = 0;
+static _Atomic uint32_t reaction_ms = DEFAULT_REACTION_MS;
+static atomic_int feedback_pending = 0;
+static int early_stop = 0;
+static universal_scan_t* default_scan = NULL;          /* universal_tv_scan_* session */
+static const universal_db_entry_t* detect_probe = NULL; /* Awaiting an answer */
 
-#define CHANNEL_UP_CODE_COUNT (sizeof(channel_up_codes) / sizeof(channel_up_codes[0]))
+#ifndef _WIN32
+static pthread_mutex_t sent_mutex = PTHREAD_MUTEX_INITIALIZER;
+#define SENT_LOCK()   pthread_mutex_lock(&sent_mutex)
+#define SENT_UNLOCK() pthread_mutex_unlock(&sent_mutex)
+#else
+#define SENT_LOCK()   ((void)0)
+#define SENT_UNLOCK() ((void)0)
+#endif
 
-/* CHANNEL_DOWN Button Codes */
-static universal_tv_code_t channel_down_codes[] = {
-    {0x20DF807F, IR_PROTOCOL_NEC, 32, TV_BRAND_SAMSUNG, "Samsung/LG NEC Channel Down"},
-    {0x21, IR_PROTOCOL_RC5, 14, TV_BRAND_PHILIPS, "Philips RC5 Channel Down"},
-    {0x800F0421, IR_PROTOCOL_RC6, 20, TV_BRAND_PHILIPS, "Philips RC6 Channel Down"},
-    {0x890, IR_PROTOCOL_SONY, 12, TV_BRAND_SONY, "Sony SIRC Channel Down"},
-    {0xE0E0C837, IR_PROTOCOL_NEC, 32, TV_BRAND_SAMSUNG, "Samsung Channel Down"},
-    {0x20DF807F, IR_PROTOCOL_NEC, 32, TV_BRAND_LG, "LG Channel Down"},
-};
+/* Helper function to get a button's sweep list (distinct frames) */
+static const universal_db_entry_t* get_universal_codes(unsigned char button_code, uint16_t* count) {
+    uint32_t total = 0;
+    const universal_db_entry_t* codes;
+    
+    if (universal_db_init() != 0) {
+        *count = 0;
+        return NULL;
+    }
+    
+    codes = universal_db_button_codes(button_code, &total);
+    *count = (uint16_t)(total > UINT16_MAX ? UINT16_MAX : total);
+    return codes;
+}
 
-#define CHANNEL_DOWN_CODE_COUNT (sizeof(channel_down_codes) / sizeof(channel_down_codes[0]))
+/* Helper function to get the counters of a database entry */
+static code_counters_t* code_counters(const universal_db_entry_t* entry, uint32_t* index) {
+    const universal_db_entry_t* first = universal_db_entry(0);
+    uint32_t entry_index;
+    
+    if (!code_stats || !first || !entry) {
+        return NULL;
+    }
+    
+    entry_index = (uint32_t)(entry - first);
+    if (entry_index >= code_stats_count) {
+        return NULL;
+    }
+    if (index) {
+        *index = entry_index;
+    }
+    return &code_stats[entry_index];
+}
 
-/* Helper function to get button codes */
-static universal_button_codes_t* get_universal_codes(unsigned char button_code) {
-    static universal_button_codes_t button_map;
+/* Estimate the probability that a frame works: (hits + 1) / (attempts + 2) */
+static uint32_t code_score(const universal_db_entry_t* entry) {
+    code_counters_t* counters = code_counters(entry, NULL);
+    uint64_t hits;
+    uint64_t attempts;
+    
+    if (!counters) {
+        return 1u << 15;
+    }
     
-    switch (button_code) {
-        case BUTTON_POWER:
-            button_map.button_code = button_code;
-            button_map.codes = power_codes;
-            button_map.code_count = POWER_CODE_COUNT;
-            return &button_map;
-            
-        case BUTTON_VOLUME_UP:
-            button_map.button_code = button_code;
-            button_map.codes = volume_up_codes;
-            button_map.code_count = VOLUME_UP_CODE_COUNT;
-            return &button_map;
-            
-        case BUTTON_VOLUME_DOWN:
-            button_map.button_code = button_code;
-            button_map.codes = volume_down_codes;
-            button_map.code_count = VOLUME_DOWN_CODE_COUNT;
-            return &button_map;
-            
-        case BUTTON_MUTE:
-            button_map.button_code = button_code;
-            button_map.codes = mute_codes;
-            button_map.code_count = MUTE_CODE_COUNT;
-            return &button_map;
-            
-        case BUTTON_CHANNEL_UP:
-            button_map.button_code = button_code;
-            button_map.codes = channel_up_codes;
-            button_map.code_count = CHANNEL_UP_CODE_COUNT;
-            return &button_map;
-            
-        case BUTTON_CHANNEL_DOWN:
-            button_map.button_code = button_code;
-            button_map.codes = channel_down_codes;
-            button_map.code_count = CHANNEL_DOWN_CODE_COUNT;
-            return &button_map;
-            
-        default:
-            return NULL;
+    hits = atomic_load(&counters->successes) +
+           (uint64_t)CONFIRM_WEIGHT * atomic_load(&counters->confirmations);
+    attempts = atomic_load(&counters->attempts);
+    if (hits > attempts) {
+        attempts = hits;
     }
+    return (uint32_t)(((hits + 1) << 16) / (attempts + 2));
 }
 
-/* Send code using specific protocol */
-static int send_code_with_protocol(universal_tv_code_t* code_entry) {
-    if (!code_entry) return -1;
+/* Order: current brand first, then by score, then source order */
+static int sweep_slot_compare(const void* a, const void* b) {
+    const sweep_slot_t* slot_a = (const sweep_slot_t*)a;
+    const sweep_slot_t* slot_b = (const sweep_slot_t*)b;
     
+    if (slot_a->brand_match != slot_b->brand_match) {
+        return slot_b->brand_match - slot_a->brand_match;
+    }
+    if (slot_a->score != slot_b->score) {
+        return slot_a->score < slot_b->score ? 1 : -1;
+    }
+    return slot_a->position - slot_b->position;
+}
+
+/* Helper function to order a sweep list by estimated probability */
+static void sweep_order(const universal_db_entry_t* codes, uint16_t count, sweep_slot_t* order) {
+    uint16_t brand_mask = (current_brand != TV_BRAND_UNKNOWN) ? UNIVERSAL_BRAND_BIT(current_brand) : 0;
+    uint16_t i;
+    
+    for (i = 0; i < count; i++) {
+        order[i].entry = &codes[i];
+        order[i].score = code_score(&codes[i]);
+        order[i].position = i;
+        order[i].brand_match = (codes[i].brand_mask & brand_mask) ? 1 : 0;
+    }
+    qsort(order, count, sizeof(sweep_slot_t), sweep_slot_compare);
+}
+
+/* Send one wire frame */
+static int send_frame(const universal_frame_t* code_entry, const char* description) {
     printf("[Universal] Sending: %s (0x%08X, Protocol: %d, %d bits)\n",
-           code_entry->description, code_entry->code, 
+           description, code_entry->code, 
            code_entry->protocol, code_entry->bit_length);
     
     /* Trigger protocol attempt event */
     handler_trigger_universal_protocol_attempt(
         code_entry->protocol, 
         code_entry->code, 
-        code_entry->description
+        description
     );
     
     switch (code_entry->protocol) {
@@ -216,10 +217,8 @@ static int send_code_with_protocol(universal_tv_code_t* code_entry) {
             break;
             
         case IR_PROTOCOL_SONY:
-            /* Sony SIRC protocol */
-            printf("[Universal] [Sony SIRC] 0x%04X (%d bits)\n", 
-                   (uint16_t)code_entry->code, code_entry->bit_length);
-            delay_us(40000); /* Simulate transmission */
+            /* Sony SIRC protocol - 12/15/20-bit frame */
+            ir_send_sony(code_entry->code, code_entry->bit_length);
             break;
             
         default:
@@ -230,6 +229,59 @@ static int send_code_with_protocol(universal_tv_code_t* code_entry) {
     return 0;
 }
 
+/* Send a database entry's frame */
+static int send_code_with_protocol(const universal_db_entry_t* entry) {
+    const universal_frame_t* code_entry = universal_db_frame(entry);
+    code_counters_t* counters;
+    uint32_t index;
+    
+    if (!code_entry) return -1;
+    
+    /* Remember the frame so that later feedback can be credited to it */
+    counters = code_counters(entry, &index);
+    if (counters) {
+        sent_frame_t* sent;
+        
+        atomic_fetch_add(&counters->attempts, 1);
+        SENT_LOCK();
+        sent = &sent_history[sent_head++ & (SENT_HISTORY_SIZE - 1)];
+        sent->sent_ns = latency_get_timestamp_ns();
+        sent->entry = index;
+        sent->button_code = entry->button_code;
+        sent->credited = 0;
+        SENT_UNLOCK();
+    }
+    
+    return send_frame(code_entry, universal_db_description(entry));
+}
+
+/* Send the learned frame for a button, if one is stored */
+static int send_learned_code(unsigned char button_code) {
+    learned_code_t learned;
+    universal_frame_t frame;
+    
+    if (learned_store_get(DEVICE_TV, button_code, &learned) != 0) {
+        return -1;
+    }
+    
+    frame.code = learned.code;
+    frame.protocol = learned.protocol;
+    frame.bit_length = learned.bit_length;
+    frame.brand_mask = 0;
+    
+    return send_frame(&frame, "Learned code");
+}
+
+/* Feed an answer to brand detection; set the brand once it is confident */
+static int detect_observe(const universal_db_entry_t* entry, int worked) {
+    if (brand_detect_observe(entry, worked) != 1) {
+        return 0;
+    }
+    
+    universal_tv_set_brand(brand_detect_result());
+    return 1;
+}
+
 /* ============================================================================
  * PUBLIC FUNCTIONS
  * ============================================================================ */
@@ -237,7 +289,24 @@ static int send_code_with_protocol(universal_tv_code_t* code_entry) {
 int universal_tv_init(universal_mode_t mode) {
     current_mode = mode;
     current_brand = TV_BRAND_UNKNOWN;
-    scan_active = 0;
+    universal_scan_destroy(default_scan);
+    default_scan = NULL;
+    
+    if (universal_db_init() != 0) {
+        return -1;
+    }
+    
+    if (!code_stats) {
+        universal_db_stats_t db_stats;
+        universal_db_get_stats(&db_stats);
+        code_stats = (code_counters_t*)calloc(db_stats.entries ? db_stats.entries : 1, sizeof(code_counters_t));
+        code_stats_count = code_stats ? db_stats.entries : 0;
+    }
+    
+    /* Without the store, learned mode sweeps like multi-protocol mode */
+    if (learned_store_open(NULL) != 0) {
+        printf("[Universal TV] Warning: learned codes unavailable\n");
+    }
     
     printf("[Universal TV] Initialized in mode: %d\n", mode);
     printf("[Universal TV] Multi-protocol universal sender ready\n");
@@ -247,175 +316,353 @@ int universal_tv_init(universal_mode_t mode) {
 
 int universal_tv_send_button(unsigned char button_code) {
     /* Measure latency: Universal TV transmission */
-    uint64_t universal_start = LATENCY_MEASURE_START();
+    uint64_t universal_start = LATENCY_MEASURE_START_NS();
     
-    universal_button_codes_t* codes = get_universal_codes(button_code);
+    /* Learned mode: one confirmed frame instead of a sweep */
+    if (current_mode == UNIVERSAL_MODE_LEARNED && send_learned_code(button_code) == 0) {
+        LATENCY_MEASURE_END_NS(universal_start, "universal_tv", button_code);
+        return 0;
+    }
+    
+    uint16_t code_count;
+    const universal_db_entry_t* codes = get_universal_codes(button_code, &code_count);
     
-    if (!codes || codes->code_count == 0) {
+    if (!codes || code_count == 0) {
         /* Fallback to standard IR code */
         printf("[Universal] No universal codes for button 0x%02X, using standard IR\n", button_code);
         ir_code_t standard_code = get_ir_code(button_code);
         int result = ir_send(standard_code);
-        LATENCY_MEASURE_END(universal_start, "universal_tv", button_code);
+        LATENCY_MEASURE_END_NS(universal_start, "universal_tv", button_code);
         return result;
     }
     
     printf("[Universal] Sending button 0x%02X using multi-protocol strategy\n", button_code);
-    printf("[Universal] Trying %d different codes/protocols...\n", codes->code_count);
+    printf("[Universal] Trying %d different codes/protocols...\n", code_count);
     
-    /* Strategy: Send all codes in sequence with small delays */
-    /* This mimics how cheap universal remotes work */
+    /* Strategy: Send every distinct frame once with small delays */
+    /* This mimics how cheap universal remotes work, but sends the most
+     * likely frames first: current brand, then by hit statistics */
+    sweep_slot_t* order = (sweep_slot_t*)malloc((size_t)code_count * sizeof(sweep_slot_t));
     int i;
-    for (i = 0; i < codes->code_count; i++) {
-        universal_tv_code_t* code_entry = &codes->codes[i];
-        
-        /* If brand is set, prioritize codes for that brand */
-        if (current_brand != TV_BRAND_UNKNOWN && 
-            code_entry->brand == current_brand) {
-            /* Send brand-specific code first */
-            send_code_with_protocol(code_entry);
-            delay_us(PROTOCOL_DELAY_MS * 1000);
-        }
+    
+    if (order) {
+        sweep_order(codes, code_count, order);
     }
     
-    /* Now send all codes (or remaining codes) */
-    for (i = 0; i < codes->code_count; i++) {
-        universal_tv_code_t* code_entry = &codes->codes[i];
+    atomic_store(&feedback_pending, 0);
+    for (i = 0; i < code_count; i++) {
+        send_code_with_protocol(order ? order[i].entry : &codes[i]);
         
-        /* Skip if already sent (brand-specific) */
-        if (current_brand != TV_BRAND_UNKNOWN && 
-            code_entry->brand == current_brand) {
-            continue;
+        /* Small delay between protocol attempts (also the feedback window) */
+        if (i < code_count - 1) {
+            delay_us(PROTOCOL_DELAY_MS * 1000);
         }
         
-        send_code_with_protocol(code_entry);
-        
-        /* Small delay between protocol attempts */
-        if (i < codes->code_count - 1) {
-            delay_us(PROTOCOL_DELAY_MS * 1000);
+        /* Stop once the TV has reacted */
+        if (early_stop && atomic_exchange(&feedback_pending, 0)) {
+            printf("[Universal] TV responded after %d of %d codes\n", i + 1, code_count);
+            break;
         }
     }
+    free(order);
     
     printf("[Universal] Multi-protocol transmission complete\n");
     
     /* Measure latency: Universal TV transmission complete */
-    LATENCY_MEASURE_END(universal_start, "universal_tv", button_code);
+    LATENCY_MEASURE_END_NS(universal_start, "universal_tv", button_code);
     
     return 0;
 }
 
-int universal_tv_scan_start(unsigned char button_code) {
-    universal_button_codes_t* codes = get_universal_codes(button_code);
+universal_scan_t* universal_scan_create(unsigned char button_code, universal_scan_send_t send, void* context) {
+    uint16_t code_count;
+    const universal_db_entry_t* codes = get_universal_codes(button_code, &code_count);
+    universal_scan_t* scan;
     
-    if (!codes || codes->code_count == 0) {
-        printf("[Universal] No codes available for button 0x%02X\n", button_code);
-        return -1;
+    if (!codes || code_count == 0) {
+        return NULL;
     }
     
-    scan_active = 1;
-    scan_button = button_code;
-    scan_index = 0;
-    scan_codes = codes;
+    scan = (universal_scan_t*)malloc(sizeof(universal_scan_t) + (size_t)code_count * sizeof(sweep_slot_t));
+    if (!scan) {
+        return NULL;
+    }
     
-    printf("[Universal] Scan mode started for button 0x%02X\n", button_code);
-    printf("[Universal] Press button repeatedly. When TV responds, confirm to save code.\n");
-    printf("[Universal] Total codes to try: %d\n", codes->code_count);
+    scan->send = send;
+    scan->context = context;
+    scan->button_code = button_code;
+    scan->index = 0;
+    scan->count = code_count;
+    scan->last = -1;
     
-    /* Trigger scan started event */
-    handler_trigger_universal_scan_started(button_code, codes->code_count);
+    /* Try the most likely codes first */
+    sweep_order(codes, code_count, scan->order);
     
-    return 0;
+    if (!send) {
+        printf("[Universal] Scan mode started for button 0x%02X\n", button_code);
+        printf("[Universal] Press button repeatedly. When TV responds, confirm to save code.\n");
+        printf("[Universal] Total codes to try: %d\n", code_count);
+        
+        /* Trigger scan started event */
+        handler_trigger_universal_scan_started(button_code, code_count);
+    }
+    
+    return scan;
 }
 
-int universal_tv_scan_next(void) {
-    if (!scan_active || !scan_codes) {
+int universal_scan_next(universal_scan_t* scan) {
+    const universal_db_entry_t* code_entry;
+    const universal_frame_t* frame;
+    
+    if (!scan) {
         return -1;
     }
     
-    if (scan_index >= scan_codes->code_count) {
-        printf("[Universal] Scan complete - no working code found\n");
-        scan_active = 0;
+    code_entry = scan->order[scan->index].entry;
+    frame = universal_db_frame(code_entry);
+    if (!frame) {
         return -1;
     }
     
-    universal_tv_code_t* code_entry = &scan_codes->codes[scan_index];
-    
-    printf("[Universal] [Scan %d/%d] Trying: %s\n", 
-           scan_index + 1, scan_codes->code_count, code_entry->description);
-    
-    /* Trigger scan next event */
-    handler_trigger_universal_scan_next(scan_button, scan_index, scan_codes->code_count);
-    
-    send_code_with_protocol(code_entry);
+    if (scan->send) {
+        /* Custom transmitter: the session has no global side effects */
+        universal_tv_code_t code;
+        
+        code.code = frame->code;
+        code.protocol = frame->protocol;
+        code.bit_length = frame->bit_length;
+        code.brand = (tv_brand_t)code_entry->brand;
+        code.description = universal_db_description(code_entry);
+        if (scan->send(&code, scan->context) != 0) {
+            return -1;
+        }
+    } else {
+        printf("[Universal] [Scan %d/%d] Trying: %s\n", 
+               scan->index + 1, scan->count, universal_db_description(code_entry));
+        
+        /* Trigger scan next event */
+        handler_trigger_universal_scan_next(scan->button_code, scan->index, scan->count);
+        
+        send_code_with_protocol(code_entry);
+    }
     
-    scan_index++;
+    scan->last = scan->index;
+    scan->index++;
     
-    if (scan_index >= scan_codes->code_count) {
+    if (scan->index >= scan->count) {
         /* Reached end, loop back */
-        scan_index = 0;
-        printf("[Universal] Reached end of codes, looping...\n");
+        scan->index = 0;
+        if (!scan->send) {
+            printf("[Universal] Reached end of codes, looping...\n");
+        }
     }
     
     return 0; /* Still scanning */
 }
 
-int universal_tv_scan_confirm(void) {
-    if (!scan_active || !scan_codes || scan_index == 0) {
+int universal_scan_confirm(universal_scan_t* scan, universal_tv_code_t* confirmed) {
+    const universal_db_entry_t* confirmed_code;
+    const universal_frame_t* confirmed_frame;
+    code_counters_t* counters;
+    learned_code_t learned;
+    
+    if (!scan || scan->last < 0) {
+        return -1;
+    }
+    
+    /* The code we just sent */
+    confirmed_code = scan->order[scan->last].entry;
+    confirmed_frame = universal_db_frame(confirmed_code);
+    if (!confirmed_frame) {
         return -1;
     }
     
-    /* Get the code we just sent (previous index) */
-    uint16_t confirmed_index = (scan_index == 0) ? 
-        (scan_codes->code_count - 1) : (scan_index - 1);
+    if (confirmed) {
+        confirmed->code = confirmed_frame->code;
+        confirmed->protocol = confirmed_frame->protocol;
+        confirmed->bit_length = confirmed_frame->bit_length;
+        confirmed->brand = (tv_brand_t)confirmed_code->brand;
+        confirmed->description = universal_db_description(confirmed_code);
+    }
     
-    universal_tv_code_t* confirmed_code = &scan_codes->codes[confirmed_index];
+    if (scan->send) {
+        return 0;
+    }
     
     printf("[Universal] Code confirmed: %s (0x%08X)\n", 
-           confirmed_code->description, confirmed_code->code);
-    printf("[Universal] This code will be used for button 0x%02X\n", scan_button);
+           universal_db_description(confirmed_code), confirmed_frame->code);
+    printf("[Universal] This code will be used for button 0x%02X\n", scan->button_code);
     
     /* Trigger scan confirmed event */
-    handler_trigger_universal_scan_confirmed(scan_button, confirmed_index, scan_codes->code_count);
+    handler_trigger_universal_scan_confirmed(scan->button_code, (uint16_t)scan->last, scan->count);
     
-    /* TODO: Save confirmed code to persistent storage */
-    /* For now, we'll set it as the preferred code for this brand */
-    if (confirmed_code->brand != TV_BRAND_UNKNOWN) {
-        current_brand = confirmed_code->brand;
-        printf("[Universal] TV brand set to: %d\n", current_brand);
-        
-        /* Trigger brand detected event */
-        const char* brand_names[] = {
-            "Unknown", "Samsung", "LG", "Sony", "Philips", "Panasonic",
-            "TCL", "Vizio", "Hisense", "Toshiba", "Sharp"
-        };
-        if (current_brand < TV_BRAND_COUNT) {
-            handler_trigger_universal_brand_detected(current_brand, brand_names[current_brand]);
-        }
+    counters = code_counters(confirmed_code, NULL);
+    if (counters) {
+        atomic_fetch_add(&counters->confirmations, 1);
+    }
+    
+    /* Save the confirmed frame for learned mode */
+    learned.code = confirmed_frame->code;
+    learned.protocol = confirmed_frame->protocol;
+    learned.bit_length = confirmed_frame->bit_length;
+    if (learned_store_put(DEVICE_TV, scan->button_code, &learned) != 0) {
+        printf("[Universal] Warning: confirmed code not saved\n");
+    }
+    
+    /* Narrow down the brand (set once detection is confident) */
+    detect_observe(confirmed_code, 1);
+    
+    return 0;
+}
+
+void universal_scan_destroy(universal_scan_t* scan) {
+    free(scan);
+}
+
+int universal_tv_scan_start(unsigned char button_code) {
+    universal_scan_t* scan = universal_scan_create(button_code, NULL, NULL);
+    
+    if (!scan) {
+        printf("[Universal] No codes available for button 0x%02X\n", button_code);
+        return -1;
     }
     
-    scan_active = 0;
+    universal_scan_destroy(default_scan);
+    default_scan = scan;
+    return 0;
+}
+
+int universal_tv_scan_next(void) {
+    return universal_scan_next(default_scan);
+}
+
+int universal_tv_scan_confirm(void) {
+    if (universal_scan_confirm(default_scan, NULL) != 0) {
+        return -1;
+    }
+    
+    universal_scan_destroy(default_scan);
+    default_scan = NULL;
     return 0;
 }
 
 void universal_tv_scan_cancel(void) {
-    if (scan_active) {
+    if (default_scan) {
         printf("[Universal] Scan mode cancelled\n");
-        scan_active = 0;
-        scan_codes = NULL;
+        universal_scan_destroy(default_scan);
+        default_scan = NULL;
     }
 }
 
+int universal_tv_report_success(unsigned char button_code) {
+    uint64_t now_ns = latency_get_timestamp_ns();
+    uint64_t reaction_ns = (uint64_t)atomic_load(&reaction_ms) * 1000000u;
+    uint64_t oldest_ns = now_ns > (uint64_t)FEEDBACK_MAX_AGE_MS * 1000000u ?
+                         now_ns - (uint64_t)FEEDBACK_MAX_AGE_MS * 1000000u : 0;
+    const universal_db_entry_t* entry = NULL;
+    code_counters_t* counters;
+    sent_frame_t* cause = NULL;
+    int i;
+    
+    /* The TV reacts to a frame some time after it was sent, so frames sent
+     * within the reaction latency cannot be the cause */
+    SENT_LOCK();
+    for (i = 0; i < SENT_HISTORY_SIZE; i++) {
+        sent_frame_t* sent = &sent_history[i];
+        
+        if (sent->sent_ns == 0 || sent->button_code != button_code ||
+            sent->sent_ns + reaction_ns > now_ns || sent->sent_ns < oldest_ns) {
+            continue;
+        }
+        if (!cause || sent->sent_ns > cause->sent_ns) {
+            cause = sent;
+        }
+    }
+    
+    /* Credit each transmitted frame at most once */
+    if (cause && !cause->credited) {
+        cause->credited = 1;
+        entry = universal_db_entry(cause->entry);
+    }
+    SENT_UNLOCK();
+    
+    counters = code_counters(entry, NULL);
+    if (!counters) {
+        return -1;
+    }
+    
+    atomic_fetch_add(&counters->successes, 1);
+    atomic_store(&feedback_pending, 1);
+    printf("[Universal] TV responded to: %s\n", universal_db_description(entry));
+    
+    detect_observe(entry, 1);
+    return 0;
+}
+
+void universal_tv_set_early_stop(int enable) {
+    early_stop = enable ? 1 : 0;
+}
+
+void universal_tv_set_reaction_latency(uint32_t ms) {
+    atomic_store(&reaction_ms, ms);
+}
+
+int universal_tv_get_code_stats(unsigned char button_code, uint16_t index, universal_code_stats_t* stats) {
+    uint16_t code_count;
+    const universal_db_entry_t* codes = get_universal_codes(button_code, &code_count);
+    code_counters_t* counters;
+    
+    if (!codes || index >= code_count || !stats) {
+        return -1;
+    }
+    
+    counters = code_counters(&codes[index], NULL);
+    if (!counters) {
+        return -1;
+    }
+    
+    stats->attempts = atomic_load(&counters->attempts);
+    stats->successes = atomic_load(&counters->successes);
+    stats->confirmations = atomic_load(&counters->confirmations);
+    stats->score = code_score(&codes[index]);
+    return 0;
+}
+
+int universal_tv_detect_next(unsigned char button_code) {
+    const universal_db_entry_t* probe;
+    
+    if (brand_detect_result() != TV_BRAND_UNKNOWN) {
+        return 1;
+    }
+    
+    probe = brand_detect_next_probe(button_code);
+    if (!probe) {
+        printf("[Universal] No frame for button 0x%02X narrows the brand further\n", button_code);
+        return -1;
+    }
+    
+    detect_probe = probe;
+    return send_code_with_protocol(probe);
+}
+
+int universal_tv_detect_answer(int worked) {
+    const universal_db_entry_t* probe = detect_probe;
+    
+    if (!probe) {
+        return -1;
+    }
+    
+    detect_probe = NULL;
+    return detect_observe(probe, worked);
+}
+
 void universal_tv_set_brand(tv_brand_t brand) {
     current_brand = brand;
     printf("[Universal] TV brand set to: %d\n", brand);
     
     /* Trigger brand detected event */
-    const char* brand_names[] = {
-        "Unknown", "Samsung", "LG", "Sony", "Philips", "Panasonic",
-        "TCL", "Vizio", "Hisense", "Toshiba", "Sharp"
-    };
     if (brand < TV_BRAND_COUNT) {
-        handler_trigger_universal_brand_detected(brand, brand_names[brand]);
+        handler_trigger_universal_brand_detected(brand, universal_tv_brand_name(brand));
     }
 }
 
@@ -423,15 +670,33 @@ tv_brand_t universal_tv_get_brand(void) {
     return current_brand;
 }
 
+const char* universal_tv_brand_name(tv_brand_t brand) {
+    static const char* brand_names[TV_BRAND_COUNT] = {
+        "Unknown", "Samsung", "LG", "Sony", "Philips", "Panasonic",
+        "TCL", "Vizio", "Hisense", "Toshiba", "Sharp"
+    };
+    
+    return ((unsigned)brand < TV_BRAND_COUNT) ? brand_names[brand] : "Unknown";
+}
+
 uint16_t universal_tv_get_code_count(unsigned char button_code) {
-    universal_button_codes_t* codes = get_universal_codes(button_code);
-    return codes ? codes->code_count : 0;
+    uint16_t code_count;
+    get_universal_codes(button_code, &code_count);
+    return code_count;
 }
 
 void universal_tv_cleanup(void) {
-    if (scan_active) {
-        universal_tv_scan_cancel();
-    }
+    universal_tv_scan_cancel();
+    detect_probe = NULL;
+    brand_detect_reset();
+    learned_store_close();
+    free(code_stats);
+    code_stats = NULL;
+    code_stats_count = 0;
+    SENT_LOCK();
+    memset(sent_history, 0, sizeof(sent_history));
+    SENT_UNLOCK();
+    universal_db_cleanup();
     printf("[Universal TV] Cleaned up\n");
 }
 
@@ -1,27 +1,26 @@
 """
-Button codes for the TV simulator - must match include/remote_buttons.h and
-src/remote_control.c get_button_name() exactly.
+Button codes for the TV simulator.
 
-This file is the single source of truth for the Python/JS simulator.
-Do not add or change codes here without updating remote_buttons.h and get_button_name().
+GENERATED by gen_button_codes.py from include/remote_buttons.h and
+src/button_table.c - do not edit by hand. Run `make button-codes` after
+changing the C button table.
 """
 
 # Code -> display name (matches C get_button_name())
-# Generated from include/remote_buttons.h and src/remote_control.c
 BUTTON_CODES = {
-    # Streaming (remote_buttons.h)
+    # Streaming Service Buttons
     0x01: "YouTube",
     0x02: "Netflix",
     0x03: "Amazon Prime",
     0x04: "HBO Max",
-    # Basic
+    # Basic Control Buttons
     0x10: "Power",
     0x11: "Volume Up",
     0x12: "Volume Down",
     0x13: "Mute",
     0x14: "Channel Up",
     0x15: "Channel Down",
-    # Navigation
+    # Navigation Buttons
     0x20: "Home",
     0x21: "Menu",
     0x22: "Back",
@@ -29,21 +28,21 @@ BUTTON_CODES = {
     0x24: "Options",
     0x25: "Input",
     0x26: "Source",
-    # D-pad
+    # Directional Pad
     0x30: "Up",
     0x31: "Down",
     0x32: "Left",
     0x33: "Right",
     0x34: "OK",
     0x35: "Enter",
-    # Playback
+    # Playback Controls
     0x40: "Play",
     0x41: "Pause",
     0x42: "Stop",
     0x43: "Fast Forward",
     0x44: "Rewind",
     0x45: "Record",
-    # Number pad
+    # Number Pad
     0x50: "0",
     0x51: "1",
     0x52: "2",
@@ -55,12 +54,12 @@ BUTTON_CODES = {
     0x58: "8",
     0x59: "9",
     0x5A: "Dash (-)",
-    # Color
+    # Color Buttons
     0x60: "Red",
     0x61: "Green",
     0x62: "Yellow",
     0x63: "Blue",
-    # Advanced TV
+    # Advanced TV Controls
     0x70: "Info",
     0x71: "Guide",
     0x72: "Settings",
@@ -73,31 +72,31 @@ BUTTON_CODES = {
     0x79: "Aspect",
     0x7A: "Zoom",
     0x7B: "Picture Size",
-    # Smart TV
+    # Smart TV Features
     0x80: "Voice",
     0x81: "Microphone",
     0x82: "Live TV",
     0x83: "Stream",
-    # System
+    # System & Diagnostic
     0x90: "Display",
     0x91: "Status",
     0x92: "Help",
     0x93: "E-Manual",
-    # Gaming
+    # Gaming Controls
     0xA0: "Game Mode",
-    # Picture
+    # Picture Controls
     0xB0: "Motion",
     0xB1: "Backlight",
     0xB2: "Brightness",
-    # Audio
+    # Audio Controls
     0xC0: "Sound Mode",
     0xC1: "Sync",
     0xC2: "Sound Output",
-    # Connectivity
+    # Input & Connectivity
     0xD0: "Multi View",
     0xD1: "Picture in Picture",
     0xD2: "Screen Mirror",
-    # Room / Smart Home Automation (remote controls TV + room)
+    # Room / Smart Home Automation (remote controls TV + room devices)
     0xE0: "Room: Movie",
     0xE1: "Room: Relax",
     0xE2: "Room: Off",
@@ -0,0 +1,83 @@
+#!/usr/bin/env python3
+"""
+Generate button_codes.py from the C button table.
+
+Reads button values from include/remote_buttons.h and names from the
+static table in src/button_table.c, then writes button_codes.py so the
+simulator and the C remote can never disagree on codes or names.
+
+Usage: python gen_button_codes.py [--check]
+"""
+
+import re
+import sys
+from pathlib import Path
+
+ROOT = Path(__file__).resolve().parent.parent
+BUTTONS_H = ROOT / "include" / "remote_buttons.h"
+TABLE_C = ROOT / "src" / "button_table.c"
+OUTPUT = Path(__file__).resolve().parent / "button_codes.py"
+
+DEFINE_RE = re.compile(r"#define\s+(BUTTON_\w+)\s+(0x[0-9A-Fa-f]+)")
+ENTRY_RE = re.compile(r'\[(BUTTON_\w+)\]\s*=\s*\{\s*"([^"]*)"')
+SECTION_RE = re.compile(r"^\s*/\*\s*(.*?)\s*\*/\s*$")
+
+HEADER = '''"""
+Button codes for the TV simulator.
+
+GENERATED by gen_button_codes.py from include/remote_buttons.h and
+src/button_table.c - do not edit by hand. Run `make button-codes` after
+changing the C button table.
+"""
+
+# Code -> display name (matches C get_button_name())
+BUTTON_CODES = {
+'''
+
+FOOTER = '''}
+
+
+def get_button_name(code):
+    """Return display name for a button code; matches C get_button_name()."""
+    return BUTTON_CODES.get(code, f"Unknown (0x{code:02X})")
+'''
+
+
+def generate():
+    values = dict(DEFINE_RE.findall(BUTTONS_H.read_text()))
+    table = TABLE_C.read_text()
+    body = table[table.index("button_table[256]"):]
+    body = body[:body.index("};")]
+
+    lines = []
+    for line in body.splitlines():
+        section = SECTION_RE.match(line)
+        if section:
+            lines.append(f"    # {section.group(1)}")
+            continue
+        entry = ENTRY_RE.search(line)
+        if entry:
+            macro, name = entry.groups()
+            if macro not in values:
+                raise SystemExit(f"{macro} is not defined in {BUTTONS_H.name}")
+            lines.append(f'    0x{int(values[macro], 16):02X}: "{name}",')
+
+    return HEADER + "\n".join(lines) + "\n" + FOOTER
+
+
+def main():
+    text = generate()
+    if "--check" in sys.argv[1:]:
+        if OUTPUT.read_text() != text:
+            print(f"{OUTPUT.name} is out of date; run `make button-codes`")
+            return 1
+        return 0
+    # Repo Python sources use CRLF line endings
+    with open(OUTPUT, "w", newline="\r\n") as f:
+        f.write(text)
+    print(f"Wrote {OUTPUT}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())